@@ -2,24 +2,42 @@
 
 namespace fast {
 
+// Versions of all transformations are drawn from this counter, so that versions of different transformations never collide
+static std::atomic<uint64_t> versionCounter(0);
+
+void AffineTransformation::updateVersion() const {
+    mVersion = ++versionCounter;
+}
+
+uint64_t AffineTransformation::getVersion() const {
+    // The write through the reference from getTransform happens after the call, thus the version is updated here
+    if(mModified.exchange(false))
+        updateVersion();
+    return mVersion;
+}
+
 /**
  * Initializes linear transformation object to identity matrix
  */
-AffineTransformation::AffineTransformation() {
+AffineTransformation::AffineTransformation() : mModified(false) {
     mTransform.matrix() = Eigen::Matrix4f::Identity();
+    updateVersion();
 }
 
-AffineTransformation::AffineTransformation(const Affine3f& transform) {
+AffineTransformation::AffineTransformation(const Affine3f& transform) : mModified(false) {
     mTransform.matrix() = transform.matrix();
+    updateVersion();
 }
 
 AffineTransformation& AffineTransformation::operator=(const Affine3f& transform) {
     mTransform.matrix() = transform.matrix();
+    updateVersion();
     return *this;
 }
 
 void AffineTransformation::setTransform(Affine3f transform) {
 	mTransform = transform;
+    updateVersion();
 }
 
 Vector3f AffineTransformation::getEulerAngles() const {
@@ -28,12 +46,17 @@ Vector3f AffineTransformation::getEulerAngles() const {
 }
 
 Affine3f& AffineTransformation::getTransform() {
+    mModified = true;
+    return mTransform;
+}
+
+const Affine3f& AffineTransformation::getTransform() const {
     return mTransform;
 }
 
 AffineTransformation::pointer AffineTransformation::multiply(AffineTransformation::pointer transformation) {
 	AffineTransformation::pointer result = AffineTransformation::New();
-	result->getTransform().matrix() = mTransform.matrix()*transformation->getTransform().matrix();
+	*result = Affine3f(mTransform.matrix()*transformation->mTransform.matrix());
 	return result;
 }
 
@@ -3,6 +3,7 @@
 
 #include "FAST/Data/DataObject.hpp"
 #include "FAST/Data/DataTypes.hpp"
+#include <atomic>
 
 namespace fast {
 
@@ -16,12 +17,27 @@ class FAST_EXPORT  AffineTransformation : public DataObject {
         AffineTransformation& operator=(const Affine3f& transform);
         Vector3f getEulerAngles() const;
         ~AffineTransformation() {};
+        /**
+         * The transform may be modified through the returned reference, thus this marks the transformation as modified,
+         * and the version is updated the next time it is read. Use the const version to only read it.
+         */
         Affine3f& getTransform();
+        const Affine3f& getTransform() const;
 		void setTransform(Affine3f transform);
+        /**
+         * @return a version stamp which is unique among all transformations, and changes every time this transformation may have changed
+         * since the last time the version was read
+         */
+        uint64_t getVersion() const;
         void free(ExecutionDevice::pointer device) {};
         void freeAll() {};
     private:
+        void updateVersion() const;
+
         Affine3f mTransform;
+        mutable std::atomic<uint64_t> mVersion;
+        // Set when the transform may have been written through the reference returned by getTransform
+        mutable std::atomic<bool> mModified;
 };
 
 } // end namespace fast
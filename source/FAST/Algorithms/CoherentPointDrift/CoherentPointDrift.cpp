@@ -3,6 +3,7 @@
 #include "CoherentPointDrift.hpp"
 
 #include "FAST/Algorithms/CoherentPointDrift/Rigid.hpp"
+#include "FAST/Algorithms/KDTree/KDTree.hpp"
 
 #undef min
 #undef max
@@ -23,6 +24,8 @@ namespace fast {
         mTransformation = AffineTransformation::New();
         mRegistrationConverged = false;
         mScale = 1.0;
+        mExpectationType = DENSE;
+        mTruncationDistance = 3.0f;
 
         timeE = 0.0;
         timeEDistances = 0.0;
@@ -114,6 +117,23 @@ namespace fast {
         auto c = (float) (pow(2*(double)EIGEN_PI*mVariance, (double)mNumDimensions/2.0)
                           * (mUniformWeight/(1-mUniformWeight)) * (float)mNumMovingPoints/mNumFixedPoints);
 
+        if(mExpectationType == TRUNCATED) {
+            expectationTruncated(fixedPoints, movingPoints, c);
+        } else {
+            expectationDense(fixedPoints, movingPoints, c);
+        }
+        mNp = mPt1.sum();
+
+        // Update computation times
+        double timeEndE = omp_get_wtime();
+        timeE += timeEndE - timeStartE;
+    }
+
+    void CoherentPointDrift::expectationDense(MatrixXf& fixedPoints, MatrixXf& movingPoints, float c) {
+        double timeStartE = omp_get_wtime();
+        if(mResponsibilityMatrix.rows() != mNumMovingPoints || mResponsibilityMatrix.cols() != mNumFixedPoints)
+            mResponsibilityMatrix = MatrixXf::Zero(mNumMovingPoints, mNumFixedPoints);
+
 #pragma omp parallel for //collapse(2)
         for (int col = 0; col < mNumFixedPoints; ++col) {
             for (int row = 0; row < mNumMovingPoints; ++row) {
@@ -129,13 +149,66 @@ namespace fast {
             mResponsibilityMatrix.col(col) /= max(denom, Eigen::NumTraits<float>::epsilon() );
         }
 
-        // Update computation times
+        // Reductions of P used by the maximization step
+        mPt1 = mResponsibilityMatrix.colwise().sum().transpose();
+        mP1 = mResponsibilityMatrix.rowwise().sum();
+        mPX = mResponsibilityMatrix * fixedPoints;
+
         double timeEndE = omp_get_wtime();
-        timeEDistances += 0.0;
         timeENormal += timeEndFirstLoop - timeStartE;
-        timeEPosterior += 0.0;
         timeEPosteriorDivision += timeEndE - timeEndFirstLoop;
-        timeE += timeEndE - timeStartE;
+    }
+
+    void CoherentPointDrift::expectationTruncated(MatrixXf& fixedPoints, MatrixXf& movingPoints, float c) {
+        double timeStartE = omp_get_wtime();
+
+        // The full matrix is not used
+        mResponsibilityMatrix.resize(0, 0);
+
+        // Gaussians are truncated, thus only moving points within the truncation distance of a fixed point are used
+        const KDTree movingTree(movingPoints.transpose());
+        const float radius = (float)(mTruncationDistance * std::sqrt(mVariance));
+        double timeEndTree = omp_get_wtime();
+
+        mPt1 = VectorXf::Zero(mNumFixedPoints);
+        mP1 = VectorXf::Zero(mNumMovingPoints);
+        mPX = MatrixXf::Zero(mNumMovingPoints, mNumDimensions);
+#pragma omp parallel
+        {
+            VectorXf P1Local = VectorXf::Zero(mNumMovingPoints);
+            MatrixXf PXLocal = MatrixXf::Zero(mNumMovingPoints, mNumDimensions);
+            std::vector<float> weights;
+#pragma omp for
+            for (int col = 0; col < mNumFixedPoints; ++col) {
+                const VectorXf fixedPoint = fixedPoints.row(col).transpose();
+                const std::vector<int> neighbors = movingTree.findNeighborsWithinRadius(fixedPoint, radius);
+                weights.resize(neighbors.size());
+                float denom = c;
+                for (int i = 0; i < neighbors.size(); ++i) {
+                    double norm = (fixedPoints.row(col) - movingPoints.row(neighbors[i])).squaredNorm();
+                    weights[i] = exp(norm / (-2.0 * mVariance));
+                    denom += weights[i];
+                }
+                denom = max(denom, Eigen::NumTraits<float>::epsilon());
+                float sum = 0.0f;
+                for (int i = 0; i < neighbors.size(); ++i) {
+                    const float p = weights[i] / denom;
+                    P1Local(neighbors[i]) += p;
+                    PXLocal.row(neighbors[i]) += p * fixedPoints.row(col);
+                    sum += p;
+                }
+                mPt1(col) = sum;
+            }
+#pragma omp critical
+            {
+                mP1 += P1Local;
+                mPX += PXLocal;
+            }
+        }
+
+        double timeEndE = omp_get_wtime();
+        timeEDistances += timeEndTree - timeStartE;
+        timeENormal += timeEndE - timeEndTree;
     }
 
     void CoherentPointDrift::execute() {
@@ -256,6 +329,16 @@ namespace fast {
         mTolerance = tolerance;
     }
 
+    void CoherentPointDrift::setExpectationType(ExpectationType type) {
+        mExpectationType = type;
+    }
+
+    void CoherentPointDrift::setTruncationDistance(float standardDeviations) {
+        if(standardDeviations <= 0)
+            throw Exception("Truncation distance must be larger than 0");
+        mTruncationDistance = standardDeviations;
+    }
+
     AffineTransformation::pointer CoherentPointDrift::getOutputTransformation() {
         return mTransformation;
     }
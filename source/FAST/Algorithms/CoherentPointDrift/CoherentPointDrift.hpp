@@ -13,6 +13,7 @@ namespace fast {
 //    FAST_OBJECT(CoherentPointDrift)
     public:
         typedef enum { RIGID, AFFINE, NONRIGID } TransformationType;
+        typedef enum { DENSE, TRUNCATED } ExpectationType;
         void setFixedMeshPort(DataChannel::pointer port);
         void setFixedMesh(Mesh::pointer data);
         void setMovingMeshPort(DataChannel::pointer port);
@@ -20,6 +21,22 @@ namespace fast {
         void setMaximumIterations(unsigned char maxIterations);
         void setUniformWeight(float uniformWeight);
         void setTolerance(double tolerance);
+        /**
+         * Set how the expectation step is computed.
+         * DENSE (default) stores the full responsibility matrix P, which uses O(N*M) memory.
+         * TRUNCATED ignores point pairs further apart than the truncation distance, found with a KD-tree,
+         * and only computes the sums of P needed by the maximization step. This uses O(N+M) memory.
+         *
+         * @param type
+         */
+        void setExpectationType(ExpectationType type);
+        /**
+         * Set the distance, in standard deviations, beyond which point pairs are ignored in the TRUNCATED expectation step.
+         * Default is 3.
+         *
+         * @param standardDeviations
+         */
+        void setTruncationDistance(float standardDeviations);
         AffineTransformation::pointer getOutputTransformation();
 
         virtual void initializeVarianceAndMore() = 0;
@@ -33,7 +50,13 @@ namespace fast {
         MatrixXf mMovingPoints;
         MatrixXf mMovingMeanInitial;
         MatrixXf mFixedMeanInitial;
-        MatrixXf mResponsibilityMatrix;         // P
+        MatrixXf mResponsibilityMatrix;         // P, only used by the DENSE expectation step
+        VectorXf mPt1;                          // Colwise sum of P, then transpose
+        VectorXf mP1;                           // Rowwise sum of P
+        MatrixXf mPX;                           // P times the fixed points
+        float mNp;                              // Sum of all elements in P
+        ExpectationType mExpectationType;
+        float mTruncationDistance;
         unsigned int mNumFixedPoints;           // N
         unsigned int mNumMovingPoints;          // M
         unsigned int mNumDimensions;            // D
@@ -63,6 +86,8 @@ namespace fast {
         void initializePointSets();
         void printCloudDimensions();
         void normalizePointSets();
+        void expectationDense(MatrixXf& fixedPoints, MatrixXf& movingPoints, float c);
+        void expectationTruncated(MatrixXf& fixedPoints, MatrixXf& movingPoints, float c);
 
         std::shared_ptr<Mesh> mFixedMesh;
         std::shared_ptr<Mesh> mMovingMesh;
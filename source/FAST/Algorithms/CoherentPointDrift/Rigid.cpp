@@ -21,31 +21,12 @@ namespace fast {
 
         mIterationError = mTolerance + 10.0;
         mObjectiveFunction = std::numeric_limits<double>::max();
-        mResponsibilityMatrix = MatrixXf::Zero(mNumMovingPoints, mNumFixedPoints);
-        mPt1 = VectorXf::Zero(mNumFixedPoints);
-        mP1 = VectorXf::Zero(mNumMovingPoints);
     }
 
     void CoherentPointDriftRigid::maximization(MatrixXf& fixedPoints, MatrixXf& movingPoints) {
         double startM = omp_get_wtime();
 
-        // Calculate some useful matrix reductions
-        mP1 = VectorXf::Zero(mNumMovingPoints);
-        #pragma omp parallel for
-            for (int col = 0; col < mNumFixedPoints; ++col) {
-                mPt1(col) = mResponsibilityMatrix.col(col).sum();
-            }
-        #pragma omp parallel
-        {
-            VectorXf mP1Local = VectorXf::Zero(mNumMovingPoints);
-            #pragma omp for
-            for (int col = 0; col < mNumFixedPoints; ++col) {
-                mP1Local += mResponsibilityMatrix.col(col);
-            }
-            #pragma omp critical
-            mP1 += mP1Local;
-        }
-        mNp = mPt1.sum();                                           // 1 (sum of all P elements)
+        // P1, Pt1, PX and Np are calculated in the expectation step
         double timeEndMUseful = omp_get_wtime();
 
         // Estimate new mean vectors
@@ -60,7 +41,8 @@ namespace fast {
 
 
         // Single value decomposition (SVD)
-        const MatrixXf A = fixedPointsCentered.transpose() * mResponsibilityMatrix.transpose() * movingPointsCentered;
+        // A = fixedPointsCentered^T * P^T * movingPointsCentered, without using P
+        const MatrixXf A = mPX.transpose() * movingPointsCentered - fixedMean * (mP1.transpose() * movingPointsCentered);
         auto svdU =  A.bdcSvd(Eigen::ComputeThinU);
         auto svdV =  A.bdcSvd(Eigen::ComputeThinV);
         const MatrixXf* U = &svdU.matrixU();
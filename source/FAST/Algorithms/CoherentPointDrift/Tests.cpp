@@ -13,6 +13,7 @@
 
 #include <random>
 #include <iostream>
+#include <chrono>
 using namespace fast;
 
 Mesh::pointer getPointCloud(std::string filename=std::string("Surface_LV.vtk")) {
@@ -181,4 +182,64 @@ TEST_CASE("cpd", "[fast][coherentpointdrift][visual][cpd]") {
         window->start();
     }
 
-}
\ No newline at end of file
+}
+// Sample points on an ellipsoid surface
+Mesh::pointer createEllipsoidPointCloud(int nrOfPoints, unsigned int seed) {
+    std::default_random_engine distributionEngine(seed);
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<MeshVertex> vertices;
+    for(int i = 0; i < nrOfPoints; ++i) {
+        Vector3f direction(distribution(distributionEngine), distribution(distributionEngine), distribution(distributionEngine));
+        vertices.push_back(MeshVertex(direction.normalized().cwiseProduct(Vector3f(30, 20, 10))));
+    }
+    auto mesh = Mesh::New();
+    mesh->create(vertices);
+    return mesh;
+}
+
+Affine3f runRigidCPD(Mesh::pointer fixed, Mesh::pointer moving, CoherentPointDrift::ExpectationType type) {
+    auto cpd = CoherentPointDriftRigid::New();
+    cpd->setFixedMesh(fixed);
+    cpd->setMovingMesh(moving);
+    cpd->setMaximumIterations(50);
+    cpd->setExpectationType(type);
+    auto port = cpd->getOutputPort();
+    cpd->update();
+    return port->getNextFrame<Mesh>()->getSceneGraphNode()->getTransformation()->getTransform();
+}
+
+TEST_CASE("cpd truncated expectation gives same registration as dense", "[fast][coherentpointdrift][cpd]") {
+    Affine3f transform = Affine3f::Identity();
+    transform.rotate(Eigen::AngleAxisf(3.141592f / 180.0f * 10.0f, Eigen::Vector3f::UnitZ()));
+    transform.translate(Vector3f(2, -1, 1));
+
+    Affine3f result[2];
+    for(auto type : {CoherentPointDrift::DENSE, CoherentPointDrift::TRUNCATED}) {
+        auto fixed = createEllipsoidPointCloud(1000, 1);
+        auto moving = createEllipsoidPointCloud(800, 2);
+        auto T = AffineTransformation::New();
+        T->setTransform(transform);
+        moving->getSceneGraphNode()->setTransformation(T);
+        result[type] = runRigidCPD(fixed, moving, type);
+    }
+    for(int i = 0; i < 3; ++i) {
+        for(int j = 0; j < 4; ++j)
+            CHECK(result[CoherentPointDrift::TRUNCATED].matrix()(i, j) == Approx(result[CoherentPointDrift::DENSE].matrix()(i, j)).margin(0.01));
+    }
+}
+
+TEST_CASE("cpd expectation benchmark on 10k x 10k point clouds", "[.][fast][coherentpointdrift][cpd][benchmark]") {
+    Affine3f transform = Affine3f::Identity();
+    transform.rotate(Eigen::AngleAxisf(3.141592f / 180.0f * 10.0f, Eigen::Vector3f::UnitZ()));
+    for(auto type : {CoherentPointDrift::DENSE, CoherentPointDrift::TRUNCATED}) {
+        auto fixed = createEllipsoidPointCloud(10000, 1);
+        auto moving = createEllipsoidPointCloud(10000, 2);
+        auto T = AffineTransformation::New();
+        T->setTransform(transform);
+        moving->getSceneGraphNode()->setTransformation(T);
+        auto start = std::chrono::high_resolution_clock::now();
+        runRigidCPD(fixed, moving, type);
+        std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        std::cout << (type == CoherentPointDrift::DENSE ? "Dense" : "Truncated") << " expectation: " << duration.count() << " ms" << std::endl;
+    }
+}
@@ -64,7 +64,7 @@ void ImageToBatchGenerator::execute() {
     if(!m_streamIsStarted) {
         m_streamIsStarted = true;
         mParent = mInputConnections[0];
-        mInputConnections.clear(); // Severe the connection
+        detachInputConnections(); // Severe the connection
         m_thread = std::make_unique<std::thread>(std::bind(&ImageToBatchGenerator::generateStream, this));
     }
 
@@ -15,6 +15,7 @@ class FAST_EXPORT ImageToBatchGenerator : public Streamer {
     protected:
         void execute() override;
         void generateStream() override;
+        bool hasAsynchronousInputs() override { return true; };
         int m_maxBatchSize;
 
         DataChannel::pointer mParent;
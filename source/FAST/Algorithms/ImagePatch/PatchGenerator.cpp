@@ -17,10 +17,13 @@ PatchGenerator::PatchGenerator() {
     m_streamIsStarted = false;
     m_firstFrameIsInserted = false;
     m_level = 0;
+    m_prefetchCount = 8;
+    m_overlap = 0;
     mIsModified = true;
 
     createIntegerAttribute("patch-size", "Patch size", "", 0);
     createIntegerAttribute("patch-level", "Patch level", "Patch level used for image pyramid inputs", m_level);
+    createIntegerAttribute("patch-overlap", "Patch overlap", "Nr of pixels neighbouring patches overlap", m_overlap);
 }
 
 void PatchGenerator::loadAttributes() {
@@ -34,6 +37,7 @@ void PatchGenerator::loadAttributes() {
     }
 
     setPatchLevel(getIntegerAttribute("patch-level"));
+    setOverlap(getIntegerAttribute("patch-overlap"));
 }
 
 PatchGenerator::~PatchGenerator() {
@@ -46,64 +50,89 @@ void PatchGenerator::generateStream() {
     if(m_inputImagePyramid) {
         const int levelWidth = m_inputImagePyramid->getLevelWidth(m_level);
         const int levelHeight = m_inputImagePyramid->getLevelHeight(m_level);
-        const int patchesX = std::ceil((float) levelWidth / m_width);
-        const int patchesY = std::ceil((float) levelHeight / m_height);
-
-        for(int patchY = 0; patchY < patchesY; ++patchY) {
-            for(int patchX = 0; patchX < patchesX; ++patchX) {
-                mRuntimeManager->startRegularTimer("create patch");
-                int patchWidth = m_width;
-                if(patchX == patchesX - 1)
-                    patchWidth = levelWidth - patchX * m_width - 1;
-                int patchHeight = m_height;
-                if(patchY == patchesY - 1)
-                    patchHeight = levelHeight - patchY * m_height - 1;
-
-                if(m_inputMask) {
-                    // If a mask exist, check if this patch should be included or not
-                    auto access = m_inputMask->getImageAccess(ACCESS_READ);
-                    // Take center of patch
-                    Vector2i position(
-                            round(m_inputMask->getWidth() * ((float) patchX / patchesX + 0.5f / patchesX)),
-                            round(m_inputMask->getHeight() * ((float) patchY / patchesY + 0.5f / patchesY))
-                    );
-                    float value = access->getScalar(position);
-                    if(value != 1)
-                        continue;
-                }
-                reportInfo() << "Generating patch " << patchX << " " << patchY << reportEnd();
-                auto access = m_inputImagePyramid->getAccess(ACCESS_READ);
-                auto patch = access->getPatchAsImage(m_level, patchX * m_width, patchY * m_height,
-                                                                  patchWidth,
-                                                                  patchHeight);
-
-                // Store some frame data useful for patch stitching
-                patch->setFrameData("original-width", std::to_string(levelWidth));
-                patch->setFrameData("original-height", std::to_string(levelHeight));
-                patch->setFrameData("patchid-x", std::to_string(patchX));
-                patch->setFrameData("patchid-y", std::to_string(patchY));
-                // Target width/height of patches
-                patch->setFrameData("patch-width", std::to_string(m_width));
-                patch->setFrameData("patch-height", std::to_string(m_height));
-                patch->setFrameData("patch-spacing-x", std::to_string(patch->getSpacing().x()));
-                patch->setFrameData("patch-spacing-y", std::to_string(patch->getSpacing().y()));
-
-                mRuntimeManager->stopRegularTimer("create patch");
-                try {
-                    if(previousPatch) {
-                        addOutputData(0, previousPatch);
-                        frameAdded();
+        // Distance between the start of neighbouring patches
+        const int strideX = m_width - m_overlap;
+        const int strideY = m_height - m_overlap;
+        const int patchesX = std::max(1, (int)std::ceil((float) (levelWidth - m_overlap) / strideX));
+        const int patchesY = std::max(1, (int)std::ceil((float) (levelHeight - m_overlap) / strideY));
+        auto getPatchWidth = [=](int patchX) {
+            return patchX == patchesX - 1 ? levelWidth - patchX * strideX - 1 : m_width;
+        };
+        auto getPatchHeight = [=](int patchY) {
+            return patchY == patchesY - 1 ? levelHeight - patchY * strideY - 1 : m_height;
+        };
+
+        // Find all patches to generate first, so that upcoming patches can be prefetched
+        std::vector<Vector2i> patches;
+        {
+            ImageAccess::pointer maskAccess;
+            if(m_inputMask)
+                maskAccess = m_inputMask->getImageAccess(ACCESS_READ);
+            for(int patchY = 0; patchY < patchesY; ++patchY) {
+                for(int patchX = 0; patchX < patchesX; ++patchX) {
+                    if(m_inputMask) {
+                        // If a mask exist, check if this patch should be included or not
+                        // Take center of patch
+                        Vector2i position(
+                                std::min((int)round(m_inputMask->getWidth() * ((patchX * strideX + 0.5f * getPatchWidth(patchX)) / levelWidth)), m_inputMask->getWidth() - 1),
+                                std::min((int)round(m_inputMask->getHeight() * ((patchY * strideY + 0.5f * getPatchHeight(patchY)) / levelHeight)), m_inputMask->getHeight() - 1)
+                        );
+                        float value = maskAccess->getScalar(position);
+                        if(value != 1)
+                            continue;
                     }
-                } catch(ThreadStopped &e) {
-                    std::unique_lock<std::mutex> lock(m_stopMutex);
-                    m_stop = true;
-                    break;
+                    patches.push_back(Vector2i(patchX, patchY));
                 }
-                previousPatch = patch;
+            }
+        }
+
+        int nextPrefetch = 0;
+        for(int i = 0; i < patches.size(); ++i) {
+            const int patchX = patches[i].x();
+            const int patchY = patches[i].y();
+            mRuntimeManager->startRegularTimer("create patch");
+            // Keep the prefetch threads busy reading the next patches
+            for(nextPrefetch = std::max(nextPrefetch, i + 1); nextPrefetch < std::min((int)patches.size(), i + 1 + m_prefetchCount); ++nextPrefetch) {
+                const Vector2i& next = patches[nextPrefetch];
+                m_inputImagePyramid->prefetchPatch(m_level, next.x() * strideX, next.y() * strideY,
+                                                   getPatchWidth(next.x()), getPatchHeight(next.y()));
+            }
+            const int patchWidth = getPatchWidth(patchX);
+            const int patchHeight = getPatchHeight(patchY);
+
+            reportInfo() << "Generating patch " << patchX << " " << patchY << reportEnd();
+            auto access = m_inputImagePyramid->getAccess(ACCESS_READ);
+            auto patch = access->getPatchAsImage(m_level, patchX * strideX, patchY * strideY,
+                                                              patchWidth,
+                                                              patchHeight);
+
+            // Store some frame data useful for patch stitching
+            patch->setFrameData("original-width", std::to_string(levelWidth));
+            patch->setFrameData("original-height", std::to_string(levelHeight));
+            patch->setFrameData("patchid-x", std::to_string(patchX));
+            patch->setFrameData("patchid-y", std::to_string(patchY));
+            // Target width/height of patches
+            patch->setFrameData("patch-width", std::to_string(m_width));
+            patch->setFrameData("patch-height", std::to_string(m_height));
+            patch->setFrameData("patch-offset-x", std::to_string(patchX * strideX));
+            patch->setFrameData("patch-offset-y", std::to_string(patchY * strideY));
+            patch->setFrameData("patch-overlap-x", std::to_string(m_overlap));
+            patch->setFrameData("patch-overlap-y", std::to_string(m_overlap));
+            patch->setFrameData("patch-spacing-x", std::to_string(patch->getSpacing().x()));
+            patch->setFrameData("patch-spacing-y", std::to_string(patch->getSpacing().y()));
+
+            mRuntimeManager->stopRegularTimer("create patch");
+            try {
+                if(previousPatch) {
+                    addOutputData(0, previousPatch);
+                    frameAdded();
+                }
+            } catch(ThreadStopped &e) {
                 std::unique_lock<std::mutex> lock(m_stopMutex);
-                if(m_stop)
-                    break;
+                m_stop = true;
+                break;
             }
+            previousPatch = patch;
             std::unique_lock<std::mutex> lock(m_stopMutex);
             if(m_stop) {
                 //m_streamIsStarted = false;
@@ -121,7 +150,8 @@ void PatchGenerator::generateStream() {
         for(int i = 0; i < 16; ++i)
             transformString += std::to_string(transformData[i]) + " ";
 
-        for(int z = 0; z < depth; z += m_depth) {
+        const int strideZ = m_depth - m_overlap;
+        for(int z = 0; z < depth; z += strideZ) {
             mRuntimeManager->startRegularTimer("create patch");
             auto patch = m_inputVolume->crop(Vector3i(0, 0, z), Vector3i(width, height, m_depth), true);
             patch->setFrameData("original-width", std::to_string(width));
@@ -131,6 +161,7 @@ void PatchGenerator::generateStream() {
             patch->setFrameData("patch-offset-x", std::to_string(0));
             patch->setFrameData("patch-offset-y", std::to_string(0));
             patch->setFrameData("patch-offset-z", std::to_string(z));
+            patch->setFrameData("patch-overlap-z", std::to_string(m_overlap));
             Vector3f spacing = m_inputVolume->getSpacing();
             patch->setFrameData("patch-spacing-x", std::to_string(spacing.x()));
             patch->setFrameData("patch-spacing-y", std::to_string(spacing.y()));
@@ -151,6 +182,8 @@ void PatchGenerator::generateStream() {
             std::unique_lock<std::mutex> lock(m_stopMutex);
             if(m_stop)
                 break;
+            if(z + m_depth >= depth) // Rest of volume is covered by the overlap of this patch
+                break;
         }
     } else {
         throw Exception("Unsupported data object given to PatchGenerator");
@@ -172,6 +205,10 @@ void PatchGenerator::execute() {
     auto input = getInputData<SpatialDataObject>();
     m_inputImagePyramid = std::dynamic_pointer_cast<ImagePyramid>(input);
     m_inputVolume = std::dynamic_pointer_cast<Image>(input);
+    if(m_inputImagePyramid && (m_overlap >= m_width || m_overlap >= m_height))
+        throw Exception("Patch overlap must be smaller than patch width and height");
+    if(m_inputVolume && m_overlap >= m_depth)
+        throw Exception("Patch overlap must be smaller than patch depth");
 
     if(mInputConnections.count(1) > 0) {
         // If a mask was given store it
@@ -194,4 +231,17 @@ void PatchGenerator::setPatchLevel(int level) {
     mIsModified = true;
 }
 
+void PatchGenerator::setOverlap(int overlap) {
+    if(overlap < 0)
+        throw Exception("Patch overlap can't be negative");
+    m_overlap = overlap;
+    mIsModified = true;
+}
+
+void PatchGenerator::setPrefetchCount(int count) {
+    if(count < 0)
+        throw Exception("Prefetch count can't be negative");
+    m_prefetchCount = count;
+}
+
 }
\ No newline at end of file
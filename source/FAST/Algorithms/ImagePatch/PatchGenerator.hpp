@@ -14,6 +14,17 @@ class FAST_EXPORT PatchGenerator : public Streamer {
     public:
         void setPatchSize(int width, int height, int depth = 1);
         void setPatchLevel(int level);
+        /**
+         * Set how many of the upcoming patches of an image pyramid are read in advance
+         * by the prefetch threads of the ImagePyramid. 0 disables prefetching. Default is 8.
+         */
+        void setPrefetchCount(int count);
+        /**
+         * Set nr of pixels neighbouring patches overlap. For image pyramids the overlap is
+         * in both x and y direction, for volumes it is in the z direction. Use with PatchStitcher
+         * to blend the overlapping regions of the processed patches. Default is 0.
+         */
+        void setOverlap(int overlap);
         ~PatchGenerator();
         void loadAttributes() override;
     protected:
@@ -23,6 +34,8 @@ class FAST_EXPORT PatchGenerator : public Streamer {
         SharedPointer<Image> m_inputVolume;
         SharedPointer<Image> m_inputMask;
         int m_level;
+        int m_prefetchCount;
+        int m_overlap;
 
         void execute() override;
         void generateStream() override;
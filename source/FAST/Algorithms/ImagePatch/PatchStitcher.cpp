@@ -3,9 +3,19 @@
 #include <FAST/Data/Tensor.hpp>
 #include <FAST/Algorithms/NeuralNetwork/NeuralNetwork.hpp>
 #include "PatchStitcher.hpp"
+// Blending weight function shared with the OpenCL kernels
+#include "PatchStitcherBlending.cl"
 
 namespace fast {
 
+// Get frame data as integer, or a default value if it does not exist
+static int getFrameDataAsInteger(SharedPointer<DataObject> data, std::string name, int defaultValue) {
+    auto frameData = data->getFrameData();
+    if(frameData.count(name) == 0)
+        return defaultValue;
+    return std::stoi(frameData[name]);
+}
+
 PatchStitcher::PatchStitcher() {
     createInputPort<DataObject>(0); // Can be Image, Batch or Tensor
     createOutputPort<DataObject>(0); // Can be Image or Tensor
@@ -56,8 +66,9 @@ void PatchStitcher::processTensor(SharedPointer<Tensor> patch) {
     const int fullWidth = std::stoi(patch->getFrameData("original-width"));
     const int fullHeight = std::stoi(patch->getFrameData("original-height"));
 
-    const int patchWidth = std::stoi(patch->getFrameData("patch-width"));
-    const int patchHeight = std::stoi(patch->getFrameData("patch-height"));
+    // Overlapping patches are placed on a grid with distance between patches equal to the stride
+    const int patchWidth = std::stoi(patch->getFrameData("patch-width")) - getFrameDataAsInteger(patch, "patch-overlap-x", 0);
+    const int patchHeight = std::stoi(patch->getFrameData("patch-height")) - getFrameDataAsInteger(patch, "patch-overlap-y", 0);
 
     const float patchSpacingX = std::stof(patch->getFrameData("patch-spacing-x"));
     const float patchSpacingY = std::stof(patch->getFrameData("patch-spacing-y"));
@@ -71,7 +82,13 @@ void PatchStitcher::processTensor(SharedPointer<Tensor> patch) {
     if(!m_outputTensor) {
         // Create output tensor
         m_outputTensor = Tensor::New();
-        TensorShape fullShape({(int)std::ceil((float)fullHeight / patchHeight), (int)std::ceil((float)fullWidth / patchWidth), channels});
+        const int overlapX = getFrameDataAsInteger(patch, "patch-overlap-x", 0);
+        const int overlapY = getFrameDataAsInteger(patch, "patch-overlap-y", 0);
+        TensorShape fullShape({
+            std::max(1, (int)std::ceil((float)(fullHeight - overlapY) / patchHeight)),
+            std::max(1, (int)std::ceil((float)(fullWidth - overlapX) / patchWidth)),
+            channels
+        });
         auto initializedData = std::make_unique<float[]>(fullShape.getTotalSize());
         m_outputTensor->create(std::move(initializedData), fullShape);
         m_outputTensor->setSpacing(Vector3f(patchHeight*patchSpacingY, patchWidth*patchSpacingX, 1.0f));
@@ -125,6 +142,9 @@ void PatchStitcher::processImage(SharedPointer<Image> patch) {
                 m_outputImagePyramid->create(fullWidth, fullHeight, patch->getNrOfChannels());
             }
         }
+        // The sums of weights belong to the previous output image
+        m_weights.reset();
+        m_pyramidWeights.clear();
         if(m_outputImage) {
             m_outputImage->fill(0);
             m_outputImage->setSpacing(Vector3f(patchSpacingX, patchSpacingY, patchSpacingZ));
@@ -150,15 +170,55 @@ void PatchStitcher::processImage(SharedPointer<Image> patch) {
     }
 
     auto device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
+    const int overlapX = getFrameDataAsInteger(patch, "patch-overlap-x", 0);
+    const int overlapY = getFrameDataAsInteger(patch, "patch-overlap-y", 0);
+    const int overlapZ = getFrameDataAsInteger(patch, "patch-overlap-z", 0);
+    const bool blend = overlapX > 0 || overlapY > 0 || overlapZ > 0;
+    std::string buildOptions;
+    if(m_outputImage) {
+        buildOptions = "-DTYPE=" + getCTypeAsString(m_outputImage->getDataType());
+        if(m_outputImage->getDataType() != TYPE_FLOAT)
+            buildOptions += " -DINTEGER_TYPE";
+    }
+    if(blend && m_outputImage && !m_weights) {
+        // Create buffer for sum of weights, initialized to zero
+        const std::size_t size = (std::size_t)m_outputImage->getWidth()*m_outputImage->getHeight()*m_outputImage->getDepth()*sizeof(float);
+        m_weights = std::make_unique<cl::Buffer>(device->getContext(), CL_MEM_READ_WRITE, size);
+        device->getCommandQueue().enqueueFillBuffer(*m_weights, 0.0f, 0, size);
+    }
 
     if(fullDepth == 1) {
-		const int startX = std::stoi(patch->getFrameData("patchid-x")) * std::stoi(patch->getFrameData("patch-width"));
-		const int startY = std::stoi(patch->getFrameData("patchid-y")) * std::stoi(patch->getFrameData("patch-height"));
+		const int startX = std::stoi(patch->getFrameData("patchid-x")) * (std::stoi(patch->getFrameData("patch-width")) - overlapX);
+		const int startY = std::stoi(patch->getFrameData("patchid-y")) * (std::stoi(patch->getFrameData("patch-height")) - overlapY);
 		const int endX = startX + patch->getWidth();
 		const int endY = startY + patch->getHeight();
 		reportInfo() << "Stitching " << patch->getFrameData("patchid-x") << " " << patch->getFrameData("patchid-y")
 			<< reportEnd();
-        if(m_outputImage) {
+        if(m_outputImage && blend) {
+            cl::Program program = getOpenCLProgram(device, "2D", buildOptions);
+
+            auto patchAccess = patch->getOpenCLImageAccess(ACCESS_READ, device);
+            auto outputAccess = m_outputImage->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+
+            cl::Kernel kernel(program, "blendPatch2D");
+            kernel.setArg(0, *patchAccess->get2DImage());
+            kernel.setArg(1, *outputAccess->get());
+            kernel.setArg(2, *m_weights);
+            kernel.setArg(3, startX);
+            kernel.setArg(4, startY);
+            kernel.setArg(5, fullWidth);
+            kernel.setArg(6, fullHeight);
+            kernel.setArg(7, m_outputImage->getNrOfChannels());
+            kernel.setArg(8, overlapX);
+            kernel.setArg(9, overlapY);
+            kernel.setArg(10, (int)m_blendingMode);
+            device->getCommandQueue().enqueueNDRangeKernel(
+                kernel,
+                cl::NullRange,
+                cl::NDRange(patch->getWidth(), patch->getHeight()),
+                cl::NullRange
+            );
+        } else if(m_outputImage) {
             cl::Program program = getOpenCLProgram(device, "2D");
 
 			auto patchAccess = patch->getOpenCLImageAccess(ACCESS_READ, device);
@@ -175,6 +235,8 @@ void PatchStitcher::processImage(SharedPointer<Image> patch) {
                 cl::NDRange(patch->getWidth(), patch->getHeight()),
                 cl::NullRange
             );
+        } else if(blend) {
+            blendImagePyramidPatch(patch, startX, startY, overlapX, overlapY);
         } else {
             enableRuntimeMeasurements();
             // Image pyramid, do it on CPU TODO: optimize somehow?
@@ -201,7 +263,30 @@ void PatchStitcher::processImage(SharedPointer<Image> patch) {
         reportInfo() << "Stitching " << startZ << reportEnd();
 		auto patchAccess = patch->getOpenCLImageAccess(ACCESS_READ, device);
 
-        if(device->isWritingTo3DTexturesSupported()) {
+        if(blend) {
+            auto outputAccess = m_outputImage->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+            cl::Program program = getOpenCLProgram(device, "3D", buildOptions);
+            cl::Kernel kernel(program, "blendPatch3D");
+            kernel.setArg(0, *patchAccess->get3DImage());
+            kernel.setArg(1, *outputAccess->get());
+            kernel.setArg(2, *m_weights);
+            kernel.setArg(3, startX);
+            kernel.setArg(4, startY);
+            kernel.setArg(5, startZ);
+            kernel.setArg(6, fullWidth);
+            kernel.setArg(7, fullHeight);
+            kernel.setArg(8, fullDepth);
+            kernel.setArg(9, m_outputImage->getNrOfChannels());
+            kernel.setArg(10, overlapZ);
+            kernel.setArg(11, (int)m_blendingMode);
+
+            device->getCommandQueue().enqueueNDRangeKernel(
+                kernel,
+                cl::NullRange,
+                cl::NDRange(patch->getWidth(), patch->getHeight(), patch->getDepth()),
+                cl::NullRange
+            );
+        } else if(device->isWritingTo3DTexturesSupported()) {
             auto outputAccess = m_outputImage->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
             cl::Program program = getOpenCLProgram(device, "3D");
             cl::Kernel kernel(program, "applyPatch3D");
@@ -219,7 +304,7 @@ void PatchStitcher::processImage(SharedPointer<Image> patch) {
             );
         } else {
             auto outputAccess = m_outputImage->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
-            cl::Program program = getOpenCLProgram(device, "3D", "-DTYPE=" + getCTypeAsString(m_outputImage->getDataType()));
+            cl::Program program = getOpenCLProgram(device, "3D", buildOptions);
             cl::Kernel kernel(program, "applyPatch3D");
             kernel.setArg(0, *patchAccess->get3DImage());
             kernel.setArg(1, *outputAccess->get());
@@ -243,5 +328,51 @@ void PatchStitcher::processImage(SharedPointer<Image> patch) {
     }
 }
 
+void PatchStitcher::blendImagePyramidPatch(SharedPointer<Image> patch, int startX, int startY, int overlapX, int overlapY) {
+    // Patches arrive row by row. Only the weights of the rows which can still receive patches are stored.
+    const int fullWidth = m_outputImagePyramid->getFullWidth();
+    const int fullHeight = m_outputImagePyramid->getFullHeight();
+    const int channels = m_outputImagePyramid->getNrOfChannels();
+    const int rows = std::stoi(patch->getFrameData("patch-height"));
+    if(m_pyramidWeights.empty()) {
+        m_pyramidWeights = std::vector<float>((std::size_t)fullWidth*rows, 0.0f);
+        m_pyramidWeightsStartY = 0;
+    }
+    if(startY < m_pyramidWeightsStartY)
+        throw Exception("PatchStitcher requires overlapping patches of image pyramids to arrive row by row");
+    if(startY > m_pyramidWeightsStartY) {
+        // Rows above startY are finished, move the remaining rows up
+        const int shift = std::min(startY - m_pyramidWeightsStartY, rows);
+        std::move(m_pyramidWeights.begin() + (std::size_t)shift*fullWidth, m_pyramidWeights.end(), m_pyramidWeights.begin());
+        std::fill(m_pyramidWeights.end() - (std::size_t)shift*fullWidth, m_pyramidWeights.end(), 0.0f);
+        m_pyramidWeightsStartY = startY;
+    }
+
+    mRuntimeManager->startRegularTimer("blend patch");
+    auto outputAccess = m_outputImagePyramid->getAccess(ACCESS_READ_WRITE);
+    auto patchAccess = patch->getImageAccess(ACCESS_READ);
+    const int maxY = std::min(startY + patch->getHeight(), fullHeight);
+    const int maxX = std::min(startX + patch->getWidth(), fullWidth);
+    for(int y = startY; y < maxY; ++y) {
+        const float weightY = getBlendingWeight(y - startY, patch->getHeight(), overlapY, (int)m_blendingMode);
+        for(int x = startX; x < maxX; ++x) {
+            const float weight = weightY*getBlendingWeight(x - startX, patch->getWidth(), overlapX, (int)m_blendingMode);
+            float& totalWeight = m_pyramidWeights[(std::size_t)(y - m_pyramidWeightsStartY)*fullWidth + x];
+            const float previousWeight = totalWeight;
+            totalWeight += weight;
+            for(int channel = 0; channel < channels; ++channel) {
+                const float previous = outputAccess->getScalarFast(x, y, 0, channel);
+                const float value = patchAccess->getScalarFast<uchar>(Vector2i(x - startX, y - startY), channel);
+                outputAccess->setScalarFast(x, y, 0, std::round((previous*previousWeight + value*weight) / totalWeight), channel);
+            }
+        }
+    }
+    mRuntimeManager->stopRegularTimer("blend patch");
+}
 
-}
\ No newline at end of file
+void PatchStitcher::setBlendingMode(BlendingMode mode) {
+    m_blendingMode = mode;
+    mIsModified = true;
+}
+
+}
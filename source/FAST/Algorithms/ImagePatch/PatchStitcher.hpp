@@ -8,9 +8,30 @@ class Image;
 class ImagePyramid;
 class Tensor;
 
+/**
+ * Stitches patches created by PatchGenerator, and possibly processed by other process objects, into a
+ * full Image, Tensor or ImagePyramid.
+ *
+ * If the patches overlap (see PatchGenerator::setOverlap), the overlapping regions are blended using
+ * a weighted average. The average is accumulated in the output as patches arrive, thus only the sum of weights
+ * is stored in addition to the output. For ImagePyramid outputs, only the weights of the current row of
+ * patches are stored, which requires patches to arrive in the order generated by PatchGenerator.
+ */
 class FAST_EXPORT PatchStitcher : public ProcessObject {
     FAST_OBJECT(PatchStitcher)
     public:
+        /**
+         * Weighting used to blend overlapping patches
+         */
+        enum class BlendingMode {
+            LINEAR = 0, // Weight increases linearly from the patch border through the overlap region
+            GAUSSIAN = 1 // Gaussian weight centered in the patch, with standard deviation 1/8 of the patch size
+        };
+        /**
+         * Set how overlapping patches are blended. Default is LINEAR.
+         * @param mode
+         */
+        void setBlendingMode(BlendingMode mode);
     protected:
         void execute() override;
 
@@ -20,6 +41,14 @@ class FAST_EXPORT PatchStitcher : public ProcessObject {
 
         void processTensor(SharedPointer<Tensor> tensor);
         void processImage(SharedPointer<Image> tensor);
+        void blendImagePyramidPatch(SharedPointer<Image> patch, int startX, int startY, int overlapX, int overlapY);
+
+        BlendingMode m_blendingMode = BlendingMode::LINEAR;
+        // Sum of blending weights for each pixel of the output image
+        std::unique_ptr<cl::Buffer> m_weights;
+        // Sum of blending weights for rows m_pyramidWeightsStartY and downwards of the output image pyramid
+        std::vector<float> m_pyramidWeights;
+        int m_pyramidWeightsStartY = 0;
     private:
         PatchStitcher();
 
@@ -1,3 +1,5 @@
+#include "Algorithms/ImagePatch/PatchStitcherBlending.cl"
+
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE | CLK_FILTER_NEAREST;
 
 __kernel void applyPatch2D(
@@ -16,3 +18,51 @@ __kernel void applyPatch2D(
 		write_imagei(image, pos, read_imagei(patch, sampler, pos - (int2)(startX, startY)));
     }
 }
+
+#ifdef TYPE
+// Blend patch into output image as a running weighted average.
+// weights contains the sum of the weights of all previous patches for each pixel.
+__kernel void blendPatch2D(
+        __read_only image2d_t patch,
+        __global TYPE* image,
+        __global float* weights,
+        __private int startX,
+        __private int startY,
+        __private int width,
+        __private int height,
+        __private int channels,
+        __private int overlapX,
+        __private int overlapY,
+        __private int blending
+    ) {
+    const int2 patchPos = {get_global_id(0), get_global_id(1)};
+    const int2 pos = patchPos + (int2)(startX, startY);
+    if(pos.x >= width || pos.y >= height)
+        return;
+    int dataType = get_image_channel_data_type(patch);
+    float4 value;
+    if(dataType == CLK_FLOAT) {
+        value = read_imagef(patch, sampler, patchPos);
+    } else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
+        value = convert_float4(read_imageui(patch, sampler, patchPos));
+    } else {
+        value = convert_float4(read_imagei(patch, sampler, patchPos));
+    }
+    const float weight =
+            getBlendingWeight(patchPos.x, get_image_width(patch), overlapX, blending)*
+            getBlendingWeight(patchPos.y, get_image_height(patch), overlapY, blending);
+    const int index = pos.x + pos.y*width;
+    const float previousWeight = weights[index];
+    const float newWeight = previousWeight + weight;
+    weights[index] = newWeight;
+    const float values[4] = {value.x, value.y, value.z, value.w};
+    for(int channel = 0; channel < channels; ++channel) {
+        const float result = (image[index*channels + channel]*previousWeight + values[channel]*weight) / newWeight;
+#ifdef INTEGER_TYPE
+        image[index*channels + channel] = round(result);
+#else
+        image[index*channels + channel] = result;
+#endif
+    }
+}
+#endif
@@ -1,3 +1,5 @@
+#include "Algorithms/ImagePatch/PatchStitcherBlending.cl"
+
 __constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_NONE | CLK_FILTER_NEAREST;
 
 #ifdef fast_3d_image_writes
@@ -48,3 +50,50 @@ __kernel void applyPatch3D(
         image[(pos.x + pos.y*width + pos.z*width*height)*channels + 3] = value.w;
 }
 #endif
+
+#ifdef TYPE
+// Blend patch into output volume as a running weighted average.
+// weights contains the sum of the weights of all previous patches for each voxel.
+__kernel void blendPatch3D(
+        __read_only image3d_t patch,
+        __global TYPE* image,
+        __global float* weights,
+        __private int startX,
+        __private int startY,
+        __private int startZ,
+        __private int width,
+        __private int height,
+        __private int depth,
+        __private int channels,
+        __private int overlapZ,
+        __private int blending
+    ) {
+    const int4 patchPos = {get_global_id(0), get_global_id(1), get_global_id(2), 0};
+    const int4 pos = patchPos + (int4)(startX, startY, startZ, 0);
+    if(pos.x >= width || pos.y >= height || pos.z >= depth)
+        return;
+    int dataType = get_image_channel_data_type(patch);
+    float4 value;
+    if(dataType == CLK_FLOAT) {
+        value = read_imagef(patch, sampler, patchPos);
+    } else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
+        value = convert_float4(read_imageui(patch, sampler, patchPos));
+    } else {
+        value = convert_float4(read_imagei(patch, sampler, patchPos));
+    }
+    const float weight = getBlendingWeight(patchPos.z, get_image_depth(patch), overlapZ, blending);
+    const int index = pos.x + pos.y*width + pos.z*width*height;
+    const float previousWeight = weights[index];
+    const float newWeight = previousWeight + weight;
+    weights[index] = newWeight;
+    const float values[4] = {value.x, value.y, value.z, value.w};
+    for(int channel = 0; channel < channels; ++channel) {
+        const float result = (image[index*channels + channel]*previousWeight + values[channel]*weight) / newWeight;
+#ifdef INTEGER_TYPE
+        image[index*channels + channel] = round(result);
+#else
+        image[index*channels + channel] = result;
+#endif
+    }
+}
+#endif
@@ -0,0 +1,30 @@
+// Weight of a position along one axis of a patch, used for blending overlapping patches.
+// Included by the PatchStitcher kernels and by PatchStitcher.cpp, thus it must be valid OpenCL C and C++.
+#ifndef PATCH_STITCHER_BLENDING_CL
+#define PATCH_STITCHER_BLENDING_CL
+
+#ifdef __OPENCL_VERSION__
+#define BLENDING_FUNCTION
+#else
+#include <cmath>
+#define BLENDING_FUNCTION inline
+#endif
+
+BLENDING_FUNCTION float getBlendingWeight(int position, int size, int overlap, int blending) {
+    if(overlap <= 0)
+        return 1.0f;
+    if(blending == 0) {
+        // Linear ramp from the patch border through the overlap region
+        const int distance = position < size - 1 - position ? position : size - 1 - position;
+        const float weight = (distance + 1.0f) / (overlap + 1.0f);
+        return weight < 1.0f ? weight : 1.0f;
+    } else {
+        // Gaussian centered in the patch
+        const float sigma = size / 8.0f;
+        const float x = position - (size - 1) * 0.5f;
+        const float weight = exp(-x*x / (2.0f*sigma*sigma));
+        return weight > 1e-3f ? weight : 1e-3f;
+    }
+}
+
+#endif
@@ -112,4 +112,124 @@ TEST_CASE("Patch generator, sticher and image to batch generator for WSI", "[fas
         std::cout << "Got a batch" << std::endl;
     } while(!batch->isLastFrame());
     std::cout << "Done" << std::endl;
-}
\ No newline at end of file
+}
+
+TEST_CASE("Patch generator for WSI prefetches patches into the image pyramid patch cache", "[fast][wsi][PatchGenerator]") {
+    auto importer = WholeSlideImageImporter::New();
+    importer->setFilename(Config::getTestDataPath() + "/WSI/A05.svs");
+    auto pyramid = importer->updateAndGetOutputData<ImagePyramid>();
+    pyramid->setNumberOfPrefetchThreads(4);
+
+    auto generator = PatchGenerator::New();
+    generator->setPatchSize(512, 512);
+    generator->setPatchLevel(0);
+    generator->setPrefetchCount(8);
+    generator->setInputData(pyramid);
+    auto port = generator->getOutputPort();
+    generator->update();
+
+    int patches = 0;
+    while(true) {
+        auto patch = port->getNextFrame<Image>();
+        ++patches;
+        if(patch->isLastFrame())
+            break;
+    }
+    CHECK(patches > 1);
+    // Prefetched patches may be evicted before they are used if the cache is full, thus only some are guaranteed to be hits
+    CHECK(pyramid->getNrOfPatchCacheHits() >= 1);
+    CHECK(pyramid->getNrOfPatchCacheHits() + pyramid->getNrOfPatchCacheMisses() == patches);
+
+    // Patch read through the cache should be identical to patch read directly from file
+    auto access = pyramid->getAccess(ACCESS_READ);
+    auto cached = access->getPatchData(0, 512, 0, 512, 512);
+    pyramid->setPatchCacheSize(0);
+    auto uncached = access->getPatchData(0, 512, 0, 512, 512);
+    CHECK(std::memcmp(cached.get(), uncached.get(), 512*512*4) == 0);
+}
+
+TEST_CASE("Patch generator and stitcher with overlap for volumes", "[fast][volume][PatchGenerator][PatchStitcher]") {
+    const int width = 32, height = 24, depth = 50;
+    std::vector<float> data((std::size_t)width*height*depth);
+    for(int i = 0; i < data.size(); ++i)
+        data[i] = (float)(i % 97);
+    auto volume = Image::New();
+    volume->create(width, height, depth, TYPE_FLOAT, 1, data.data());
+
+    for(auto mode : {PatchStitcher::BlendingMode::LINEAR, PatchStitcher::BlendingMode::GAUSSIAN}) {
+        auto generator = PatchGenerator::New();
+        generator->setPatchSize(width, height, 16);
+        generator->setOverlap(6);
+        generator->setInputData(volume);
+
+        auto stitcher = PatchStitcher::New();
+        stitcher->setBlendingMode(mode);
+        stitcher->setInputConnection(generator->getOutputPort());
+        auto port = stitcher->getOutputPort();
+
+        Image::pointer output;
+        do {
+            stitcher->update();
+            output = port->getNextFrame<Image>();
+        } while(!output->isLastFrame());
+
+        // Overlapping patches contain the same data, thus blending must reproduce the input
+        auto access = output->getImageAccess(ACCESS_READ);
+        auto outputData = (float*)access->get();
+        for(int i = 0; i < data.size(); ++i)
+            REQUIRE(outputData[i] == Approx(data[i]));
+    }
+}
+
+TEST_CASE("Patch stitcher blends overlapping patches with different content", "[fast][PatchStitcher]") {
+    // Two 16x8 patches with 8 pixels overlap in x, the first is filled with 10, the second with 20
+    const int patchWidth = 16, patchHeight = 8, overlap = 8, fullWidth = 24;
+    std::vector<Image::pointer> patches;
+    for(int i = 0; i < 2; ++i) {
+        std::vector<float> data((std::size_t)patchWidth*patchHeight, 10.0f*(i + 1));
+        auto patch = Image::New();
+        patch->create(patchWidth, patchHeight, TYPE_FLOAT, 1, data.data());
+        patch->setFrameData("original-width", std::to_string(fullWidth));
+        patch->setFrameData("original-height", std::to_string(patchHeight));
+        patch->setFrameData("patchid-x", std::to_string(i));
+        patch->setFrameData("patchid-y", "0");
+        patch->setFrameData("patch-width", std::to_string(patchWidth));
+        patch->setFrameData("patch-height", std::to_string(patchHeight));
+        patch->setFrameData("patch-overlap-x", std::to_string(overlap));
+        patch->setFrameData("patch-overlap-y", "0");
+        patch->setFrameData("patch-spacing-x", "1");
+        patch->setFrameData("patch-spacing-y", "1");
+        patches.push_back(patch);
+    }
+    auto batch = Batch::New();
+    batch->create(patches);
+
+    auto stitcher = PatchStitcher::New();
+    stitcher->setBlendingMode(PatchStitcher::BlendingMode::LINEAR);
+    stitcher->setInputData(batch);
+    auto output = stitcher->updateAndGetOutputData<Image>();
+    REQUIRE(output->getWidth() == fullWidth);
+
+    // Linear weight along x of a position in a patch
+    auto weight = [=](int position) {
+        const int distance = std::min(position, patchWidth - 1 - position);
+        return std::min(1.0f, (distance + 1.0f) / (overlap + 1.0f));
+    };
+    auto access = output->getImageAccess(ACCESS_READ);
+    for(int y = 0; y < patchHeight; ++y) {
+        for(int x = 0; x < fullWidth; ++x) {
+            float expected;
+            if(x < overlap) {
+                expected = 10.0f;
+            } else if(x >= patchWidth) {
+                expected = 20.0f;
+            } else {
+                // Overlap: weighted average of both patches
+                const float weight1 = weight(x);
+                const float weight2 = weight(x - overlap);
+                expected = (10.0f*weight1 + 20.0f*weight2) / (weight1 + weight2);
+            }
+            REQUIRE(access->getScalar(Vector2i(x, y)) == Approx(expected));
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include "KDTree.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace fast {
+
+static MatrixXf getVertexPositions(Mesh::pointer mesh) {
+    auto access = mesh->getMeshAccess(ACCESS_READ);
+    std::vector<MeshVertex> vertices = access->getVertices();
+    MatrixXf points(3, vertices.size());
+    for(int i = 0; i < vertices.size(); ++i)
+        points.col(i) = vertices[i].getPosition();
+    return points;
+}
+
+KDTree::KDTree(Mesh::pointer mesh, int maxLeafSize) : KDTree(getVertexPositions(mesh), maxLeafSize) {
+}
+
+KDTree::KDTree(const MatrixXf& points, int maxLeafSize) {
+    if(maxLeafSize < 1)
+        throw Exception("Max leaf size of KDTree must be at least 1");
+    m_indices.resize(points.cols());
+    for(int i = 0; i < points.cols(); ++i)
+        m_indices[i] = i;
+    m_points = points;
+    if(points.cols() > 0) {
+        build(0, points.cols(), maxLeafSize);
+        // Store points in tree order to make the search cache friendly
+        for(int i = 0; i < points.cols(); ++i)
+            m_points.col(i) = points.col(m_indices[i]);
+    }
+}
+
+int KDTree::build(int begin, int end, int maxLeafSize) {
+    const int nodeIndex = m_nodes.size();
+    m_nodes.push_back({begin, end, -1, -1, 0, 0.0f});
+    if(end - begin <= maxLeafSize)
+        return nodeIndex;
+
+    // Split on the dimension with the largest spread
+    VectorXf minimum = VectorXf::Constant(m_points.rows(), std::numeric_limits<float>::max());
+    VectorXf maximum = VectorXf::Constant(m_points.rows(), std::numeric_limits<float>::lowest());
+    for(int i = begin; i < end; ++i) {
+        minimum = minimum.cwiseMin(m_points.col(m_indices[i]));
+        maximum = maximum.cwiseMax(m_points.col(m_indices[i]));
+    }
+    int splitDimension;
+    const float spread = (maximum - minimum).maxCoeff(&splitDimension);
+    if(spread <= 0.0f) // All points are equal
+        return nodeIndex;
+
+    // Split at the median
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(m_indices.begin() + begin, m_indices.begin() + middle, m_indices.begin() + end, [this, splitDimension](int a, int b) {
+        return m_points(splitDimension, a) < m_points(splitDimension, b);
+    });
+    const float splitValue = m_points(splitDimension, m_indices[middle]);
+    const int left = build(begin, middle, maxLeafSize);
+    const int right = build(middle, end, maxLeafSize);
+    Node& node = m_nodes[nodeIndex];
+    node.left = left;
+    node.right = right;
+    node.splitDimension = splitDimension;
+    node.splitValue = splitValue;
+    return nodeIndex;
+}
+
+float KDTree::getSquaredDistance(const float* point, int i) const {
+    const float* other = m_points.col(i).data();
+    float distance = 0.0f;
+    for(int d = 0; d < m_points.rows(); ++d) {
+        const float difference = point[d] - other[d];
+        distance += difference*difference;
+    }
+    return distance;
+}
+
+void KDTree::findNearestNeighbor(int nodeIndex, const float* point, int& nearest, float& nearestSquaredDistance) const {
+    const Node& node = m_nodes[nodeIndex];
+    if(node.left < 0) {
+        for(int i = node.begin; i < node.end; ++i) {
+            const float distance = getSquaredDistance(point, i);
+            if(distance < nearestSquaredDistance) {
+                nearestSquaredDistance = distance;
+                nearest = i;
+            }
+        }
+        return;
+    }
+    // Search the side of the point first, and the other side only if it can contain a closer point
+    const float planeDistance = point[node.splitDimension] - node.splitValue;
+    const int nearSide = planeDistance < 0.0f ? node.left : node.right;
+    const int farSide = planeDistance < 0.0f ? node.right : node.left;
+    findNearestNeighbor(nearSide, point, nearest, nearestSquaredDistance);
+    if(planeDistance*planeDistance < nearestSquaredDistance)
+        findNearestNeighbor(farSide, point, nearest, nearestSquaredDistance);
+}
+
+int KDTree::findNearestNeighbor(const VectorXf& point, float* distance) const {
+    if(m_nodes.empty())
+        throw Exception("Can't search an empty KDTree");
+    if(point.size() != m_points.rows())
+        throw Exception("Point has " + std::to_string(point.size()) + " dimensions, while the KDTree has " + std::to_string(m_points.rows()));
+    int nearest = 0;
+    float nearestSquaredDistance = std::numeric_limits<float>::max();
+    findNearestNeighbor(0, point.data(), nearest, nearestSquaredDistance);
+    if(distance != nullptr)
+        *distance = std::sqrt(nearestSquaredDistance);
+    return m_indices[nearest];
+}
+
+std::vector<int> KDTree::findNearestNeighbors(const MatrixXf& points) const {
+    if(m_nodes.empty())
+        throw Exception("Can't search an empty KDTree");
+    if(points.rows() != m_points.rows())
+        throw Exception("Points have " + std::to_string(points.rows()) + " dimensions, while the KDTree has " + std::to_string(m_points.rows()));
+    std::vector<int> result(points.cols());
+    #pragma omp parallel for
+    for(int i = 0; i < points.cols(); ++i) {
+        int nearest = 0;
+        float nearestSquaredDistance = std::numeric_limits<float>::max();
+        findNearestNeighbor(0, points.col(i).data(), nearest, nearestSquaredDistance);
+        result[i] = m_indices[nearest];
+    }
+    return result;
+}
+
+void KDTree::findNeighborsWithinRadius(int nodeIndex, const float* point, float squaredRadius, std::vector<int>& neighbors) const {
+    const Node& node = m_nodes[nodeIndex];
+    if(node.left < 0) {
+        for(int i = node.begin; i < node.end; ++i) {
+            if(getSquaredDistance(point, i) <= squaredRadius)
+                neighbors.push_back(m_indices[i]);
+        }
+        return;
+    }
+    const float planeDistance = point[node.splitDimension] - node.splitValue;
+    if(planeDistance < 0.0f || planeDistance*planeDistance <= squaredRadius)
+        findNeighborsWithinRadius(node.left, point, squaredRadius, neighbors);
+    if(planeDistance >= 0.0f || planeDistance*planeDistance <= squaredRadius)
+        findNeighborsWithinRadius(node.right, point, squaredRadius, neighbors);
+}
+
+std::vector<int> KDTree::findNeighborsWithinRadius(const VectorXf& point, float radius) const {
+    if(point.size() != m_points.rows())
+        throw Exception("Point has " + std::to_string(point.size()) + " dimensions, while the KDTree has " + std::to_string(m_points.rows()));
+    std::vector<int> neighbors;
+    if(!m_nodes.empty())
+        findNeighborsWithinRadius(0, point.data(), radius*radius, neighbors);
+    return neighbors;
+}
+
+int KDTree::getNrOfPoints() const {
+    return m_points.cols();
+}
+
+int KDTree::getDimensions() const {
+    return m_points.rows();
+}
+
+}
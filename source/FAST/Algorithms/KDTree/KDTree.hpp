@@ -0,0 +1,76 @@
+#pragma once
+
+#include "FAST/Data/DataTypes.hpp"
+#include "FAST/Data/Mesh.hpp"
+
+namespace fast {
+
+/**
+ * KD-tree for fast nearest neighbor search in a static set of points of any dimension.
+ * The tree is built once, and can then be searched by several threads at the same time.
+ */
+class FAST_EXPORT KDTree {
+    public:
+        /**
+         * Build a tree of a point set
+         *
+         * @param points DxN matrix of N points with D dimensions
+         * @param maxLeafSize Max nr of points in each leaf node
+         */
+        explicit KDTree(const MatrixXf& points, int maxLeafSize = 16);
+        /**
+         * Build a tree of the vertex positions of a mesh. The mesh transformation is not applied.
+         *
+         * @param mesh
+         * @param maxLeafSize Max nr of points in each leaf node
+         */
+        explicit KDTree(Mesh::pointer mesh, int maxLeafSize = 16);
+        /**
+         * Find the nearest point
+         *
+         * @param point
+         * @param distance If not null, the distance to the nearest point is stored here
+         * @return index of nearest point in the point set the tree was built from
+         */
+        int findNearestNeighbor(const VectorXf& point, float* distance = nullptr) const;
+        /**
+         * Find the nearest point of each point in parallel
+         *
+         * @param points DxM matrix of M points
+         * @return index of nearest point for each of the M points
+         */
+        std::vector<int> findNearestNeighbors(const MatrixXf& points) const;
+        /**
+         * Find all points within a radius
+         *
+         * @param point
+         * @param radius
+         * @return indices of the points, in no particular order
+         */
+        std::vector<int> findNeighborsWithinRadius(const VectorXf& point, float radius) const;
+        int getNrOfPoints() const;
+        int getDimensions() const;
+    private:
+        struct Node {
+            // Range of points in this node
+            int begin;
+            int end;
+            // Children, -1 if this is a leaf
+            int left;
+            int right;
+            int splitDimension;
+            float splitValue;
+        };
+        int build(int begin, int end, int maxLeafSize);
+        void findNearestNeighbor(int node, const float* point, int& nearest, float& nearestSquaredDistance) const;
+        void findNeighborsWithinRadius(int node, const float* point, float squaredRadius, std::vector<int>& neighbors) const;
+        float getSquaredDistance(const float* point, int i) const;
+
+        // Points, reordered so that the points of each node are contiguous
+        MatrixXf m_points;
+        // Original index of each reordered point
+        std::vector<int> m_indices;
+        std::vector<Node> m_nodes;
+};
+
+}
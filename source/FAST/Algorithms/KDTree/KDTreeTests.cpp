@@ -0,0 +1,69 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Algorithms/KDTree/KDTree.hpp"
+#include <random>
+
+namespace fast {
+
+// Brute force nearest neighbor search for comparison
+static int findNearestNeighborBruteForce(const MatrixXf& points, const VectorXf& point) {
+    int nearest = 0;
+    for(int i = 1; i < points.cols(); ++i) {
+        if((points.col(i) - point).squaredNorm() < (points.col(nearest) - point).squaredNorm())
+            nearest = i;
+    }
+    return nearest;
+}
+
+TEST_CASE("KDTree nearest neighbor search gives same result as brute force", "[fast][KDTree]") {
+    std::default_random_engine engine;
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    for(int dimensions : {3, 6}) {
+        MatrixXf points = MatrixXf::NullaryExpr(dimensions, 2000, [&]() { return distribution(engine); });
+        MatrixXf queries = MatrixXf::NullaryExpr(dimensions, 500, [&]() { return distribution(engine); });
+        KDTree tree(points);
+        CHECK(tree.getNrOfPoints() == 2000);
+        CHECK(tree.getDimensions() == dimensions);
+
+        std::vector<int> result = tree.findNearestNeighbors(queries);
+        for(int i = 0; i < queries.cols(); ++i) {
+            const int expected = findNearestNeighborBruteForce(points, queries.col(i));
+            CHECK(result[i] == expected);
+            float distance;
+            CHECK(tree.findNearestNeighbor(queries.col(i), &distance) == expected);
+            CHECK(distance == Approx((points.col(expected) - queries.col(i)).norm()));
+        }
+        // Points in the tree are their own nearest neighbors
+        CHECK(tree.findNearestNeighbor(points.col(42)) == 42);
+    }
+}
+
+TEST_CASE("KDTree radius search", "[fast][KDTree]") {
+    std::default_random_engine engine;
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    MatrixXf points = MatrixXf::NullaryExpr(3, 1000, [&]() { return distribution(engine); });
+    KDTree tree(points, 4);
+    const Vector3f point(1, 2, 3);
+    std::vector<int> neighbors = tree.findNeighborsWithinRadius(point, 4.0f);
+    std::sort(neighbors.begin(), neighbors.end());
+    std::vector<int> expected;
+    for(int i = 0; i < points.cols(); ++i) {
+        if((points.col(i) - point).norm() <= 4.0f)
+            expected.push_back(i);
+    }
+    CHECK(neighbors == expected);
+}
+
+TEST_CASE("KDTree of mesh vertices with duplicate points", "[fast][KDTree]") {
+    std::vector<MeshVertex> vertices;
+    for(int i = 0; i < 100; ++i)
+        vertices.push_back(MeshVertex(Vector3f(1, 1, 1)));
+    vertices.push_back(MeshVertex(Vector3f(5, 5, 5)));
+    auto mesh = Mesh::New();
+    mesh->create(vertices);
+    KDTree tree(mesh);
+    CHECK(tree.getNrOfPoints() == 101);
+    CHECK(tree.findNearestNeighbor(Vector3f(4, 4, 4)) == 100);
+    CHECK(tree.findNeighborsWithinRadius(Vector3f(1, 1, 1), 0.1f).size() == 100);
+}
+
+}
@@ -0,0 +1,281 @@
+#include "DynamicBatchGenerator.hpp"
+#include "NeuralNetwork.hpp"
+#include <FAST/Data/Image.hpp>
+
+namespace fast {
+
+DynamicBatchGenerator::DynamicBatchGenerator() {
+    createInputPort<DataObject>(0); // Image or Tensor
+    createOutputPort<Batch>(0);
+
+    m_maxBatchSize = -1;
+    m_maxLatency = std::chrono::microseconds(10000);
+}
+
+uint DynamicBatchGenerator::addInputConnection(DataChannel::pointer port) {
+    uint nr = getNrOfInputConnections();
+    if(nr > 0)
+        createInputPort<DataObject>(nr);
+    setInputConnection(nr, port);
+    return nr;
+}
+
+int DynamicBatchGenerator::getBatchSize() const {
+    int size = m_maxBatchSize;
+    if(m_engine && (size <= 0 || m_engine->getMaxBatchSize() < size))
+        size = m_engine->getMaxBatchSize();
+    return size;
+}
+
+void DynamicBatchGenerator::collectFrames(uint inputNr) {
+    auto parent = m_parents[inputNr];
+    auto po = parent->getProcessObject();
+    const std::size_t maxQueueSize = 4*getBatchSize();
+    bool firstTime = true;
+    while(true) {
+        SharedPointer<DataObject> data;
+        try {
+            // Parent is executed the first time, thus drop it here. The collectors may share upstream POs,
+            // which is safe since ProcessObject serializes concurrent updates.
+            if(!firstTime)
+                po->update();
+            firstTime = false;
+            data = parent->getNextFrame();
+        } catch(ThreadStopped &e) {
+            break;
+        }
+        data->setFrameData("batch-input-port", std::to_string(inputNr));
+        const bool lastFrame = data->isLastFrame();
+        {
+            // Block if the network is not able to keep up
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            while(m_queue.size() >= maxQueueSize && !m_stopCollecting)
+                m_queueCondition.wait(lock);
+            if(m_stopCollecting)
+                break;
+            m_queue.push_back({data, std::chrono::steady_clock::now()});
+        }
+        m_queueCondition.notify_all();
+        if(lastFrame)
+            break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        --m_activeInputs;
+    }
+    m_queueCondition.notify_all();
+}
+
+void DynamicBatchGenerator::generateStream() {
+    const int batchSize = getBatchSize();
+    m_activeInputs = m_parents.size();
+    for(uint i = 0; i < m_parents.size(); ++i)
+        m_collectorThreads.emplace_back(&DynamicBatchGenerator::collectFrames, this, i);
+
+    while(true) {
+        std::vector<SharedPointer<DataObject>> frames;
+        bool lastBatch;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            while(m_queue.empty() && m_activeInputs > 0 && !m_stopCollecting)
+                m_queueCondition.wait(lock);
+            if(m_queue.empty() || m_stopCollecting)
+                break;
+            // Wait for a full batch, or until the oldest frame has waited too long
+            const auto deadline = m_queue.front().arrival + m_maxLatency;
+            while(m_queue.size() < (std::size_t)batchSize && m_activeInputs > 0 && !m_stopCollecting) {
+                if(m_queueCondition.wait_until(lock, deadline) == std::cv_status::timeout)
+                    break;
+            }
+            while(!m_queue.empty() && frames.size() < (std::size_t)batchSize) {
+                frames.push_back(m_queue.front().data);
+                m_queue.pop_front();
+            }
+            lastBatch = m_queue.empty() && m_activeInputs == 0;
+        }
+        m_queueCondition.notify_all();
+
+        auto batch = Batch::New();
+        std::vector<Image::pointer> images;
+        std::vector<Tensor::pointer> tensors;
+        for(auto&& frame : frames) {
+            auto image = std::dynamic_pointer_cast<Image>(frame);
+            if(image) {
+                images.push_back(image);
+            } else {
+                auto tensor = std::dynamic_pointer_cast<Tensor>(frame);
+                if(!tensor)
+                    throw Exception("DynamicBatchGenerator only supports images and tensors as input");
+                tensors.push_back(tensor);
+            }
+        }
+        if(!images.empty() && !tensors.empty())
+            throw Exception("DynamicBatchGenerator can't mix images and tensors in a batch");
+        if(!images.empty()) {
+            batch->create(images);
+        } else {
+            batch->create(tensors);
+        }
+        if(lastBatch)
+            batch->setLastFrame(getNameOfClass());
+        try {
+            addOutputData(0, batch);
+        } catch(ThreadStopped &e) {
+            break;
+        }
+        frameAdded();
+        if(lastBatch)
+            break;
+    }
+
+    // Stop collectors
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopCollecting = true;
+    }
+    m_queueCondition.notify_all();
+    for(auto&& thread : m_collectorThreads)
+        thread.join();
+    m_collectorThreads.clear();
+}
+
+void DynamicBatchGenerator::execute() {
+    if(getBatchSize() <= 0)
+        throw Exception("Max batch size or inference engine must be given to the DynamicBatchGenerator");
+
+    if(!m_streamIsStarted) {
+        m_streamIsStarted = true;
+        for(uint i = 0; i < getNrOfInputConnections(); ++i)
+            m_parents.push_back(mInputConnections[i]);
+        detachInputConnections(); // Severe the connections
+        m_thread = std::make_unique<std::thread>(std::bind(&DynamicBatchGenerator::generateStream, this));
+    }
+
+    waitForFirstFrame();
+}
+
+void DynamicBatchGenerator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopCollecting = true;
+    }
+    m_queueCondition.notify_all();
+    // Unblock collectors waiting for new frames
+    for(auto&& parent : m_parents)
+        parent->stop();
+    Streamer::stop();
+}
+
+void DynamicBatchGenerator::setMaxBatchSize(int size) {
+    if(size <= 0)
+        throw Exception("Max batch size must be larger than 0");
+    m_maxBatchSize = size;
+    mIsModified = true;
+}
+
+void DynamicBatchGenerator::setMaxLatency(float milliseconds) {
+    if(milliseconds < 0)
+        throw Exception("Max latency can't be negative");
+    m_maxLatency = std::chrono::microseconds((int64_t)(milliseconds*1000));
+    mIsModified = true;
+}
+
+void DynamicBatchGenerator::setInferenceEngine(InferenceEngine::pointer engine) {
+    m_engine = engine;
+    mIsModified = true;
+}
+
+DynamicBatchGenerator::~DynamicBatchGenerator() {
+    stop();
+}
+
+BatchSplitter::BatchSplitter() {
+    createInputPort<DataObject>(0); // Batch, Image or Tensor
+    createOutputPort<DataObject>(0);
+    m_nrOfOutputs = 1;
+}
+
+void BatchSplitter::setNrOfOutputs(uint outputs) {
+    if(outputs == 0)
+        throw Exception("Nr of outputs must be larger than 0");
+    for(uint i = m_nrOfOutputs; i < outputs; ++i)
+        createOutputPort<DataObject>(i);
+    m_nrOfOutputs = outputs;
+}
+
+void BatchSplitter::generateStream() {
+    // Update will eventually block, therefore we need to call this in a separate thread
+    auto po = mParent->getProcessObject();
+    bool firstTime = true;
+    bool lastFrame = false;
+    while(!lastFrame) {
+        {
+            std::unique_lock<std::mutex> lock(m_stopMutex);
+            if(m_stop) {
+                m_streamIsStarted = false;
+                m_firstFrameIsInserted = false;
+                break;
+            }
+        }
+        SharedPointer<DataObject> data;
+        try {
+            if(!firstTime) // parent is executed the first time, thus drop it here
+                po->update();
+            firstTime = false;
+            data = mParent->getNextFrame();
+        } catch(ThreadStopped &e) {
+            break;
+        }
+        lastFrame = data->isLastFrame();
+
+        std::vector<SharedPointer<DataObject>> frames;
+        auto batch = std::dynamic_pointer_cast<Batch>(data);
+        if(batch) {
+            auto access = batch->getAccess(ACCESS_READ);
+            auto list = access->getData();
+            if(list.isImages()) {
+                for(auto&& image : list.getImages())
+                    frames.push_back(image);
+            } else if(list.isTensors()) {
+                for(auto&& tensor : list.getTensors())
+                    frames.push_back(tensor);
+            }
+        } else {
+            // A batch of size 1 is not a Batch object in the output of NeuralNetwork
+            frames.push_back(data);
+        }
+
+        try {
+            for(auto&& frame : frames) {
+                uint port = 0;
+                auto frameData = frame->getFrameData();
+                if(frameData.count("batch-input-port") > 0)
+                    port = std::stoi(frameData["batch-input-port"]);
+                if(port >= m_nrOfOutputs)
+                    throw Exception("Frame from batch input " + std::to_string(port) + " but BatchSplitter only has " +
+                        std::to_string(m_nrOfOutputs) + " outputs");
+                addOutputData(port, frame);
+            }
+        } catch(ThreadStopped &e) {
+            break;
+        }
+        frameAdded();
+    }
+}
+
+void BatchSplitter::execute() {
+    if(!m_streamIsStarted) {
+        m_streamIsStarted = true;
+        mParent = mInputConnections[0];
+        detachInputConnections(); // Severe the connection
+        m_thread = std::make_unique<std::thread>(std::bind(&BatchSplitter::generateStream, this));
+    }
+
+    waitForFirstFrame();
+}
+
+BatchSplitter::~BatchSplitter() {
+    stop();
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <FAST/Streamers/Streamer.hpp>
+#include "InferenceEngine.hpp"
+#include <deque>
+#include <chrono>
+
+namespace fast {
+
+/**
+ * Collects frames from one or more streams into batches for a NeuralNetwork.
+ *
+ * A batch is sent when it has reached the max batch size, or when the oldest frame in it has waited
+ * for the max latency, whichever comes first. This lets several low rate streams share one network,
+ * and one inference call per batch. Each frame is tagged with the frame data "batch-input-port",
+ * which BatchSplitter uses to route the results back to one output port per input stream.
+ */
+class FAST_EXPORT DynamicBatchGenerator : public Streamer {
+    FAST_OBJECT(DynamicBatchGenerator)
+    public:
+        /**
+         * Add an input stream
+         * @param port
+         * @return input port ID of the stream
+         */
+        uint addInputConnection(DataChannel::pointer port);
+        /**
+         * Set max number of frames in a batch
+         * @param size
+         */
+        void setMaxBatchSize(int size);
+        /**
+         * Set max time in milliseconds a frame is kept waiting for more frames before its batch is sent.
+         * Default is 10 ms.
+         * @param milliseconds
+         */
+        void setMaxLatency(float milliseconds);
+        /**
+         * Limit the batch size to the max batch size of this inference engine
+         * @param engine
+         */
+        void setInferenceEngine(InferenceEngine::pointer engine);
+        void stop() override;
+        ~DynamicBatchGenerator() override;
+    protected:
+        void execute() override;
+        void generateStream() override;
+        bool hasAsynchronousInputs() override { return true; };
+        void collectFrames(uint inputNr);
+        int getBatchSize() const;
+
+        int m_maxBatchSize;
+        std::chrono::microseconds m_maxLatency;
+        InferenceEngine::pointer m_engine;
+        std::vector<DataChannel::pointer> m_parents;
+        std::vector<std::thread> m_collectorThreads;
+
+        struct QueuedFrame {
+            SharedPointer<DataObject> data;
+            std::chrono::steady_clock::time_point arrival;
+        };
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;
+        std::deque<QueuedFrame> m_queue;
+        int m_activeInputs = 0;
+        bool m_stopCollecting = false;
+    private:
+        DynamicBatchGenerator();
+};
+
+/**
+ * Splits batches from a DynamicBatchGenerator, or the output of a NeuralNetwork for such batches,
+ * back into single frames. Each frame is sent to the output port with the same ID as the
+ * DynamicBatchGenerator input port it came from, given by the frame data "batch-input-port".
+ * Frames keep their original frame data.
+ */
+class FAST_EXPORT BatchSplitter : public Streamer {
+    FAST_OBJECT(BatchSplitter)
+    public:
+        /**
+         * Set nr of output ports, this should be equal to the nr of inputs of the DynamicBatchGenerator
+         * @param outputs
+         */
+        void setNrOfOutputs(uint outputs);
+        ~BatchSplitter() override;
+    protected:
+        void execute() override;
+        void generateStream() override;
+        bool hasAsynchronousInputs() override { return true; };
+        uint m_nrOfOutputs;
+
+        DataChannel::pointer mParent;
+    private:
+        BatchSplitter();
+};
+
+}
@@ -23,6 +23,7 @@ class FAST_EXPORT ImageClassificationNetwork : public NeuralNetwork {
 	private:
 		ImageClassificationNetwork();
 		void execute();
+		bool supportsAsynchronousExecution() const override { return false; };
 
 		// A map of label -> score
 		std::vector<std::string> mLabels;
@@ -11,6 +11,7 @@ class FAST_EXPORT ImageToImageNetwork : public NeuralNetwork {
     private:
         ImageToImageNetwork();
         void execute();
+        bool supportsAsynchronousExecution() const override { return false; };
 };
 
 }
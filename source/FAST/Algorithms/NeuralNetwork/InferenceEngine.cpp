@@ -85,4 +85,28 @@ int InferenceEngine::getMaxBatchSize() {
     return m_maxBatchSize;
 }
 
+SharedPointer<Tensor> InferenceEngine::getInputBuffer(std::string inputNodeName, TensorShape shape) {
+    return nullptr;
+}
+
+void InferenceEngine::setZeroCopy(bool enable) {
+    m_zeroCopy = enable;
+}
+
+bool InferenceEngine::isZeroCopyEnabled() const {
+    return m_zeroCopy;
+}
+
+uint64_t InferenceEngine::getNrOfBytesCopied() const {
+    return m_bytesCopied;
+}
+
+void InferenceEngine::addNrOfBytesCopied(uint64_t bytes) {
+    m_bytesCopied += bytes;
+}
+
+void InferenceEngine::resetNrOfBytesCopied() {
+    m_bytesCopied = 0;
+}
+
 }
\ No newline at end of file
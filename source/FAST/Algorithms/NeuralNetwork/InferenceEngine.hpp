@@ -3,6 +3,7 @@
 #include "FAST/Data/DataTypes.hpp"
 #include <FAST/Data/Tensor.hpp>
 #include <FAST/Data/TensorShape.hpp>
+#include <atomic>
 
 // This is a macro for creating a load function for a given inference engine
 // Need C linkage here (extern "C" to avoid mangled names of the load function on windows, see https://stackoverflow.com/questions/19422550/why-getprocaddress-is-not-working
@@ -93,6 +94,27 @@ class FAST_EXPORT InferenceEngine : public Object {
 
         virtual int getMaxBatchSize();
         virtual void setMaxBatchSize(int size);
+        /**
+         * Get a tensor for an input node which uses memory owned by the engine,
+         * so that input data can be written directly to where the engine reads it.
+         * The memory may be reused by the next run of the engine.
+         * @param inputNodeName
+         * @param shape Shape of the input data
+         * @return tensor, or nullptr if the engine doesn't support it for this node and shape
+         */
+        virtual SharedPointer<Tensor> getInputBuffer(std::string inputNodeName, TensorShape shape);
+        /**
+         * Enable/disable zero-copy exchange of tensors with the engine. Enabled by default.
+         * @param enable
+         */
+        virtual void setZeroCopy(bool enable);
+        virtual bool isZeroCopyEnabled() const;
+        /**
+         * @return Number of bytes copied on the host between tensors of FAST and the engine, since last reset
+         */
+        uint64_t getNrOfBytesCopied() const;
+        void addNrOfBytesCopied(uint64_t bytes);
+        void resetNrOfBytesCopied();
     protected:
         virtual void setIsLoaded(bool loaded);
 
@@ -102,6 +124,8 @@ class FAST_EXPORT InferenceEngine : public Object {
         int m_deviceIndex = -1;
         InferenceDeviceType m_deviceType = InferenceDeviceType::ANY;
         int m_maxBatchSize = 1;
+        bool m_zeroCopy = true;
+        std::atomic<uint64_t> m_bytesCopied{0};
 
         std::vector<uint8_t> m_model;
         std::vector<uint8_t> m_weights;
@@ -1,11 +1,23 @@
 #include "OpenVINOEngine.hpp"
 #include <inference_engine.hpp>
 #include <FAST/Utility.hpp>
+#include <algorithm>
 
 namespace fast {
 
 using namespace InferenceEngine;
 
+/**
+ * Blobs have room for the max batch size, this gives the shape of the batch which was actually run
+ */
+static TensorShape getBatchShape(const TensorShape& shape, int batchSize) {
+	TensorShape batchShape;
+	batchShape.addDimension(batchSize);
+	for(int i = 1; i < shape.getDimensions(); ++i)
+		batchShape.addDimension(shape[i]);
+	return batchShape;
+}
+
 void OpenVINOEngine::run() {
 	try {
 		// Copy input data
@@ -23,22 +35,72 @@ void OpenVINOEngine::run() {
                 m_inferRequest->SetBatch(batchSize);
 
 			auto input_data = input->buffer().as<PrecisionTrait<Precision::FP32>::value_type * >();
-			std::memcpy(input_data, tensorData, input->byteSize());
+			// No need to copy if the data was written directly to the blob using getInputBuffer
+			if(input_data != tensorData) {
+				const std::size_t bytes = std::min(input->byteSize(), tensor->getShape().getTotalSize()*sizeof(float));
+				std::memcpy(input_data, tensorData, bytes);
+				addNrOfBytesCopied(bytes);
+			}
 		}
 		reportInfo() << "OpenVINO: Finished processing input nodes." << reportEnd();
 
+		// Let the network write the output directly into FAST tensors owned by the engine
+		std::unordered_map<std::string, Tensor::pointer> outputTensors;
+		if(m_zeroCopy) {
+			for(auto& node : mOutputNodes) {
+				// Output of the previous run, if any, has already been given to the caller
+				node.second.data.reset();
+				Blob::Ptr output = m_inferRequest->GetBlob(node.first);
+				// Size from the blob, which has room for the max batch size
+				TensorShape shape;
+				for(auto dim : output->getTensorDesc().getDims())
+					shape.addDimension(dim);
+				auto& tensor = m_outputTensors[node.first];
+				// Only rebind when the shape changes, or the previous output is still in use, as it would be overwritten
+				const bool rebind = !tensor || tensor->getShape().getAll() != shape.getAll() || tensor.use_count() > 1;
+				if(rebind) {
+					tensor = Tensor::New();
+					tensor->create(shape);
+				}
+				// Write access marks any device copies of the previous output as out of date
+				auto access = tensor->getAccess(ACCESS_READ_WRITE);
+				if(rebind)
+					m_inferRequest->SetBlob(node.first, make_shared_blob<float>(output->getTensorDesc(), access->getRawData()));
+				if(batchSize > 0 && batchSize < shape[0]) {
+					// Only the first batchSize samples were computed, give the caller a view of those
+					auto view = Tensor::New();
+					view->create(access->getRawData(), getBatchShape(shape, batchSize), tensor);
+					outputTensors[node.first] = view;
+				} else {
+					outputTensors[node.first] = tensor;
+				}
+			}
+		}
+
 		// Execute network
         m_inferRequest->Infer();
 		reportInfo() << "OpenVINO: Network executed." << reportEnd();
 
 		// Copy output data
 		for (auto& node : mOutputNodes) {
+			if(outputTensors.count(node.first) > 0) {
+				node.second.data = outputTensors[node.first];
+				continue;
+			}
 			Blob::Ptr output = m_inferRequest->GetBlob(node.first);
 			auto outputData = (output->buffer().as<::InferenceEngine::PrecisionTrait<Precision::FP32>::value_type *>());
-			auto copied_data = make_uninitialized_unique<float[]>(output->byteSize());
-			std::memcpy(copied_data.get(), outputData, output->byteSize());
+			TensorShape shape;
+			for(auto dim : output->getTensorDesc().getDims())
+				shape.addDimension(dim);
+			if(batchSize > 0 && batchSize < shape[0])
+				shape = getBatchShape(shape, batchSize);
+			// Only copy the samples which were computed
+			const std::size_t size = shape.getTotalSize();
+			auto copied_data = make_uninitialized_unique<float[]>(size);
+			std::memcpy(copied_data.get(), outputData, size*sizeof(float));
+			addNrOfBytesCopied(size*sizeof(float));
 			auto tensor = Tensor::New();
-			tensor->create(std::move(copied_data), node.second.shape);
+			tensor->create(std::move(copied_data), shape);
 			node.second.data = tensor;
 		}
 		reportInfo() << "OpenVINO: Finished processing output nodes." << reportEnd();
@@ -48,6 +110,18 @@ void OpenVINOEngine::run() {
 	}
 }
 
+Tensor::pointer OpenVINOEngine::getInputBuffer(std::string inputNodeName, TensorShape shape) {
+	if(!m_zeroCopy || !isLoaded())
+		return nullptr;
+	Blob::Ptr input = m_inferRequest->GetBlob(inputNodeName);
+	// The blob has room for the max batch size
+	if(shape.getUnknownDimensions() > 0 || shape.getTotalSize()*sizeof(float) > input->byteSize())
+		return nullptr;
+	auto tensor = Tensor::New();
+	tensor->create(input->buffer().as<PrecisionTrait<Precision::FP32>::value_type*>(), shape, input);
+	return tensor;
+}
+
 void OpenVINOEngine::loadPlugin(std::string deviceName) {
 
     reportInfo() << "OpenVINO: Inference plugin setup complete for device type " << deviceName << reportEnd();
@@ -23,9 +23,16 @@ class INFERENCEENGINEOPENVINO_EXPORT OpenVINOEngine : public InferenceEngine {
 
 		std::string getDefaultFileExtension() const override;
 
+        /**
+         * Input data written to this tensor is written directly to the input blob of the network
+         */
+        Tensor::pointer getInputBuffer(std::string inputNodeName, TensorShape shape) override;
+
         ~OpenVINOEngine();
     private:
         std::shared_ptr<::InferenceEngine::Core> m_inferenceCore;
+        // Output tensors bound to the output blobs of the network when zero-copy is enabled
+        std::unordered_map<std::string, Tensor::pointer> m_outputTensors;
         // This has to be last, because then inferRequest will be deleted before the plugin, which is necessary to avoid a crash on delete
         std::shared_ptr<::InferenceEngine::InferRequest> m_inferRequest;
 		
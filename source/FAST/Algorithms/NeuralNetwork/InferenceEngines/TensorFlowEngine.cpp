@@ -70,6 +70,27 @@ float* TensorFlowTensor::getHostDataPointer() {
     return m_tensorflowTensor->tensor.flat<float>().data();
 }
 
+TensorFlowTensorWrapper* TensorFlowTensor::getTensorFlowTensor() const {
+    return m_tensorflowTensor;
+}
+
+Tensor::pointer TensorFlowEngine::getInputBuffer(std::string inputNodeName, TensorShape shape) {
+    if(!m_zeroCopy || shape.getUnknownDimensions() > 0)
+        return nullptr;
+    // Reuse the buffer of the previous run if the shape is unchanged
+    auto& tensor = m_inputBuffers[inputNodeName];
+    if(tensor && tensor->getShape().getAll() == shape.getAll())
+        return tensor;
+    // Allocate a tensorflow tensor which FAST can write to directly
+    tensorflow::TensorShape tensorShape;
+    for(auto i : shape.getAll())
+        tensorShape.AddDim(i);
+    auto tensorflowTensor = TensorFlowTensor::New();
+    tensorflowTensor->create(new TensorFlowTensorWrapper(tensorflow::Tensor(tensorflow::DT_FLOAT, tensorShape)));
+    tensor = tensorflowTensor;
+    return tensor;
+}
+
 static TensorShape getShape(const tensorflow::NodeDef& node) {
     TensorShape resultShape;
     if(node.attr().count("shape") > 0) {
@@ -97,6 +118,13 @@ void TensorFlowEngine::run() {
 		if(shape.getUnknownDimensions() > 0)
 		    throw Exception("Input shape must be fully known when executing NN");
 
+        // If the data was written to a tensor from getInputBuffer, give it directly to tensorflow
+        auto tensorflowTensor = std::dynamic_pointer_cast<TensorFlowTensor>(inputNode.second.data);
+        if(tensorflowTensor) {
+            input_tensors.push_back(std::make_pair(name, tensorflowTensor->getTensorFlowTensor()->tensor));
+            continue;
+        }
+
 		// Construct tensorflow tensor
         tensorflow::TensorShape tensorShape;
         for(auto i : shape.getAll()) {
@@ -130,6 +158,8 @@ void TensorFlowEngine::run() {
                 throw Exception("Invalid tensor dimension size");
 		}
 
+        addNrOfBytesCopied(shape.getTotalSize()*sizeof(float));
+
 		// Add tensorflow tensor to list of input tensors
 		input_tensors.push_back(std::make_pair(name, input_tensor));
 	}
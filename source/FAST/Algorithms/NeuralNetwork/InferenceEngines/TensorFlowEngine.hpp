@@ -18,10 +18,16 @@ class TensorFlowEngine : public InferenceEngine {
         ~TensorFlowEngine() override;
         virtual ImageOrdering getPreferredImageOrdering() const override;
         virtual std::string getDefaultFileExtension() const override;
+        /**
+         * Input data written to this tensor is stored in a tensorflow tensor, which is given to the network without copying
+         */
+        Tensor::pointer getInputBuffer(std::string inputNodeName, TensorShape shape) override;
         TensorFlowEngine();
     protected:
         std::unique_ptr<tensorflow::Session> mSession;
         std::vector<std::string> mLearningPhaseTensors;
+        // Input buffers given out by getInputBuffer, reused while the shape is unchanged
+        std::unordered_map<std::string, Tensor::pointer> m_inputBuffers;
 
 };
 
@@ -36,6 +42,7 @@ class TensorFlowTensor : public Tensor {
     FAST_OBJECT(TensorFlowTensor)
     public:
         void create(TensorFlowTensorWrapper* tensorflowTensor);
+        TensorFlowTensorWrapper* getTensorFlowTensor() const;
         ~TensorFlowTensor();
     private:
         TensorFlowTensorWrapper* m_tensorflowTensor;
@@ -58,13 +58,18 @@ NeuralNetwork::NeuralNetwork() {
 std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData() {
     std::unordered_map<std::string, Tensor::pointer> tensors;
     m_batchSize = -1;
-    for(auto inputNode : m_engine->getInputNodes()) {
+    for(auto inputNode : getInputNodes()) {
         auto shape = inputNode.second.shape;
         if(shape.getDimensions() == 0)
             throw Exception("Unable to deduce input shape from network file. "
                             "Either export the file with shape information or supply the input shape manually using setInputNode.");
 
-        SharedPointer<DataObject> data = getInputData<DataObject>(inputNode.second.portID);
+        SharedPointer<DataObject> data;
+        if(m_inputData.count(inputNode.second.portID) > 0) {
+            data = m_inputData[inputNode.second.portID];
+        } else {
+            data = getInputData<DataObject>(inputNode.second.portID);
+        }
         mRuntimeManager->startRegularTimer("input_processing");
 
         bool containsSequence = false;
@@ -164,7 +169,7 @@ std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData
 
                 // Convert images to tensors
                 shape[0] = m_batchSize;
-                tensors[inputNode.first] = convertImagesToTensor(inputImages2, shape, containsSequence);
+                tensors[inputNode.first] = convertImagesToTensor(inputImages2, shape, containsSequence, inputNode.first);
             } else {
                 // TODO fix ordering if necessary
                 // We have a list of tensors, convert the list of tensors into a single tensor
@@ -179,6 +184,7 @@ std::unordered_map<std::string, Tensor::pointer> NeuralNetwork::processInputData
                     auto accessRead = inputTensors[i]->getAccess(ACCESS_READ);
                     const int totalSize = accessRead->getShape().getTotalSize();
                     std::memcpy(&data[i*totalSize], accessRead->getRawData(), totalSize*sizeof(float));
+                    m_engine->addNrOfBytesCopied(totalSize*sizeof(float));
                 }
             }
         } else {
@@ -212,21 +218,37 @@ void NeuralNetwork::run() {
 }
 
 void NeuralNetwork::execute() {
+    if(m_asynchronous) {
+        executeAsynchronously();
+        return;
+    }
+
     // Load, prepare input and run network
     run();
 
     mRuntimeManager->startRegularTimer("output_processing");
 	// Collect output data of network and add to output ports
-    for(const auto &node : m_engine->getOutputNodes()) {
+    std::unordered_map<std::string, Tensor::pointer> outputTensors;
+    for(const auto &node : m_engine->getOutputNodes())
+        outputTensors[node.first] = m_engine->getOutputData(node.first);
+    for(auto&& output : processOutputData(outputTensors, mInputImages, m_batchSize))
+        addOutputData(output.first, output.second);
+    mRuntimeManager->stopRegularTimer("output_processing");
+}
+
+std::vector<std::pair<uint, SharedPointer<DataObject>>> NeuralNetwork::processOutputData(
+        std::unordered_map<std::string, Tensor::pointer> outputTensors,
+        std::unordered_map<std::string, std::vector<SharedPointer<Image>>> inputImages,
+        int batchSize) {
+    std::vector<std::pair<uint, SharedPointer<DataObject>>> outputData;
+    for(const auto &node : getOutputNodes()) {
         // TODO if input was a batch, the output should be converted to a batch as well
         // TODO and any frame data (such as patch info should be transferred)
-        auto tensor = m_engine->getOutputData(node.first);
+        auto tensor = outputTensors[node.first];
 
-        if(m_batchSize > 1) {
+        if(batchSize > 1) {
             // Create a batch of tensors
             std::vector<Tensor::pointer> tensorList;
-            auto tensorAccess = tensor->getAccess(ACCESS_READ);
-            const float* rawTensorData = tensorAccess->getRawData();
             // Calculate sample size
             auto shape = tensor->getShape();
             int size = 1;
@@ -236,47 +258,264 @@ void NeuralNetwork::execute() {
                 newShape.addDimension(shape[i]);
             }
 
-            for(int i = 0; i < m_batchSize; ++i) {
-                auto newTensor = Tensor::New();
-                auto newData = make_uninitialized_unique<float[]>(size);
-                std::memcpy(newData.get(), &(rawTensorData[i*size]), size*sizeof(float));
-                newTensor->create(std::move(newData), newShape);
+            for(int i = 0; i < batchSize; ++i) {
+                Tensor::pointer newTensor;
+                if(m_engine->isZeroCopyEnabled()) {
+                    // View of the sample in the output tensor
+                    newTensor = tensor->getSubTensor(i);
+                } else {
+                    newTensor = Tensor::New();
+                    auto tensorAccess = tensor->getAccess(ACCESS_READ);
+                    auto newData = make_uninitialized_unique<float[]>(size);
+                    std::memcpy(newData.get(), tensorAccess->getRawData() + (std::size_t)i*size, size*sizeof(float));
+                    m_engine->addNrOfBytesCopied(size*sizeof(float));
+                    newTensor->create(std::move(newData), newShape);
+                }
                 tensorList.push_back(newTensor);
-                for(auto& inputNode : m_engine->getInputNodes()) {
+                for(auto& inputNode : getInputNodes()) {
                     // TODO assuming input are images here:
-                    for(auto &&frameData : mInputImages[inputNode.first][i]->getFrameData()) {
+                    for(auto &&frameData : inputImages[inputNode.first][i]->getFrameData()) {
                         newTensor->setFrameData(frameData.first, frameData.second);
                     }
-                    for(auto &&lastFrame : mInputImages[inputNode.first][i]->getLastFrame())
+                    for(auto &&lastFrame : inputImages[inputNode.first][i]->getLastFrame())
                         newTensor->setLastFrame(lastFrame);
                 }
             }
             auto outputBatch = Batch::New();
             outputBatch->create(tensorList);
-            addOutputData(node.second.portID, outputBatch);
+            outputData.push_back({node.second.portID, outputBatch});
         } else {
             // Remove first dimension as it is 1, due to batch size 1
             tensor->deleteDimension(0);
-            for(auto& inputNode : m_engine->getInputNodes()) {
+            for(auto& inputNode : getInputNodes()) {
                 // TODO assuming input are images here: Should also be able to handle tensors
-                for(auto &&frameData : mInputImages[inputNode.first][0]->getFrameData()) {
+                for(auto &&frameData : inputImages[inputNode.first][0]->getFrameData()) {
                     tensor->setFrameData(frameData.first, frameData.second);
                 }
-                for(auto &&lastFrame : mInputImages[inputNode.first][0]->getLastFrame())
+                for(auto &&lastFrame : inputImages[inputNode.first][0]->getLastFrame())
                     tensor->setLastFrame(lastFrame);
             }
-            addOutputData(node.second.portID, tensor);
+            outputData.push_back({node.second.portID, tensor});
         }
     }
-    mRuntimeManager->stopRegularTimer("output_processing");
+    return outputData;
+}
+
+std::unordered_map<std::string, InferenceEngine::NetworkNode> NeuralNetwork::getInputNodes() const {
+    // In asynchronous mode the engine is used by the inference thread, thus use the snapshot
+    if(m_asynchronous)
+        return m_inputNodes;
+    return m_engine->getInputNodes();
+}
+
+std::unordered_map<std::string, InferenceEngine::NetworkNode> NeuralNetwork::getOutputNodes() const {
+    if(m_asynchronous)
+        return m_outputNodes;
+    return m_engine->getOutputNodes();
+}
+
+void NeuralNetwork::setAsynchronousExecution(bool enable, int maxFramesInFlight) {
+    if(enable && !supportsAsynchronousExecution())
+        throw Exception("Asynchronous execution is not supported by " + getNameOfClass());
+    if(maxFramesInFlight < 1)
+        throw Exception("Max frames in flight must be > 0 in NeuralNetwork::setAsynchronousExecution");
+    if(m_asynchronousPipelineStarted)
+        throw Exception("Asynchronous execution can't be changed after the network has started executing");
+    m_asynchronous = enable;
+    m_maxFramesInFlight = maxFramesInFlight;
+}
+
+bool NeuralNetwork::InferenceJobQueue::push(std::shared_ptr<InferenceJob> job) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(m_jobs.size() >= m_capacity && !m_stop)
+            m_condition.wait(lock);
+        if(m_stop)
+            return false;
+        m_jobs.push_back(job);
+    }
+    m_condition.notify_all();
+    return true;
+}
+
+std::shared_ptr<NeuralNetwork::InferenceJob> NeuralNetwork::InferenceJobQueue::pop() {
+    std::shared_ptr<InferenceJob> job;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(m_jobs.empty() && !m_stop)
+            m_condition.wait(lock);
+        if(m_stop)
+            return nullptr;
+        job = m_jobs.front();
+        m_jobs.pop_front();
+    }
+    m_condition.notify_all();
+    return job;
+}
+
+void NeuralNetwork::InferenceJobQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+}
+
+void NeuralNetwork::startAsynchronousPipeline() {
+    if(!m_engine->isLoaded())
+        m_engine->load();
+
+    // The preprocess thread will from now on pull data from the parents, thus detach the connections
+    // so that update doesn't execute the parents as well.
+    detachInputConnections();
+
+    // The input and output processing threads only use this snapshot of the nodes, as the inference thread
+    // writes the data of the nodes of the engine
+    m_inputNodes = m_engine->getInputNodes();
+    m_outputNodes = m_engine->getOutputNodes();
+    for(auto&& node : m_inputNodes)
+        node.second.data.reset();
+    for(auto&& node : m_outputNodes)
+        node.second.data.reset();
+
+    m_preprocessedJobs = std::make_unique<InferenceJobQueue>(m_maxFramesInFlight);
+    m_inferredJobs = std::make_unique<InferenceJobQueue>(m_maxFramesInFlight);
+    m_finishedJobs = std::make_unique<InferenceJobQueue>(m_maxFramesInFlight);
+    m_preprocessThread = std::thread(&NeuralNetwork::preprocessFrames, this);
+    m_inferenceThread = std::thread(&NeuralNetwork::inferFrames, this);
+    m_postprocessThread = std::thread(&NeuralNetwork::postprocessFrames, this);
+    m_asynchronousPipelineStarted = true;
+    reportInfo() << "Started asynchronous inference pipeline" << reportEnd();
+}
+
+void NeuralNetwork::stopAsynchronousPipeline() {
+    if(!m_asynchronousPipelineStarted)
+        return;
+    m_preprocessedJobs->stop();
+    m_inferredJobs->stop();
+    m_finishedJobs->stop();
+    // Unblock the preprocess thread if it is waiting for a new frame
+    for(auto&& parent : mAsynchronousInputConnections)
+        parent.second->stop();
+    m_preprocessThread.join();
+    m_inferenceThread.join();
+    m_postprocessThread.join();
+    m_asynchronousPipelineStarted = false;
+}
+
+void NeuralNetwork::preprocessFrames() {
+    bool firstTime = true;
+    while(true) {
+        auto job = std::make_shared<InferenceJob>();
+        try {
+            for(auto&& parent : mAsynchronousInputConnections) {
+                // Parents were executed before the pipeline was started, thus skip update the first time
+                if(!firstTime)
+                    parent.second->getProcessObject()->update();
+                auto data = parent.second->getNextFrame();
+                job->inputData[parent.first] = data;
+                for(auto&& frameData : data->getFrameData())
+                    job->frameData[frameData.first] = frameData.second;
+                for(auto&& lastFrame : data->getLastFrame())
+                    job->lastFrame.insert(lastFrame);
+            }
+            firstTime = false;
+            m_inputData = job->inputData;
+            job->inputTensors = processInputData();
+            job->inputImages = mInputImages;
+            job->batchSize = m_batchSize;
+        } catch(ThreadStopped &e) {
+            break;
+        } catch(...) {
+            job->error = std::current_exception();
+        }
+        job->isLast = !job->lastFrame.empty() || job->error;
+        if(!m_preprocessedJobs->push(job) || job->isLast)
+            break;
+    }
+}
+
+void NeuralNetwork::inferFrames() {
+    while(auto job = m_preprocessedJobs->pop()) {
+        if(!job->error) {
+            try {
+                for(const auto &node : m_engine->getInputNodes())
+                    m_engine->setInputData(node.first, job->inputTensors[node.first]);
+                mRuntimeManager->startRegularTimer("inference");
+                m_engine->run();
+                mRuntimeManager->stopRegularTimer("inference");
+                for(const auto &node : m_engine->getOutputNodes())
+                    job->outputTensors[node.first] = m_engine->getOutputData(node.first);
+                // Input tensors are not needed anymore
+                job->inputTensors.clear();
+            } catch(...) {
+                job->error = std::current_exception();
+            }
+        }
+        if(!m_inferredJobs->push(job) || job->isLast)
+            break;
+    }
 }
 
-Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer> images, const TensorShape& shape, bool temporal) {
+void NeuralNetwork::postprocessFrames() {
+    while(auto job = m_inferredJobs->pop()) {
+        if(!job->error) {
+            try {
+                mRuntimeManager->startRegularTimer("output_processing");
+                job->outputData = processOutputData(job->outputTensors, job->inputImages, job->batchSize);
+                mRuntimeManager->stopRegularTimer("output_processing");
+                job->outputTensors.clear();
+                job->inputImages.clear();
+            } catch(...) {
+                job->error = std::current_exception();
+            }
+        }
+        if(!m_finishedJobs->push(job) || job->isLast)
+            break;
+    }
+}
+
+void NeuralNetwork::executeAsynchronously() {
+    if(!m_asynchronousPipelineStarted)
+        startAsynchronousPipeline();
+
+    // Send exactly one finished frame each execute
+    auto job = m_finishedJobs->pop();
+    if(!job)
+        throw ThreadStopped();
+    if(job->error)
+        std::rethrow_exception(job->error);
+
+    // Output data should have the frame data of the job, not of the newest input
+    m_frameData = job->frameData;
+    m_lastFrame = job->lastFrame;
+    for(auto&& output : job->outputData)
+        addOutputData(output.first, output.second);
+
+    // The input connections are gone, thus make sure the next update will execute this PO again
+    if(!job->isLast)
+        mIsModified = true;
+}
+
+Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer> images, const TensorShape& shape, bool temporal, std::string inputNodeName) {
     if(shape.getUnknownDimensions() > 0)
         throw Exception("Shape must be known at this time");
 
-    // Create input tensor
-    auto values = make_uninitialized_unique<float[]>(shape.getTotalSize());
+    // Create input tensor. Write directly to memory of the engine if possible.
+    // Not in asynchronous mode, as the engine may still be using the memory for the previous frame.
+    Tensor::pointer tensor;
+    if(m_engine->isZeroCopyEnabled() && !m_asynchronous && !inputNodeName.empty())
+        tensor = m_engine->getInputBuffer(inputNodeName, shape);
+    std::unique_ptr<float[]> values;
+    TensorAccess::pointer tensorAccess;
+    float* data;
+    if(tensor) {
+        tensorAccess = tensor->getAccess(ACCESS_READ_WRITE);
+        data = tensorAccess->getRawData();
+    } else {
+        values = make_uninitialized_unique<float[]>(shape.getTotalSize());
+        data = values.get();
+    }
 
     OpenCLDevice::pointer device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
     cl::Program program = getOpenCLProgram(device);
@@ -317,6 +556,8 @@ Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer>
     }
     cl::Kernel kernel(program, kernelName.c_str());
     const std::size_t size = width*height*depth*channels; // nr of elements per image
+    // Buffers must be kept alive until the non-blocking reads have finished
+    std::vector<cl::Buffer> buffers;
     for(int i = 0; i < images.size(); ++i) {
         auto image = images[i];
         if(image->getWidth() != width ||
@@ -335,6 +576,7 @@ Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer>
                 CL_MEM_WRITE_ONLY,
                 sizeof(float) * size
         );
+        buffers.push_back(buffer);
         kernel.setArg(1, buffer);
         kernel.setArg(2, mScaleFactor);
         kernel.setArg(3, mMean);
@@ -362,13 +604,16 @@ Tensor::pointer NeuralNetwork::convertImagesToTensor(std::vector<Image::pointer>
                 cl::NullRange
         );
 
-        // Read data directly into slice
-        device->getCommandQueue().enqueueReadBuffer(buffer, CL_TRUE, 0, sizeof(float) * size,
-                                                    values.get() + i*size);
+        // Read data directly into slice. Non-blocking, so that the next image can be enqueued right away
+        device->getCommandQueue().enqueueReadBuffer(buffer, CL_FALSE, 0, sizeof(float) * size,
+                                                    data + i*size);
     }
+    device->getCommandQueue().finish();
 
-    auto tensor = Tensor::New();
-    tensor->create(std::move(values), shape);
+    if(!tensor) {
+        tensor = Tensor::New();
+        tensor->create(std::move(values), shape);
+    }
     return tensor;
 }
 
@@ -413,6 +658,7 @@ void NeuralNetwork::setSignedInputNormalization(bool signedInputNormalization) {
 }
 
 NeuralNetwork::~NeuralNetwork() {
+    stopAsynchronousPipeline();
 }
 
 void NeuralNetwork::setInputNode(uint portID, std::string name, NodeType type, TensorShape shape) {
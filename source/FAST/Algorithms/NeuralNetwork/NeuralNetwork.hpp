@@ -4,6 +4,11 @@
 #include <FAST/Data/Tensor.hpp>
 #include <FAST/Data/SimpleDataObject.hpp>
 #include "InferenceEngine.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 
 namespace fast {
 
@@ -140,6 +145,18 @@ class FAST_EXPORT NeuralNetwork : public ProcessObject {
          * @param window
          */
         void setTemporalWindow(uint window);
+        /**
+         * Enable asynchronous execution. Input processing of frame N+1, inference of frame N and
+         * output processing of frame N-1 are then done in parallel on separate threads.
+         * The network will read ahead on its input connections, thus these should be streams.
+         * Timings of each stage are available as input_processing, inference and output_processing
+         * in the runtime measurements.
+         * Subclasses with their own output conversion, such as SegmentationNetwork, don't support this, and will throw.
+         *
+         * @param enable
+         * @param maxFramesInFlight Max nr of frames waiting between two stages
+         */
+        void setAsynchronousExecution(bool enable, int maxFramesInFlight = 1);
 
         void loadAttributes();
 
@@ -163,10 +180,88 @@ class FAST_EXPORT NeuralNetwork : public ProcessObject {
 
         std::unordered_map<std::string, Tensor::pointer> processInputData();
         std::vector<SharedPointer<Image>> resizeImages(const std::vector<SharedPointer<Image>>& images, int width, int height, int depth);
-        Tensor::pointer convertImagesToTensor(std::vector<SharedPointer<Image>> image, const TensorShape& shape, bool temporal);
+        /**
+         * Normalize images and put them in a tensor.
+         * If an input node name is given, the tensor will use memory of the inference engine if possible.
+         */
+        Tensor::pointer convertImagesToTensor(std::vector<SharedPointer<Image>> image, const TensorShape& shape, bool temporal, std::string inputNodeName = "");
+        /**
+         * Convert output tensors of the engine to output data objects for each output port.
+         * Batches are split and frame data of the input images is attached.
+         */
+        std::vector<std::pair<uint, SharedPointer<DataObject>>> processOutputData(
+                std::unordered_map<std::string, Tensor::pointer> outputTensors,
+                std::unordered_map<std::string, std::vector<SharedPointer<Image>>> inputImages,
+                int batchSize);
+        /**
+         * Subclasses which override execute, and thereby don't use the asynchronous pipeline, should return false
+         */
+        virtual bool supportsAsynchronousExecution() const { return true; };
 
     private:
+        /**
+         * A frame going through the asynchronous pipeline
+         */
+        struct InferenceJob {
+            std::unordered_map<uint, SharedPointer<DataObject>> inputData;
+            std::unordered_map<std::string, Tensor::pointer> inputTensors;
+            std::unordered_map<std::string, Tensor::pointer> outputTensors;
+            std::unordered_map<std::string, std::vector<SharedPointer<Image>>> inputImages;
+            int batchSize;
+            std::unordered_map<std::string, std::string> frameData;
+            std::unordered_set<std::string> lastFrame;
+            std::vector<std::pair<uint, SharedPointer<DataObject>>> outputData;
+            std::exception_ptr error;
+            bool isLast = false;
+        };
+        /**
+         * Bounded blocking queue between two stages of the asynchronous pipeline
+         */
+        class InferenceJobQueue {
+            public:
+                explicit InferenceJobQueue(int capacity) : m_capacity(capacity) {};
+                /**
+                 * @return false if the queue was stopped
+                 */
+                bool push(std::shared_ptr<InferenceJob> job);
+                /**
+                 * @return nullptr if the queue was stopped
+                 */
+                std::shared_ptr<InferenceJob> pop();
+                void stop();
+            private:
+                std::size_t m_capacity;
+                std::deque<std::shared_ptr<InferenceJob>> m_jobs;
+                std::mutex m_mutex;
+                std::condition_variable m_condition;
+                bool m_stop = false;
+        };
+
         void execute();
+        void executeAsynchronously();
+        void startAsynchronousPipeline();
+        void stopAsynchronousPipeline();
+        bool hasAsynchronousInputs() override { return m_asynchronous; };
+        void preprocessFrames();
+        void inferFrames();
+        void postprocessFrames();
+        std::unordered_map<std::string, InferenceEngine::NetworkNode> getInputNodes() const;
+        std::unordered_map<std::string, InferenceEngine::NetworkNode> getOutputNodes() const;
+
+        bool m_asynchronous = false;
+        int m_maxFramesInFlight = 1;
+        bool m_asynchronousPipelineStarted = false;
+        // Nodes of the engine, without data, used by input and output processing in asynchronous mode
+        std::unordered_map<std::string, InferenceEngine::NetworkNode> m_inputNodes;
+        std::unordered_map<std::string, InferenceEngine::NetworkNode> m_outputNodes;
+        // Input data for processInputData when it is not read from the input connections
+        std::unordered_map<uint, SharedPointer<DataObject>> m_inputData;
+        std::unique_ptr<InferenceJobQueue> m_preprocessedJobs;
+        std::unique_ptr<InferenceJobQueue> m_inferredJobs;
+        std::unique_ptr<InferenceJobQueue> m_finishedJobs;
+        std::thread m_preprocessThread;
+        std::thread m_inferenceThread;
+        std::thread m_postprocessThread;
 };
 
 }
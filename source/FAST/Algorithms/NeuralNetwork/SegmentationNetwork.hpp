@@ -14,6 +14,7 @@ class FAST_EXPORT SegmentationNetwork : public NeuralNetwork {
     private:
         SegmentationNetwork();
         void execute();
+        bool supportsAsynchronousExecution() const override { return false; };
 
 
         bool mHeatmapOutput;
@@ -2,6 +2,7 @@
 #include "NeuralNetwork.hpp"
 #include "SegmentationNetwork.hpp"
 #include "InferenceEngineManager.hpp"
+#include "DynamicBatchGenerator.hpp"
 #include <FAST/Importers/ImageFileImporter.hpp>
 #include <FAST/Visualization/SegmentationRenderer/SegmentationRenderer.hpp>
 #include <FAST/Visualization/ImageRenderer/ImageRenderer.hpp>
@@ -291,6 +292,60 @@ TEST_CASE("Execute NN on batch of 2D images", "[fast][neuralnetwork][batch]") {
     }
 }
 
+TEST_CASE("OpenVINO batches smaller than the max batch size", "[fast][neuralnetwork][batch]") {
+    if(!InferenceEngineManager::isEngineAvailable("OpenVINO")) {
+        std::cout << "Inference engine OpenVINO not available, skipping." << std::endl;
+        return;
+    }
+    std::vector<Image::pointer> images;
+    for(int i = 0; i < 3; ++i) {
+        auto importer = ImageFileImporter::New();
+        importer->setFilename(Config::getTestDataPath() + "US/JugularVein/US-2D_" + std::to_string(i) + ".mhd");
+        auto port = importer->getOutputPort();
+        importer->update();
+        images.push_back(port->getNextFrame<Image>());
+    }
+
+    for(bool zeroCopy : {true, false}) {
+        auto network = NeuralNetwork::New();
+        network->setInferenceEngine("OpenVINO");
+        network->getInferenceEngine()->setMaxBatchSize(4);
+        network->getInferenceEngine()->setZeroCopy(zeroCopy);
+        network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.xml");
+        auto port = network->getOutputPort(0);
+
+        // Partial batch
+        auto batch = Batch::New();
+        batch->create(images);
+        network->setInputData(batch);
+        network->update();
+        auto outputBatch = port->getNextFrame<Batch>();
+        auto access = outputBatch->getAccess(ACCESS_READ);
+        auto list = access->getData();
+        REQUIRE(list.getSize() == 3);
+        std::vector<float> firstSample;
+        {
+            auto tensor = list.getTensors()[0];
+            REQUIRE(tensor->getShape().getDimensions() == 1);
+            REQUIRE(tensor->getShape()[0] == 6);
+            auto tensorAccess = tensor->getAccess(ACCESS_READ);
+            firstSample.assign(tensorAccess->getRawData(), tensorAccess->getRawData() + 6);
+        }
+
+        // Batch of 1, as when the dynamic batch generator flushes a single frame
+        auto singleBatch = Batch::New();
+        singleBatch->create(std::vector<Image::pointer>{images[0]});
+        network->setInputData(singleBatch);
+        network->update();
+        auto tensor = port->getNextFrame<Tensor>();
+        REQUIRE(tensor->getShape().getDimensions() == 1);
+        REQUIRE(tensor->getShape()[0] == 6);
+        auto tensorAccess = tensor->getAccess(ACCESS_READ);
+        for(int i = 0; i < 6; ++i)
+            CHECK(tensorAccess->getRawData()[i] == Approx(firstSample[i]));
+    }
+}
+
 TEST_CASE("NN: temporal input static output", "[fast][neuralnetwork][sequence]") {
     for(const std::string& engine : {"TensorFlowCPU", "TensorFlowCUDA"}) {
         if(!InferenceEngineManager::isEngineAvailable(engine)) {
@@ -421,3 +476,138 @@ TEST_CASE("NN: temporal input temporal output, streaming mode", "[fast][neuralne
         }
     }
 }
+
+TEST_CASE("NN: asynchronous execution of stream", "[fast][neuralnetwork][async]") {
+    for(auto& engine : InferenceEngineManager::getEngineList()) {
+        const int frames = 10;
+        auto streamer = ImageFileStreamer::New();
+        streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+        streamer->setMaximumNumberOfFrames(frames);
+
+        auto network = NeuralNetwork::New();
+        network->setInferenceEngine(engine);
+        if(engine.substr(0, 10) == "TensorFlow") {
+            network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR);
+            network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR);
+            network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.pb");
+        } else if(engine == "TensorRT") {
+            network->setInputNode(0, "input_1", NodeType::IMAGE, TensorShape({-1, 1, 64, 64}));
+            network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR, TensorShape({-1, 6}));
+            network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR, TensorShape({-1, 6}));
+            network->load(
+                    Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output_channels_first.uff");
+        } else {
+            network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.xml");
+        }
+        network->setAsynchronousExecution(true, 2);
+        network->setInputConnection(0, streamer->getOutputPort());
+        network->enableRuntimeMeasurements();
+        auto port1 = network->getOutputPort(0);
+        auto port2 = network->getOutputPort(1);
+
+        for(int i = 0; i < frames; ++i) {
+            network->update();
+            auto data1 = port1->getNextFrame<Tensor>();
+            auto data2 = port2->getNextFrame<Tensor>();
+            REQUIRE(data1->getShape().getDimensions() == 1);
+            CHECK(data1->getShape()[0] == 6);
+            CHECK(data2->getShape()[0] == 6);
+        }
+        // Following frames may be in flight already
+        CHECK(network->getRuntime("input_processing")->getSamples() >= frames);
+        CHECK(network->getRuntime("inference")->getSamples() >= frames);
+        CHECK(network->getRuntime("output_processing")->getSamples() >= frames);
+    }
+}
+
+TEST_CASE("Dynamic batch generator batches frames from several streams and batch splitter restores them", "[fast][neuralnetwork][DynamicBatchGenerator]") {
+    const int frames = 10;
+    auto generator = DynamicBatchGenerator::New();
+    generator->setMaxBatchSize(4);
+    generator->setMaxLatency(20);
+    for(int i = 0; i < 2; ++i) {
+        auto streamer = ImageFileStreamer::New();
+        streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+        streamer->setMaximumNumberOfFrames(frames);
+        generator->addInputConnection(streamer->getOutputPort());
+    }
+
+    auto splitter = BatchSplitter::New();
+    splitter->setNrOfOutputs(2);
+    splitter->setInputConnection(generator->getOutputPort());
+    auto port0 = splitter->getOutputPort(0);
+    auto port1 = splitter->getOutputPort(1);
+    splitter->update();
+
+    std::vector<DataChannel::pointer> ports = {port0, port1};
+    for(int i = 0; i < ports.size(); ++i) {
+        int received = 0;
+        Image::pointer image;
+        do {
+            image = ports[i]->getNextFrame<Image>();
+            CHECK(image->getFrameData("batch-input-port") == std::to_string(i));
+            ++received;
+        } while(!image->isLastFrame());
+        CHECK(received == frames);
+    }
+}
+
+TEST_CASE("Dynamic batch generator with neural network and batch splitter", "[fast][neuralnetwork][DynamicBatchGenerator]") {
+    for(auto& engine : InferenceEngineManager::getEngineList()) {
+        const int frames = 10;
+        auto generator = DynamicBatchGenerator::New();
+        generator->setMaxBatchSize(4);
+        generator->setMaxLatency(20);
+        // Both inputs come from the same streamer, thus the collector threads update it concurrently
+        auto streamer = ImageFileStreamer::New();
+        streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+        streamer->setMaximumNumberOfFrames(frames);
+        for(int i = 0; i < 2; ++i)
+            generator->addInputConnection(streamer->getOutputPort());
+
+        auto network = NeuralNetwork::New();
+        network->setInferenceEngine(engine);
+        if(engine.substr(0, 10) == "TensorFlow") {
+            network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR);
+            network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR);
+            network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.pb");
+        } else if(engine == "TensorRT") {
+            network->setInputNode(0, "input_1", NodeType::IMAGE, TensorShape({-1, 1, 64, 64}));
+            network->setOutputNode(0, "dense_1/BiasAdd", NodeType::TENSOR, TensorShape({-1, 6}));
+            network->setOutputNode(1, "dense_2/BiasAdd", NodeType::TENSOR, TensorShape({-1, 6}));
+            network->load(
+                    Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output_channels_first.uff");
+        } else {
+            network->load(Config::getTestDataPath() + "NeuralNetworkModels/single_input_multi_output.xml");
+        }
+        network->setInputConnection(generator->getOutputPort());
+
+        auto splitter = BatchSplitter::New();
+        splitter->setNrOfOutputs(2);
+        splitter->setInputConnection(network->getOutputPort(0));
+        auto port0 = splitter->getOutputPort(0);
+        auto port1 = splitter->getOutputPort(1);
+        splitter->update();
+
+        // Every frame of each stream must come out of the network on the splitter port of its stream
+        std::vector<DataChannel::pointer> ports = {port0, port1};
+        for(int i = 0; i < ports.size(); ++i) {
+            int received = 0;
+            Tensor::pointer tensor;
+            do {
+                tensor = ports[i]->getNextFrame<Tensor>();
+                CHECK(tensor->getFrameData("batch-input-port") == std::to_string(i));
+                REQUIRE(tensor->getShape().getDimensions() == 1);
+                CHECK(tensor->getShape()[0] == 6);
+                ++received;
+            } while(!tensor->isLastFrame());
+            CHECK(received == frames);
+        }
+    }
+}
+
+TEST_CASE("NN: asynchronous execution is rejected by networks with their own output conversion", "[fast][neuralnetwork][async]") {
+    auto segmentation = SegmentationNetwork::New();
+    CHECK_THROWS(segmentation->setAsynchronousExecution(true));
+    CHECK_NOTHROW(segmentation->setAsynchronousExecution(false));
+}
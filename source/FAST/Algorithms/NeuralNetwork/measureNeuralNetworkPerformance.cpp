@@ -22,6 +22,7 @@ int main(int argc, char** argv) {
     parser.addOption("disable-case-2");
     parser.addOption("disable-case-3");
     parser.addOption("disable-case-3-batch");
+    parser.addOption("disable-case-4");
     parser.addOption("disable-warmup");
     parser.parse(argc, argv);
     const int iterations = 10;
@@ -30,6 +31,7 @@ int main(int argc, char** argv) {
     const bool case2 = !parser.getOption("disable-case-2");
     const bool case3 = !parser.getOption("disable-case-3");
     const bool case3_batch = !parser.getOption("disable-case-3-batch");
+    const bool case4 = !parser.getOption("disable-case-4");
 
     if(case1) {
         // CASE 1 - ULTRASOUND
@@ -415,4 +417,71 @@ int main(int argc, char** argv) {
             }
         }
     }
+
+    if(case4) {
+        // CASE 4 - BYTES COPIED ON HOST PER INFERENCE, with and without zero-copy tensors
+        const int batchSize = 4;
+        const std::string resultFilename = "neural-network-bytes-copied-case-4.csv";
+        std::ofstream file(resultFilename.c_str());
+
+        // Write header
+        file << "Engine;Zero copy;Inferences;Bytes copied;Bytes copied per inference;Total\n";
+
+        for(auto &engine : InferenceEngineManager::getEngineList()) {
+            for(bool zeroCopy : {false, true}) {
+                std::cout << engine << (zeroCopy ? " with" : " without") << " zero-copy tensors" << std::endl;
+                std::cout << "====================================" << std::endl;
+
+                auto streamer = ImageFileStreamer::New();
+                streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+
+                auto batchGenerator = ImageToBatchGenerator::New();
+                batchGenerator->setMaxBatchSize(batchSize);
+                batchGenerator->setInputConnection(streamer->getOutputPort());
+
+                auto network = NeuralNetwork::New();
+                network->setInferenceEngine(engine);
+                network->getInferenceEngine()->setMaxBatchSize(batchSize);
+                network->getInferenceEngine()->setZeroCopy(zeroCopy);
+                if(engine.substr(0, 10) == "TensorFlow") {
+                    network->setOutputNode(0, "conv2d_23/truediv", NodeType::TENSOR);
+                } else if(engine == "TensorRT") {
+                    network->setInputNode(0, "input_image", NodeType::IMAGE, TensorShape({-1, 1, 256, 256}));
+                    network->setOutputNode(0, "permute_2/transpose", NodeType::TENSOR, TensorShape({-1, 3, 256, 256}));
+                }
+                try {
+                    network->load(join(Config::getTestDataPath(),
+                                       "NeuralNetworkModels/jugular_vein_segmentation." +
+                                       network->getInferenceEngine()->getDefaultFileExtension()));
+                } catch(Exception &e) {
+                    Reporter::warning() << e.what() << Reporter::end();
+                    continue;
+                }
+                network->setScaleFactor(1.0f / 255.0f);
+                network->setInputConnection(batchGenerator->getOutputPort());
+                network->enableRuntimeMeasurements();
+
+                auto start = std::chrono::high_resolution_clock::now();
+                DataObject::pointer data;
+                do {
+                    data = network->updateAndGetOutputData<DataObject>();
+                } while(!data->isLastFrame());
+                std::chrono::duration<float, std::milli> timeUsed = std::chrono::high_resolution_clock::now() - start;
+                const uint64_t bytesCopied = network->getInferenceEngine()->getNrOfBytesCopied();
+                const int inferences = network->getRuntime("inference")->getSamples();
+                std::cout << "Total runtime: " << timeUsed.count() << std::endl;
+                std::cout << "Inferences: " << inferences << std::endl;
+                std::cout << "Bytes copied per inference: " << bytesCopied / std::max(inferences, 1) << std::endl;
+
+                file <<
+                     engine + ";" +
+                     std::to_string(zeroCopy) + ";" +
+                     std::to_string(inferences) + ";" +
+                     std::to_string(bytesCopied) + ";" +
+                     std::to_string(bytesCopied / std::max(inferences, 1)) + ";" +
+                     std::to_string(timeUsed.count())
+                     << std::endl;
+            }
+        }
+    }
 }
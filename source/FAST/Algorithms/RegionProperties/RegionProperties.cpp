@@ -1,157 +1,266 @@
 #include <FAST/Data/Image.hpp>
 #include "RegionProperties.hpp"
-#include <unordered_set>
-#include <queue>
 #include <FAST/Data/Mesh.hpp>
+#include <FAST/SceneGraph.hpp>
+#include <limits>
+#include <unordered_map>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace fast {
 
 RegionProperties::RegionProperties() {
     createInputPort<Image>(0);
     createOutputPort<RegionList>(0);
+    createOutputPort<Image>(1);
 }
 
+void RegionProperties::setStorePixels(bool store) {
+    m_storePixels = store;
+    mIsModified = true;
+}
+
+static const uint background = std::numeric_limits<uint>::max();
+
+// Union-find with path halving. Roots are always the smallest index of the set
+static uint findRoot(std::vector<uint>& parent, uint i) {
+    while(parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static void unite(std::vector<uint>& parent, uint a, uint b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if(a < b) {
+        parent[b] = a;
+    } else if(b < a) {
+        parent[a] = b;
+    }
+}
+
+// Statistics of a region which can be accumulated in any order
+struct RegionStatistics {
+    int area = 0;
+    Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+    Vector3i minimum = Vector3i::Constant(std::numeric_limits<int>::max());
+    Vector3i maximum = Vector3i::Constant(std::numeric_limits<int>::lowest());
+    int perimeter = 0;
+};
+
 void RegionProperties::execute() {
     auto input = getInputData<Image>();
     if(input->getDataType() != TYPE_UINT8)
         throw Exception("Wrong input data type to RegionProperties");
-    if(input->getDimensions() != 2)
-        throw Exception("Region properties is only implemented for 2D segmentations");
-
-    std::vector<Region> regions;
 
     const int width = input->getWidth();
     const int height = input->getHeight();
-
-    std::unordered_set<uint> visited;
+    const int depth = input->getDepth();
+    const bool is3D = input->getDimensions() == 3;
+    const std::size_t size = (std::size_t)width*height*depth;
+    if(size >= background)
+        throw Exception("Image is too large for RegionProperties");
     auto access = input->getImageAccess(ACCESS_READ);
-    auto pixels = (uchar*)access->get();
+    auto pixels = (const uchar*)access->get();
 
-    // Get regions by flood fill first
-    std::queue<Vector2i> queue;
-    for(int y = 0; y < height; ++y) {
+    // Neighbors which come before a pixel in scan order (8 connectivity in 2D, 26 in 3D)
+    std::vector<Vector3i> previousNeighbors;
+    for(int c = is3D ? -1 : 0; c <= 0; ++c) {
+        for(int b = -1; b <= 1; ++b) {
+            for(int a = -1; a <= 1; ++a) {
+                if(c < 0 || b < 0 || (b == 0 && a < 0))
+                    previousNeighbors.push_back(Vector3i(a, b, c));
+            }
+        }
+    }
+
+    // The image is split in slabs along the last axis, which are labelled in parallel
+    const int slabAxisSize = is3D ? depth : height;
+#ifdef _OPENMP
+    const int nrOfSlabs = std::max(1, std::min(slabAxisSize, omp_get_max_threads()*4));
+#else
+    const int nrOfSlabs = 1;
+#endif
+    std::vector<int> slabStart(nrOfSlabs + 1);
+    for(int slab = 0; slab <= nrOfSlabs; ++slab)
+        slabStart[slab] = (int)((int64_t)slab*slabAxisSize/nrOfSlabs);
+
+    // First pass: Union pixels with their previous neighbors within the same slab
+    std::vector<uint> parent(size);
+    #pragma omp parallel for
+    for(int slab = 0; slab < nrOfSlabs; ++slab) {
+        for(int z = is3D ? slabStart[slab] : 0; z < (is3D ? slabStart[slab + 1] : 1); ++z) {
+        for(int y = is3D ? 0 : slabStart[slab]; y < (is3D ? height : slabStart[slab + 1]); ++y) {
         for(int x = 0; x < width; ++x) {
-            uchar currentLabel = pixels[x + y*width];
-            if(currentLabel == 0 || visited.count(x+y*width) > 0)
+            const uint index = x + y*width + (std::size_t)z*width*height;
+            const uchar value = pixels[index];
+            if(value == 0) {
+                parent[index] = background;
                 continue;
-
-            // Start flood fill
-
-            // Create region
-            Region region;
-            region.label = currentLabel;
-            region.area = 0;
-            region.centroid = Vector2f::Zero();
-
-            queue.push(Vector2i(x,y));
-            visited.insert(x + y*width);
-            while(!queue.empty()) {
-                Vector2i current = queue.front();
-                queue.pop();
-
-                region.centroid += current.cast<float>();
-                region.pixels.push_back(current);
-
-                ++region.area;
-
-                // Check neighbors
-                for(int a = -1; a <= 1; ++a) {
-                    for(int b = -1; b <= 1; ++b) {
-                        Vector2i next = current + Vector2i(a,b);
-                        // Out of bounds check
-                        if(next.x() < 0 || next.y() < 0 || next.x() >= width || next.y() >= height)
-                            continue;
-                        uchar label = pixels[next.x() + next.y() * width];
-                        if(label == currentLabel && visited.count(next.x() + next.y() * width) == 0) {
-                            queue.push(next);
-                            visited.insert(next.x() + next.y()*width);
-                        }
-                    }
-                }
             }
+            parent[index] = index;
+            for(auto&& offset : previousNeighbors) {
+                const Vector3i neighbor = Vector3i(x, y, z) + offset;
+                if(neighbor.x() < 0 || neighbor.x() >= width || neighbor.y() < 0 || neighbor.y() >= height || neighbor.z() < 0)
+                    continue;
+                if((is3D ? neighbor.z() : neighbor.y()) < slabStart[slab])
+                    continue;
+                const uint neighborIndex = neighbor.x() + neighbor.y()*width + (std::size_t)neighbor.z()*width*height;
+                if(pixels[neighborIndex] == value)
+                    unite(parent, index, neighborIndex);
+            }
+        }}}
+    }
 
-            region.centroid /= region.area;
+    // Second pass: Union pixels at the start of each slab with their neighbors in the previous slab
+    for(int slab = 1; slab < nrOfSlabs; ++slab) {
+        const int start = slabStart[slab];
+        for(int z = is3D ? start : 0; z < (is3D ? start + 1 : depth); ++z) {
+        for(int y = is3D ? 0 : start; y < (is3D ? height : start + 1); ++y) {
+        for(int x = 0; x < width; ++x) {
+            const uint index = x + y*width + (std::size_t)z*width*height;
+            const uchar value = pixels[index];
+            if(value == 0)
+                continue;
+            for(auto&& offset : previousNeighbors) {
+                const Vector3i neighbor = Vector3i(x, y, z) + offset;
+                if(neighbor.x() < 0 || neighbor.x() >= width || neighbor.y() < 0 || neighbor.y() >= height)
+                    continue;
+                if((is3D ? neighbor.z() : neighbor.y()) != start - 1)
+                    continue;
+                const uint neighborIndex = neighbor.x() + neighbor.y()*width + (std::size_t)neighbor.z()*width*height;
+                if(pixels[neighborIndex] == value)
+                    unite(parent, index, neighborIndex);
+            }
+        }}}
+    }
 
-            regions.push_back(region);
+    // Third pass: Replace parents with region ids. Parents always come first in scan order,
+    // thus they are already replaced with their region id when a pixel is reached.
+    uint nrOfRegions = 0;
+    std::vector<uchar> regionLabels;
+    for(std::size_t i = 0; i < size; ++i) {
+        if(parent[i] == background) {
+            parent[i] = 0;
+        } else if(parent[i] == i) {
+            parent[i] = ++nrOfRegions;
+            regionLabels.push_back(pixels[i]);
+        } else {
+            parent[i] = parent[parent[i]];
         }
     }
+    std::vector<uint>& labels = parent;
 
-    visited.clear();
-    std::vector<Vector2i> vertices;
-
-    // TODO do contour tracing for each region if enabled
-    // TODO handle holes
-    for(auto region : regions) {
-        // Start moore neigbhorhood tracing
-        int checkLocationNr = 1;  // The neighbor number of the location we want to check for a new border point
-        Vector2i checkPosition;      // The corresponding absolute array address of checkLocationNr
-        int newCheckLocationNr;   // Variable that holds the neighborhood position we want to check if we find a new border at checkLocationNr
-        Vector2i startPos = region.pixels[0];      // Set start position
-        int counter = 0;       // Counter is used for the jacobi stop criterion
-        int counter2 = 0;       // Counter2 is used to determine if the point we have discovered is one single point
-
-        // Defines the neighborhood offset position from current position and the neighborhood
-        // position we want to check next if we find a new border at checkLocationNr
-        Vector3i neighborhood[8] = {
-                {-1, 0, 7},
-                {-1, -1, 7},
-                {0, -1, 1},
-                {1, -1, 1},
-                {1, 0, 3},
-                {1, 1, 3},
-                {0, 1, 5},
-                {-1, 1, 5},
-        };
-        Vector2i pos = startPos;
-        // Trace around the neighborhood
-        while(true)
-        {
-            checkPosition = pos + neighborhood[checkLocationNr-1].head(2);
-            newCheckLocationNr = neighborhood[checkLocationNr-1].z();
-
-            if(pixels[checkPosition.x() + checkPosition.y()*width] == 2 && visited.count(checkPosition.x() + checkPosition.y()*width) == 0) // Next border point found
-            {
-                if(checkPosition == startPos) { // Should we stop?
-                    counter ++;
-
-                    // Stopping criterion (jacob)
-                    if(newCheckLocationNr == 1 || counter >= 3)
-                    {
-                        // Close loop
-                        //inside = true; // Since we are starting the search at were we first started we must set inside to true
-                        break;
-                    }
+    // Calculate statistics of each slab in parallel and combine them. The statistics of a slab are stored sparsely,
+    // since a slab usually only contains a few of the regions.
+    std::vector<std::vector<std::pair<uint, RegionStatistics>>> slabStatistics(nrOfSlabs);
+    #pragma omp parallel for
+    for(int slab = 0; slab < nrOfSlabs; ++slab) {
+        std::vector<std::pair<uint, RegionStatistics>>& statistics = slabStatistics[slab];
+        std::unordered_map<uint, std::size_t> localIndex;
+        uint previousId = 0;
+        std::size_t current = 0;
+        for(int z = is3D ? slabStart[slab] : 0; z < (is3D ? slabStart[slab + 1] : 1); ++z) {
+        for(int y = is3D ? 0 : slabStart[slab]; y < (is3D ? height : slabStart[slab + 1]); ++y) {
+        for(int x = 0; x < width; ++x) {
+            const std::size_t index = x + y*width + (std::size_t)z*width*height;
+            const uint id = labels[index];
+            if(id == 0)
+                continue;
+            // Neighbor pixels mostly belong to the same region, thus only look up the region when it changes
+            if(id != previousId) {
+                auto it = localIndex.find(id);
+                if(it == localIndex.end()) {
+                    current = statistics.size();
+                    localIndex[id] = current;
+                    statistics.push_back(std::make_pair(id, RegionStatistics()));
+                } else {
+                    current = it->second;
                 }
+                previousId = id;
+            }
+            RegionStatistics& region = statistics[current].second;
+            const Vector3i position(x, y, z);
+            ++region.area;
+            region.sum += position.cast<double>();
+            region.minimum = region.minimum.cwiseMin(position);
+            region.maximum = region.maximum.cwiseMax(position);
 
-                checkLocationNr = newCheckLocationNr; // Update which neighborhood position we should check next
-                pos = checkPosition;
-                counter2 = 0;             // Reset the counter that keeps track of how many neighbors we have visited
-                //borderImage[checkPosition] = BLACK; // Set the border pixel
-                visited.insert(pos.x() + pos.y()*width);
-                vertices.push_back(Vector2i(pos.x(), pos.y()));
-            } else {
-                // No match
-                // Rotate clockwise in the neighborhood
-                checkLocationNr = 1 + (checkLocationNr % 8);
-                if(counter2 > 8) {
-                    // If counter2 is above 8 we have traced around the neighborhood and
-                    // therefor the border is a single black pixel and we can exit
-                    counter2 = 0;
-                    break;
-                } else {
-                    counter2 ++;
+            // Count pixel edges/voxel faces which are on the border of the region
+            for(int axis = 0; axis < (is3D ? 3 : 2); ++axis) {
+                for(int direction : {-1, 1}) {
+                    Vector3i neighbor = position;
+                    neighbor[axis] += direction;
+                    if(neighbor[axis] < 0 || neighbor[axis] >= (axis == 0 ? width : (axis == 1 ? height : depth)) ||
+                            labels[neighbor.x() + neighbor.y()*width + (std::size_t)neighbor.z()*width*height] != id)
+                        ++region.perimeter;
                 }
             }
+        }}}
+    }
+
+    std::vector<RegionStatistics> totals(nrOfRegions);
+    for(auto&& statistics : slabStatistics) {
+        for(auto&& entry : statistics) {
+            RegionStatistics& total = totals[entry.first - 1];
+            total.area += entry.second.area;
+            total.sum += entry.second.sum;
+            total.minimum = total.minimum.cwiseMin(entry.second.minimum);
+            total.maximum = total.maximum.cwiseMax(entry.second.maximum);
+            total.perimeter += entry.second.perimeter;
         }
+    }
+    slabStatistics.clear();
+
+    std::vector<Region> regions(nrOfRegions);
+    #pragma omp parallel for
+    for(int i = 0; i < (int)nrOfRegions; ++i) {
+        const RegionStatistics& total = totals[i];
+        Region& region = regions[i];
+        region.area = total.area;
+        region.label = regionLabels[i];
+        region.id = i + 1;
+        region.centroid = (total.sum / total.area).cast<float>();
+        region.boundingBoxMinimum = total.minimum;
+        region.boundingBoxMaximum = total.maximum;
+        region.perimeter = total.perimeter;
+    }
+    totals.clear();
+
+    if(m_storePixels) {
+        for(int z = 0; z < depth; ++z) {
+        for(int y = 0; y < height; ++y) {
+        for(int x = 0; x < width; ++x) {
+            const uint id = labels[x + y*width + (std::size_t)z*width*height];
+            if(id > 0)
+                regions[id - 1].pixels.push_back(Vector3i(x, y, z));
+        }}}
+    }
 
-        // TODO Create mesh
-        //region.contour = Mesh::New();
-        //region.contour->create(vertices);
+    // Create label image
+    if(nrOfRegions > std::numeric_limits<ushort>::max())
+        reportWarning() << "More regions than fits in the label image, regions with id above 65535 are set to 0 in the label image" << reportEnd();
+    auto labelData = allocatePixelArray(size, TYPE_UINT16);
+    auto labelPixels = (ushort*)labelData.get();
+    #pragma omp parallel for
+    for(int64_t i = 0; i < (int64_t)size; ++i)
+        labelPixels[i] = labels[i] > std::numeric_limits<ushort>::max() ? 0 : (ushort)labels[i];
+    auto labelImage = Image::New();
+    if(is3D) {
+        labelImage->create(Vector3ui(width, height, depth), TYPE_UINT16, 1, std::move(labelData));
+    } else {
+        labelImage->create(Vector2ui(width, height), TYPE_UINT16, 1, std::move(labelData));
     }
+    labelImage->setSpacing(input->getSpacing());
+    SceneGraph::setParentNode(labelImage, input);
 
     auto regionList = RegionList::New();
     regionList->create(regions);
     addOutputData(0, regionList);
+    addOutputData(1, labelImage);
 }
 
 }
@@ -7,21 +7,45 @@ namespace fast {
 class Mesh;
 
 struct FAST_EXPORT Region {
+    // Nr of pixels/voxels
     int area;
     uchar label;
-    Vector2f centroid;
+    // Value of this region in the label image. Regions are numbered from 1 in scan order
+    uint id;
+    Vector3f centroid;
+    // Bounding box, both inclusive
+    Vector3i boundingBoxMinimum;
+    Vector3i boundingBoxMaximum;
+    // Nr of pixel edges (2D) or voxel faces (3D) on the border of the region
+    int perimeter;
     SharedPointer<Mesh> contour;
-    std::vector<Vector2i> pixels;
+    // Only stored if enabled with RegionProperties::setStorePixels
+    std::vector<Vector3i> pixels;
 };
 
 FAST_SIMPLE_DATA_OBJECT(RegionList, std::vector<Region>)
 
+/**
+ * Finds the connected regions of each label in a 2D or 3D TYPE_UINT8 segmentation, using 8/26 connectivity,
+ * and calculates their properties.
+ *
+ * Output port 0: RegionList
+ * Output port 1: Label image of TYPE_UINT16 where each region has the value Region::id
+ */
 class FAST_EXPORT RegionProperties : public ProcessObject {
     FAST_OBJECT(RegionProperties)
     public:
+        /**
+         * Store the position of every pixel in each region. Default is false.
+         *
+         * @param store
+         */
+        void setStorePixels(bool store);
     protected:
         RegionProperties();
         void execute() override;
+
+        bool m_storePixels = false;
 };
 
-}
\ No newline at end of file
+}
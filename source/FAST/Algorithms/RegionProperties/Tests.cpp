@@ -2,6 +2,7 @@
 #include <FAST/Testing.hpp>
 #include <FAST/Importers/ImageFileImporter.hpp>
 #include <FAST/Algorithms/BinaryThresholding/BinaryThresholding.hpp>
+#include <FAST/Data/Image.hpp>
 
 using namespace fast;
 
@@ -25,4 +26,87 @@ TEST_CASE("Region properties", "[regionproperties][fast]") {
         //std::cout << "Area: " << region.area << std::endl;
         //std::cout << "Label: " << (int)region.label << std::endl;
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Region properties of 2D regions", "[regionproperties][fast]") {
+    auto image = Image::New();
+    image->create(10, 8, TYPE_UINT8, 1);
+    image->fill(0);
+    {
+        auto access = image->getImageAccess(ACCESS_READ_WRITE);
+        // 3x2 rectangle of label 1
+        for(int y = 1; y < 3; ++y) {
+            for(int x = 1; x < 4; ++x)
+                access->setScalar(Vector2i(x, y), 1);
+        }
+        // Diagonal line of label 2, connected with 8 connectivity
+        for(int i = 0; i < 4; ++i)
+            access->setScalar(Vector2i(5 + i, 3 + i), 2);
+        // Single pixel of label 1
+        access->setScalar(Vector2i(0, 7), 1);
+    }
+
+    auto regionProperties = RegionProperties::New();
+    regionProperties->setInputData(image);
+    regionProperties->setStorePixels(true);
+    auto labelPort = regionProperties->getOutputPort(1);
+    auto regions = regionProperties->updateAndGetOutputData<RegionList>()->getAccess(ACCESS_READ)->getData();
+    auto labelImage = labelPort->getNextFrame<Image>();
+
+    REQUIRE(regions.size() == 3);
+    CHECK(regions[0].label == 1);
+    CHECK(regions[0].area == 6);
+    CHECK(regions[0].centroid.x() == Approx(2.0f));
+    CHECK(regions[0].centroid.y() == Approx(1.5f));
+    CHECK(regions[0].boundingBoxMinimum == Vector3i(1, 1, 0));
+    CHECK(regions[0].boundingBoxMaximum == Vector3i(3, 2, 0));
+    CHECK(regions[0].perimeter == 10);
+    CHECK(regions[0].pixels.size() == 6);
+    CHECK(regions[1].label == 2);
+    CHECK(regions[1].area == 4);
+    CHECK(regions[1].perimeter == 16);
+    CHECK(regions[2].label == 1);
+    CHECK(regions[2].area == 1);
+
+    CHECK(labelImage->getDataType() == TYPE_UINT16);
+    auto access = labelImage->getImageAccess(ACCESS_READ);
+    CHECK(access->getScalar(Vector2i(0, 0)) == 0);
+    CHECK(access->getScalar(Vector2i(2, 2)) == regions[0].id);
+    CHECK(access->getScalar(Vector2i(8, 6)) == regions[1].id);
+    CHECK(access->getScalar(Vector2i(0, 7)) == regions[2].id);
+}
+
+TEST_CASE("Region properties of 3D regions", "[regionproperties][fast]") {
+    auto image = Image::New();
+    image->create(64, 64, 64, TYPE_UINT8, 1);
+    image->fill(0);
+    {
+        auto access = image->getImageAccess(ACCESS_READ_WRITE);
+        // Two cubes which touch in a corner, and are thus one region with 26 connectivity
+        for(int z = 0; z < 4; ++z) {
+        for(int y = 0; y < 4; ++y) {
+        for(int x = 0; x < 4; ++x) {
+            access->setScalar(Vector3i(10 + x, 10 + y, 10 + z), 1);
+            access->setScalar(Vector3i(14 + x, 14 + y, 14 + z), 1);
+        }}}
+        // Column through all slices
+        for(int z = 0; z < 64; ++z)
+            access->setScalar(Vector3i(40, 40, z), 3);
+    }
+
+    auto regionProperties = RegionProperties::New();
+    regionProperties->setInputData(image);
+    auto regions = regionProperties->updateAndGetOutputData<RegionList>()->getAccess(ACCESS_READ)->getData();
+
+    REQUIRE(regions.size() == 2);
+    // Regions are ordered by their first voxel, thus the column comes first
+    CHECK(regions[0].label == 3);
+    CHECK(regions[0].area == 64);
+    CHECK(regions[0].perimeter == 64*4 + 2);
+    CHECK(regions[1].label == 1);
+    CHECK(regions[1].area == 128);
+    CHECK(regions[1].centroid.x() == Approx(13.5f));
+    CHECK(regions[1].perimeter == 2*6*16);
+    CHECK(regions[1].boundingBoxMinimum == Vector3i(10, 10, 10));
+    CHECK(regions[1].boundingBoxMaximum == Vector3i(17, 17, 17));
+    CHECK(regions[1].pixels.empty());
+}
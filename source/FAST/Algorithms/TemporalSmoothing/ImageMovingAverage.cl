@@ -1,66 +1,74 @@
-__constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP | CLK_FILTER_NEAREST;
+// TYPE is the data type of the input, OUTPUT_TYPE the data type of the output.
+// All images are accessed as buffers, thus any number of dimensions and channels is supported.
 
-float getPixelAsFloat(__read_only image2d_t image, int2 pos) {
-    float value;
-    int dataType = get_image_channel_data_type(image);
-    if(dataType == CLK_FLOAT) {
-        value = read_imagef(image, sampler, pos).x;
-    } else if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
-        value = read_imageui(image, sampler, pos).x;
-    } else {
-        value = read_imagei(image, sampler, pos).x;
-    }
-    return value;
+void writeOutput(__global OUTPUT_TYPE* output, ulong i, float value) {
+#ifdef INTEGER_OUTPUT
+    // output image is of integer type, have to apply rounding
+    output[i] = (OUTPUT_TYPE)round(value);
+#else
+    output[i] = (OUTPUT_TYPE)value;
+#endif
 }
 
 __kernel void MAinitialize(
-        __read_only image2d_t input,
-        __write_only image2d_t output,
-        __write_only image2d_t memoryOut,
-        __private int frameCount
+        __global const TYPE* input,
+        __global TYPE* history,
+        __global float* memory,
+        __global OUTPUT_TYPE* output,
+        __private int frameCount,
+        __private ulong nrOfElements
     ) {
-    const int2 pos = {get_global_id(0), get_global_id(1)};
+    const ulong i = get_global_id(0);
 
-    float value = getPixelAsFloat(input, pos);
-    write_imagef(memoryOut, pos, value);
-    int dataType = get_image_channel_data_type(output);
-    if(dataType == CLK_FLOAT) {
-        write_imagef(output, pos, value);
-    } else {
-        // output image is of integer type, have to apply rounding
-        if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
-            write_imageui(output, pos, (uint)value);
-        } else {
-            write_imagei(output, pos, (int)value);
-        }
-    }
+    const TYPE value = input[i];
+    // Fill history with duplicates of the first frame
+    for(int slot = 0; slot < frameCount; ++slot)
+        history[(ulong)slot*nrOfElements + i] = value;
+    memory[i] = (float)value*frameCount;
+    writeOutput(output, i, value);
 }
 
 __kernel void MAiteration(
-        __read_only image2d_t input,
-        __read_only image2d_t memoryIn,
-        __read_only image2d_t last,
-        __write_only image2d_t output,
-        __write_only image2d_t memoryOut,
-        __private int frameCount
+        __global const TYPE* input,
+        __global TYPE* history,
+        __global float* memory,
+        __global OUTPUT_TYPE* output,
+        __private int frameCount,
+        __private ulong nrOfElements,
+        __private int slot
     ) {
-    const int2 pos = {get_global_id(0), get_global_id(1)};
+    const ulong i = get_global_id(0);
 
-    float newValue = getPixelAsFloat(input, pos);
-    float oldMemory = read_imagef(memoryIn, sampler, pos).x;
-    float lastValue = getPixelAsFloat(last, pos);
-    float result = oldMemory + 1.0f/(float)frameCount * (newValue - lastValue);
-    write_imagef(memoryOut, pos, result);
+    // Replace the oldest frame in the ring buffer, and update the running sum in place
+    const TYPE newValue = input[i];
+    const ulong historyIndex = (ulong)slot*nrOfElements + i;
+    const float sum = memory[i] + (float)newValue - (float)history[historyIndex];
+    history[historyIndex] = newValue;
+    memory[i] = sum;
+    writeOutput(output, i, sum / (float)frameCount);
+}
+
+__kernel void EMAinitialize(
+        __global const TYPE* input,
+        __global float* memory,
+        __global OUTPUT_TYPE* output
+    ) {
+    const ulong i = get_global_id(0);
+
+    const float value = input[i];
+    memory[i] = value;
+    writeOutput(output, i, value);
+}
+
+__kernel void EMAiteration(
+        __global const TYPE* input,
+        __global float* memory,
+        __global OUTPUT_TYPE* output,
+        __private float alpha
+    ) {
+    const ulong i = get_global_id(0);
 
-    int dataType = get_image_channel_data_type(output);
-    if(dataType == CLK_FLOAT) {
-        write_imagef(output, pos, result);
-    } else {
-        // output image is of integer type, have to apply rounding
-        if(dataType == CLK_UNSIGNED_INT8 || dataType == CLK_UNSIGNED_INT16) {
-            write_imageui(output, pos, (uint)round(result));
-        } else {
-            write_imagei(output, pos, (int)round(result));
-        }
-    }
+    const float average = memory[i] + alpha*((float)input[i] - memory[i]);
+    memory[i] = average;
+    writeOutput(output, i, average);
 }
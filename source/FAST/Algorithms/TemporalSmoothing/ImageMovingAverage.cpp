@@ -13,11 +13,14 @@ ImageMovingAverage::ImageMovingAverage() {
     m_keepDataType = false;
     createIntegerAttribute("frame-count", "Frame count", "Nr of frames to use in moving average", m_frameCount);
     createBooleanAttribute("keep-datatype", "Keep data type", "Whether to keep data type of input image for output image, or use float instead", m_keepDataType);
+    createBooleanAttribute("exponential", "Exponential", "Use exponential moving average with weight 2/(frame count + 1)", m_exponential);
 }
 
 void ImageMovingAverage::reset() {
-    m_buffer.clear();
-    m_memory.reset();
+    m_initialized = false;
+    m_history = cl::Buffer();
+    m_memory = cl::Buffer();
+    m_oldestSlot = 0;
 }
 
 void ImageMovingAverage::setFrameCount(int frameCount) {
@@ -31,96 +34,94 @@ void ImageMovingAverage::setKeepDataType(bool keep) {
     m_keepDataType = keep;
 }
 
+void ImageMovingAverage::setExponential(bool exponential) {
+    m_exponential = exponential;
+    reset();
+}
+
 void ImageMovingAverage::loadAttributes() {
     setFrameCount(getIntegerAttribute("frame-count"));
     setKeepDataType(getBooleanAttribute("keep-datatype"));
+    setExponential(getBooleanAttribute("exponential"));
 }
 
 void ImageMovingAverage::execute() {
     auto input = getInputData<Image>(0);
     auto output = getOutputData<Image>(0);
 
-    auto device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
-    auto program = getOpenCLProgram(device);
-
-    if(m_keepDataType) {
-        output->create(input->getSize(), input->getDataType(), 1);
-    } else {
-        output->create(input->getSize(), TYPE_FLOAT, 1);
-    }
+    const DataType outputType = m_keepDataType ? input->getDataType() : TYPE_FLOAT;
+    output->create(input->getSize(), outputType, input->getNrOfChannels());
     SceneGraph::setParentNode(output, input);
     output->setSpacing(input->getSpacing());
 
-    if(m_buffer.empty()) {
-        // Fill buffer with duplicates
-        if(!m_memory) {
-            m_memory = Image::New();
-            m_memory->create(input->getSize(), TYPE_FLOAT, 1);
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(getMainDevice());
+    std::string buildOptions = "-DTYPE=" + getCTypeAsString(input->getDataType()) +
+            " -DOUTPUT_TYPE=" + getCTypeAsString(outputType);
+    if(outputType != TYPE_FLOAT)
+        buildOptions += " -DINTEGER_OUTPUT";
+    auto program = getOpenCLProgram(device, "", buildOptions);
+
+    const std::size_t nrOfElements = input->getNrOfVoxels()*input->getNrOfChannels();
+    auto inputAccess = input->getOpenCLBufferAccess(ACCESS_READ, device);
+    auto outputAccess = output->getOpenCLBufferAccess(ACCESS_READ_WRITE, device);
+    auto queue = device->getCommandQueue();
+
+    cl::Kernel kernel;
+    if(!m_initialized) {
+        // Allocate the state once, it is reused for all following frames
+        m_size = input->getSize();
+        m_nrOfChannels = input->getNrOfChannels();
+        m_dataType = input->getDataType();
+        m_memory = cl::Buffer(device->getContext(), CL_MEM_READ_WRITE, nrOfElements*sizeof(float));
+        if(m_exponential) {
+            kernel = cl::Kernel(program, "EMAinitialize");
+            kernel.setArg(0, *inputAccess->get());
+            kernel.setArg(1, m_memory);
+            kernel.setArg(2, *outputAccess->get());
+        } else {
+            m_history = cl::Buffer(device->getContext(), CL_MEM_READ_WRITE,
+                    (std::size_t)m_frameCount*nrOfElements*getSizeOfDataType(m_dataType, 1));
+            kernel = cl::Kernel(program, "MAinitialize");
+            kernel.setArg(0, *inputAccess->get());
+            kernel.setArg(1, m_history);
+            kernel.setArg(2, m_memory);
+            kernel.setArg(3, *outputAccess->get());
+            kernel.setArg(4, m_frameCount);
+            kernel.setArg(5, (cl_ulong)nrOfElements);
+            m_oldestSlot = 0;
+        }
+        m_initialized = true;
+    } else {
+        if(input->getSize() != m_size || input->getNrOfChannels() != m_nrOfChannels)
+            throw Exception("Image input to ImageMovingAverage suddenly changed size.");
+        if(input->getDataType() != m_dataType)
+            throw Exception("Image input to ImageMovingAverage suddenly changed data type.");
+
+        if(m_exponential) {
+            kernel = cl::Kernel(program, "EMAiteration");
+            kernel.setArg(0, *inputAccess->get());
+            kernel.setArg(1, m_memory);
+            kernel.setArg(2, *outputAccess->get());
+            kernel.setArg(3, 2.0f/(m_frameCount + 1.0f));
+        } else {
+            kernel = cl::Kernel(program, "MAiteration");
+            kernel.setArg(0, *inputAccess->get());
+            kernel.setArg(1, m_history);
+            kernel.setArg(2, m_memory);
+            kernel.setArg(3, *outputAccess->get());
+            kernel.setArg(4, m_frameCount);
+            kernel.setArg(5, (cl_ulong)nrOfElements);
+            kernel.setArg(6, m_oldestSlot);
+            m_oldestSlot = (m_oldestSlot + 1) % m_frameCount;
         }
-
-        auto inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-        auto outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-        auto memoryOutAccess = m_memory->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-
-        cl::Kernel kernel(program, "MAinitialize");
-        kernel.setArg(0, *inputAccess->get2DImage());
-        kernel.setArg(1, *outputAccess->get2DImage());
-        kernel.setArg(2, *memoryOutAccess->get2DImage());
-        kernel.setArg(3, (int)m_frameCount);
-
-        device->getCommandQueue().enqueueNDRangeKernel(
-            kernel,
-            cl::NullRange,
-            cl::NDRange(input->getWidth(), input->getHeight()),
-            cl::NullRange
-        );
-
-        while(m_buffer.size() < m_frameCount)
-            m_buffer.push_back(input);
-
-        return;
     }
 
-    m_buffer.push_back(input);
-
-    if(input->getDimensions() != 2)
-        throw Exception("ImageMovingAverage only supports 2D atm");
-    if (input->getNrOfChannels() > 1)
-        reportWarning() << "ImageMovingAverage only supports single channel images" << reportEnd();
-
-    if(input->getSize() != m_memory->getSize())
-        throw Exception("Image input to ImageMovingAverage suddenly changed size.");
-
-    auto memoryOut = Image::New();
-    memoryOut->createFromImage(m_memory);
-
-    auto last = m_buffer.front();
-
-    auto inputAccess = input->getOpenCLImageAccess(ACCESS_READ, device);
-    auto lastAccess = last->getOpenCLImageAccess(ACCESS_READ, device);
-    auto outputAccess = output->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-    auto memoryAccess = m_memory->getOpenCLImageAccess(ACCESS_READ, device);
-    auto memoryOutAccess = memoryOut->getOpenCLImageAccess(ACCESS_READ_WRITE, device);
-
-    cl::Kernel kernel(program, "MAiteration");
-    kernel.setArg(0, *inputAccess->get2DImage());
-    kernel.setArg(1, *memoryAccess->get2DImage());
-    kernel.setArg(2, *lastAccess->get2DImage());
-    kernel.setArg(3, *outputAccess->get2DImage());
-    kernel.setArg(4, *memoryOutAccess->get2DImage());
-    kernel.setArg(5, (int)m_frameCount);
-
-    device->getCommandQueue().enqueueNDRangeKernel(
-            kernel,
-            cl::NullRange,
-            cl::NDRange(input->getWidth(), input->getHeight()),
-            cl::NullRange
+    queue.enqueueNDRangeKernel(
+        kernel,
+        cl::NullRange,
+        cl::NDRange(nrOfElements),
+        cl::NullRange
     );
-
-    if(m_buffer.size() > m_frameCount)
-        m_buffer.pop_front();
-
-    m_memory = memoryOut;
 }
 
 }
@@ -1,17 +1,30 @@
 #pragma once
 
 #include <FAST/ProcessObject.hpp>
-#include <deque>
 
 namespace fast {
 
 class Image;
 
+/**
+ * Temporal smoothing of a stream of 2D or 3D images with any number of channels.
+ *
+ * By default the average of the last N frames is calculated, by keeping the last N frames in a ring buffer
+ * on the device and updating a running sum. In exponential mode, only the current average is kept, and it is
+ * updated with weight 2/(N+1) for each new frame.
+ */
 class FAST_EXPORT ImageMovingAverage : public ProcessObject {
     FAST_OBJECT(ImageMovingAverage)
     public:
         void setFrameCount(int frameCount);
         void setKeepDataType(bool keep);
+        /**
+         * Use an exponential moving average instead of the average of the last N frames.
+         * This only needs to store one image, independent of the frame count.
+         *
+         * @param exponential
+         */
+        void setExponential(bool exponential);
         void reset();
     protected:
         ImageMovingAverage();
@@ -20,8 +33,18 @@ class FAST_EXPORT ImageMovingAverage : public ProcessObject {
 
         int m_frameCount;
         bool m_keepDataType;
-        SharedPointer<Image> m_memory;
-        std::deque<SharedPointer<Image>> m_buffer;
+        bool m_exponential = false;
+
+        bool m_initialized = false;
+        Vector3ui m_size;
+        uint m_nrOfChannels;
+        DataType m_dataType;
+        // Ring buffer with the last frames, of the input data type
+        cl::Buffer m_history;
+        // Slot in the ring buffer with the oldest frame
+        int m_oldestSlot = 0;
+        // Running sum, or the average in exponential mode
+        cl::Buffer m_memory;
 };
 
-}
\ No newline at end of file
+}
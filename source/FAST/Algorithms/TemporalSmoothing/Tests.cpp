@@ -4,6 +4,7 @@
 #include <FAST/Visualization/ImageRenderer/ImageRenderer.hpp>
 #include <FAST/Algorithms/BinaryThresholding/BinaryThresholding.hpp>
 #include "ImageWeightedMovingAverage.hpp"
+#include "ImageMovingAverage.hpp"
 
 using namespace fast;
 
@@ -30,4 +31,39 @@ TEST_CASE("Image weighted moving average 2D", "[fast][ImageWeightedMovingAverage
    window->set2DMode();
    window->setTimeout(3000);
    window->start();
-}
\ No newline at end of file
+}
+
+TEST_CASE("Image moving average of 3D multi-channel images", "[fast][ImageMovingAverage]") {
+    auto average = ImageMovingAverage::New();
+    average->setFrameCount(3);
+    std::vector<float> expected = {0.0f, 1.0f/3.0f, 1.0f, 2.0f, 3.0f};
+    for(int frame = 0; frame < (int)expected.size(); ++frame) {
+        auto image = Image::New();
+        image->create(32, 16, 8, TYPE_UINT8, 2);
+        image->fill(frame);
+        average->setInputData(image);
+        auto result = average->updateAndGetOutputData<Image>();
+        CHECK(result->getDataType() == TYPE_FLOAT);
+        CHECK(result->getNrOfChannels() == 2);
+        CHECK(result->getDepth() == 8);
+        CHECK(result->calculateMinimumIntensity() == Approx(expected[frame]));
+        CHECK(result->calculateMaximumIntensity() == Approx(expected[frame]));
+    }
+}
+
+TEST_CASE("Image exponential moving average", "[fast][ImageMovingAverage]") {
+    auto average = ImageMovingAverage::New();
+    average->setFrameCount(3); // Weight is 2/(3+1)
+    average->setExponential(true);
+    average->setKeepDataType(true);
+    std::vector<float> expected = {0.0f, 4.0f, 10.0f, 17.0f};
+    for(int frame = 0; frame < (int)expected.size(); ++frame) {
+        auto image = Image::New();
+        image->create(64, 64, TYPE_INT16, 1);
+        image->fill(frame*8);
+        average->setInputData(image);
+        auto result = average->updateAndGetOutputData<Image>();
+        CHECK(result->getDataType() == TYPE_INT16);
+        CHECK(result->calculateMaximumIntensity() == Approx(expected[frame]));
+    }
+}
@@ -27,6 +27,7 @@ namespace fast {
 			std::string mLibraryPath;
 			std::string mQtPluginsPath;
 			StreamingMode m_streamingMode = STREAMING_MODE_PROCESS_ALL_FRAMES;
+			bool m_visualization = true;
 		}
 
 		std::string getPath() {
@@ -270,6 +271,14 @@ namespace fast {
 		    return m_streamingMode;
 		}
 
+		void setVisualization(bool visualization) {
+		    m_visualization = visualization;
+		}
+
+		bool getVisualization() {
+		    return m_visualization;
+		}
+
 	} // end namespace Config
 
 }; // end namespace fast
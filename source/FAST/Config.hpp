@@ -16,6 +16,13 @@ namespace Config {
     FAST_EXPORT std::string getQtPluginsPath();
     FAST_EXPORT StreamingMode getStreamingMode();
     FAST_EXPORT void setStreamingMode(StreamingMode mode);
+    /**
+     * Disable visualization to run pipelines on computers without a display.
+     * Qt and OpenGL are then not initialized when devices are created, thus this must be set before
+     * any process objects are created.
+     */
+    FAST_EXPORT void setVisualization(bool visualization);
+    FAST_EXPORT bool getVisualization();
 	FAST_EXPORT void setTestDataPath(std::string path);
 	FAST_EXPORT void setKernelSourcePath(std::string path);
 	FAST_EXPORT void setKernelBinaryPath(std::string path);
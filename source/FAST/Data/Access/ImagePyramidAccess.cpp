@@ -104,10 +104,11 @@ std::unique_ptr<uchar[]> ImagePyramidAccess::getPatchData(int level, int x, int
     const int levelWidth = m_image->getLevelWidth(level);
     const int levelHeight = m_image->getLevelHeight(level);
     const int channels = m_image->getNrOfChannels();
-    auto data = make_uninitialized_unique<uchar[]>(width*height*channels);
+    auto data = make_uninitialized_unique<uchar[]>((std::size_t)width*height*channels);
     if(m_fileHandle != nullptr) {
-		float scale = (float)m_image->getFullWidth()/levelWidth;
-        openslide_read_region(m_fileHandle, (uint32_t*)data.get(), x * scale, y * scale, level, width, height);
+        // Read through the patch cache of the image pyramid, the cached data is shared and must be copied
+        auto patch = m_image->readPatch(level, x, y, width, height);
+        std::memcpy(data.get(), patch.get(), (std::size_t)width*height*channels);
     } else {
         auto levelData = m_levels[level];
         for(int cy = y; cy < std::min(y + height, levelHeight); ++cy) {
@@ -104,6 +104,10 @@ std::string DataObject::getFrameData(std::string name) {
     return m_frameData[name];
 }
 
+bool DataObject::hasFrameData(std::string name) {
+    return m_frameData.count(name) > 0;
+}
+
 std::unordered_map<std::string, std::string> DataObject::getFrameData() {
     return m_frameData;
 }
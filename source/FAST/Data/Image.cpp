@@ -1,5 +1,6 @@
 #include "Image.hpp"
 #include "FAST/Data/Access/ImageAccess.hpp"
+#include "FAST/Data/ImageBufferPool.hpp"
 #include "FAST/Utility.hpp"
 #include "FAST/Exception.hpp"
 #include "FAST/Utility.hpp"
@@ -10,19 +11,18 @@
 namespace fast {
 
 unique_pixel_ptr allocatePixelArray(std::size_t size, DataType type) {
-    unique_pixel_ptr ptr;
-    switch(type) {
-        fastSwitchTypeMacro(ptr = make_unique_pixel<FAST_TYPE>(new FAST_TYPE[size]))
-    }
-
-    return ptr;
+    // Draw array from the pool, and return it to the pool when the pointer is deleted
+    auto pool = ImageBufferPool::getInstance();
+    return unique_pixel_ptr(pool->allocateHost(size, type), [pool, size, type](void* data) {
+        pool->releaseHost(data, size, type);
+    });
 }
 
 // Pad data with 1, 2 or 3 channels to 4 channels with 0
 template <class T>
-void * padData(T * data, unsigned int size, unsigned int nrOfChannels) {
+void * padData(T * data, std::size_t size, unsigned int nrOfChannels) {
     T * newData = new T[size*4]();
-    for(unsigned int i = 0; i < size; i++) {
+    for(std::size_t i = 0; i < size; i++) {
     	if(nrOfChannels == 1) {
             newData[i*4] = data[i];
     	} else if(nrOfChannels == 2) {
@@ -37,7 +37,7 @@ void * padData(T * data, unsigned int size, unsigned int nrOfChannels) {
     return (void *)newData;
 }
 
-const void * const adaptDataToImage(const void* const data, cl_channel_order order, unsigned int size, DataType type, unsigned int nrOfChannels) {
+const void * const adaptDataToImage(const void* const data, cl_channel_order order, std::size_t size, DataType type, unsigned int nrOfChannels) {
     // Because no OpenCL images support 3 channels,
     // the data has to be padded to 4 channels if the nr of channels is 3
     // Also, not all CL platforms support CL_R and CL_RG images
@@ -52,9 +52,9 @@ const void * const adaptDataToImage(const void* const data, cl_channel_order ord
 
 // Remove padding from a data array created by padData
 template <class T>
-void * removePadding(T * data, unsigned int size, unsigned int nrOfChannels) {
+void * removePadding(T * data, std::size_t size, unsigned int nrOfChannels) {
      T * newData = new T[size*nrOfChannels];
-    for(unsigned int i = 0; i < size; i++) {
+    for(std::size_t i = 0; i < size; i++) {
     	if(nrOfChannels == 1) {
             newData[i] = data[i*4];
     	} else if(nrOfChannels == 2) {
@@ -69,7 +69,7 @@ void * removePadding(T * data, unsigned int size, unsigned int nrOfChannels) {
     return (void *)newData;
 }
 
-unique_pixel_ptr adaptImageDataToHostData(unique_pixel_ptr data, cl_channel_order order, unsigned int size, DataType type, unsigned int nrOfChannels) {
+unique_pixel_ptr adaptImageDataToHostData(unique_pixel_ptr data, cl_channel_order order, std::size_t size, DataType type, unsigned int nrOfChannels) {
     // Because no OpenCL images support 3 channels,
     // the data has to be padded to 4 channels if the nr of channels is 3.
     // Also, not all CL platforms support CL_R and CL_RG images
@@ -91,7 +91,7 @@ void Image::transferCLImageFromHost(OpenCLDevice::pointer device) {
 	// And if the device does not support 1 or 2 channels
     cl::ImageFormat format = getOpenCLImageFormat(device, mDimensions == 2 ? CL_MEM_OBJECT_IMAGE2D : CL_MEM_OBJECT_IMAGE3D, mType, mChannels);
     if(format.image_channel_order == CL_RGBA && mChannels != 4) {
-        auto tempData = adaptDataToImage(mHostData.get(), CL_RGBA, mWidth*mHeight*mDepth, mType, mChannels);
+        auto tempData = adaptDataToImage(mHostData.get(), CL_RGBA, (std::size_t)mWidth*mHeight*mDepth, mType, mChannels);
         device->getCommandQueue().enqueueWriteImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
                 0, (void*)tempData);
@@ -108,15 +108,15 @@ void Image::transferCLImageToHost(OpenCLDevice::pointer device) {
 	// And if the device does not support 1 or 2 channels
     cl::ImageFormat format = getOpenCLImageFormat(device, mDimensions == 2 ? CL_MEM_OBJECT_IMAGE2D : CL_MEM_OBJECT_IMAGE3D, mType, mChannels);
     if(format.image_channel_order == CL_RGBA && mChannels != 4) {
-        auto tempData = allocatePixelArray(mWidth*mHeight*mDepth*4, mType);
+        auto tempData = allocatePixelArray((std::size_t)mWidth*mHeight*mDepth*4, mType);
         device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
         CL_TRUE, createOrigoRegion(), createRegion(mWidth, mHeight, mDepth), 0,
                 0, tempData.get());
-        mHostData = adaptImageDataToHostData(std::move(tempData), CL_RGBA, mWidth*mHeight*mDepth,mType,mChannels);
+        mHostData = adaptImageDataToHostData(std::move(tempData), CL_RGBA, (std::size_t)mWidth*mHeight*mDepth,mType,mChannels);
     } else {
         if(!mHostHasData) {
             // Must allocate memory for host data
-            mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels,mType);
+            mHostData = allocatePixelArray((std::size_t)mWidth*mHeight*mDepth*mChannels,mType);
 			mHostHasData = true;
         }
         device->getCommandQueue().enqueueReadImage(*(cl::Image*)mCLImages[device],
@@ -141,11 +141,11 @@ void Image::updateOpenCLImageData(OpenCLDevice::pointer device) {
         // Data is not on device, create it
         cl::Image * newImage;
         if(mDimensions == 2) {
-            newImage = new cl::Image2D(device->getContext(),
-            CL_MEM_READ_WRITE, getOpenCLImageFormat(device, CL_MEM_OBJECT_IMAGE2D, mType,mChannels), mWidth, mHeight);
+            newImage = ImageBufferPool::getInstance()->allocateOpenCLImage(device,
+                getOpenCLImageFormat(device, CL_MEM_OBJECT_IMAGE2D, mType,mChannels), mWidth, mHeight);
         } else {
-            newImage = new cl::Image3D(device->getContext(),
-            CL_MEM_READ_WRITE, getOpenCLImageFormat(device, CL_MEM_OBJECT_IMAGE3D, mType,mChannels), mWidth, mHeight, mDepth);
+            newImage = ImageBufferPool::getInstance()->allocateOpenCLImage(device,
+                getOpenCLImageFormat(device, CL_MEM_OBJECT_IMAGE3D, mType,mChannels), mWidth, mHeight, mDepth);
         }
 
         if(hasAnyData()) {
@@ -227,8 +227,8 @@ OpenCLBufferAccess::pointer Image::getOpenCLBufferAccess(
 	return std::move(accessObject);
 }
 
-unsigned int Image::getBufferSize() const {
-    unsigned int bufferSize = mWidth*mHeight;
+std::size_t Image::getBufferSize() const {
+    std::size_t bufferSize = (std::size_t)mWidth*mHeight;
     if(mDimensions == 3) {
         bufferSize *= mDepth;
     }
@@ -247,9 +247,8 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
     bool updated = false;
     if (mCLBuffers.count(device) == 0) {
         // Data is not on device, create it
-        unsigned int bufferSize = getBufferSize();
-        cl::Buffer * newBuffer = new cl::Buffer(device->getContext(),
-        CL_MEM_READ_WRITE, bufferSize);
+        std::size_t bufferSize = getBufferSize();
+        cl::Buffer * newBuffer = ImageBufferPool::getInstance()->allocateOpenCLBuffer(device, bufferSize);
 
         if(hasAnyData()) {
             mCLBuffersIsUpToDate[device] = false;
@@ -302,7 +301,7 @@ void Image::updateOpenCLBufferData(OpenCLDevice::pointer device) {
 }
 
 void Image::transferCLBufferFromHost(OpenCLDevice::pointer device) {
-    unsigned int bufferSize = getBufferSize();
+    std::size_t bufferSize = getBufferSize();
     device->getCommandQueue().enqueueWriteBuffer(*mCLBuffers[device],
         CL_TRUE, 0, bufferSize, mHostData.get());
 }
@@ -310,10 +309,10 @@ void Image::transferCLBufferFromHost(OpenCLDevice::pointer device) {
 void Image::transferCLBufferToHost(OpenCLDevice::pointer device) {
 	if (!mHostHasData) {
 		// Must allocate memory for host data
-		mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels, mType);
+		mHostData = allocatePixelArray((std::size_t)mWidth*mHeight*mDepth*mChannels, mType);
 		mHostHasData = true;
 	}
-    unsigned int bufferSize = getBufferSize();
+    std::size_t bufferSize = getBufferSize();
     device->getCommandQueue().enqueueReadBuffer(*mCLBuffers[device],
         CL_TRUE, 0, bufferSize, mHostData.get());
 }
@@ -326,10 +325,7 @@ void Image::updateHostData() {
     bool updated = false;
     if (!mHostHasData) {
         // Data is not initialized, do that first
-        unsigned int size = mWidth*mHeight*mChannels;
-        if(mDimensions == 3)
-            size *= mDepth;
-        mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels,mType);
+        mHostData = allocatePixelArray((std::size_t)mWidth*mHeight*mDepth*mChannels,mType);
         if(hasAnyData()) {
             mHostDataIsUpToDate = false;
         } else {
@@ -590,7 +586,7 @@ void Image::copyData(ExecutionDevice::pointer device, const void* const data) {
         throw Exception("Image must be initialized");
     // We do not own this pointer, have to copy it
     if(device->isHost()) {
-        mHostData = allocatePixelArray(mWidth*mHeight*mDepth*mChannels, mType);
+        mHostData = allocatePixelArray((std::size_t)mWidth*mHeight*mDepth*mChannels, mType);
         std::memcpy(mHostData.get(), data, getSizeOfDataType(mType, mChannels) * mWidth * mHeight * mDepth);
         mHostHasData = true;
         mHostDataIsUpToDate = true;
@@ -603,26 +599,22 @@ void Image::copyData(ExecutionDevice::pointer device, const void* const data) {
         if(mDimensions == 2) {
             tempData = (void*)adaptDataToImage(data, getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE2D, mType,
                                                                          mChannels).image_channel_order,
-                                              mWidth * mHeight, mType, mChannels);
-            clImage = new cl::Image2D(
-                    clDevice->getContext(),
-                    CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                                              (std::size_t)mWidth*mHeight, mType, mChannels);
+            clImage = ImageBufferPool::getInstance()->allocateOpenCLImage(
+                    clDevice,
                     getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE2D, mType, mChannels),
-                    mWidth, mHeight,
-                    0,
-                    tempData
+                    mWidth, mHeight
             );
         } else {
-            tempData = (void*)adaptDataToImage(data, getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels).image_channel_order, mWidth*mHeight*mDepth, mType, mChannels);
-            clImage = new cl::Image3D(
-                clDevice->getContext(),
-                CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+            tempData = (void*)adaptDataToImage(data, getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels).image_channel_order, (std::size_t)mWidth*mHeight*mDepth, mType, mChannels);
+            clImage = ImageBufferPool::getInstance()->allocateOpenCLImage(
+                clDevice,
                 getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels),
-                mWidth, mHeight, mDepth,
-                0, 0,
-                tempData
+                mWidth, mHeight, mDepth
             );
         }
+        clDevice->getCommandQueue().enqueueWriteImage(*clImage, CL_TRUE, createOrigoRegion(),
+                createRegion(mWidth, mHeight, mDepth), 0, 0, tempData);
         mCLImages[clDevice] = clImage;
         mCLImagesIsUpToDate[clDevice] = true;
         if(tempData != data) // If a new copy was made, delete it
@@ -651,6 +643,21 @@ void Image::setData(ExecutionDevice::pointer device, void* data) {
     mIsInitialized = true;
 }
 
+void Image::create(VectorXui size, DataType type, uint nrOfChannels, unique_pixel_ptr ptr) {
+    if(size.size() == 3) {
+        create(size.x(), size.y(), size.z(), type, nrOfChannels);
+    } else if(size.size() == 2) {
+        create(size.x(), size.y(), type, nrOfChannels);
+    } else {
+        throw Exception("Incorrect size");
+    }
+
+    mHostData = std::move(ptr);
+    mHostHasData = true;
+    mHostDataIsUpToDate = true;
+    updateModifiedTimestamp();
+}
+
 bool Image::isInitialized() const {
     return mIsInitialized;
 }
@@ -662,30 +669,32 @@ void Image::free(ExecutionDevice::pointer device) {
         mHostHasData = false;
     } else {
         OpenCLDevice::pointer clDevice = std::static_pointer_cast<OpenCLDevice>(device);
-        // Delete any OpenCL images
-        delete mCLImages[clDevice];
+        // Return any OpenCL images to the pool
+        if(mCLImages.count(clDevice) > 0)
+            ImageBufferPool::getInstance()->releaseOpenCLImage(clDevice, mCLImages[clDevice]);
         mCLImages.erase(clDevice);
         mCLImagesIsUpToDate.erase(clDevice);
-        // Delete any OpenCL buffers
-        delete mCLBuffers[clDevice];
+        // Return any OpenCL buffers to the pool
+        if(mCLBuffers.count(clDevice) > 0)
+            ImageBufferPool::getInstance()->releaseOpenCLBuffer(clDevice, mCLBuffers[clDevice]);
         mCLBuffers.erase(clDevice);
         mCLBuffersIsUpToDate.erase(clDevice);
     }
 }
 
 void Image::freeAll() {
-    // Delete OpenCL Images
+    // Return OpenCL Images to the pool
     std::unordered_map<OpenCLDevice::pointer, cl::Image*>::iterator it;
     for (it = mCLImages.begin(); it != mCLImages.end(); it++) {
-        delete it->second;
+        ImageBufferPool::getInstance()->releaseOpenCLImage(it->first, it->second);
     }
     mCLImages.clear();
     mCLImagesIsUpToDate.clear();
 
-    // Delete OpenCL buffers
+    // Return OpenCL buffers to the pool
     std::unordered_map<OpenCLDevice::pointer, cl::Buffer*>::iterator it2;
     for (it2 = mCLBuffers.begin(); it2 != mCLBuffers.end(); it2++) {
-        delete it2->second;
+        ImageBufferPool::getInstance()->releaseOpenCLBuffer(it2->first, it2->second);
     }
     mCLBuffers.clear();
     mCLBuffersIsUpToDate.clear();
@@ -754,30 +763,11 @@ void Image::calculateMaxAndMinIntensity() {
     // Calculate max and min if image has changed or it is the first time
     if(!mMaxMinInitialized || mMaxMinTimestamp != getTimestamp()) {
 
-        unsigned int nrOfElements = mWidth*mHeight*mDepth*mChannels;
+        std::size_t nrOfElements = (std::size_t)mWidth*mHeight*mDepth*mChannels;
         if(mHostHasData && mHostDataIsUpToDate) {
             // Host data is up to date, calculate min and max on host
-            ImageAccess::pointer access = getImageAccess(ACCESS_READ);
-            void* data = access->get();
-            switch(mType) {
-            case TYPE_FLOAT:
-            case TYPE_SNORM_INT16:
-            case TYPE_UNORM_INT16:
-                getMaxAndMinFromData<float>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_INT8:
-                getMaxAndMinFromData<char>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_UINT8:
-                getMaxAndMinFromData<uchar>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_INT16:
-                getMaxAndMinFromData<short>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            case TYPE_UINT16:
-                getMaxAndMinFromData<ushort>(data,nrOfElements,&mMinimumIntensity,&mMaximumIntensity);
-                break;
-            }
+            calculateStatisticsOnHost();
+            return;
         } else {
             // TODO the logic here can be improved. For instance choose the best device
             // Find some OpenCL image data or buffer data that is up to date
@@ -832,29 +822,12 @@ float Image::calculateAverageIntensity() {
 
     // Calculate max and min if image has changed or it is the first time
     if(!mAverageInitialized || mAverageIntensityTimestamp != getTimestamp()) {
-        unsigned int nrOfElements = mWidth*mHeight*mDepth;
+        std::size_t nrOfElements = (std::size_t)mWidth*mHeight*mDepth;
         if(mHostHasData && mHostDataIsUpToDate) {
             reportInfo() << "calculating sum on host" << Reporter::end();
-            // Host data is up to date, calculate min and max on host
-            ImageAccess::pointer access = getImageAccess(ACCESS_READ);
-            void* data = access->get();
-            switch(mType) {
-            case TYPE_FLOAT:
-                mAverageIntensity = getSumFromData<float>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_INT8:
-                mAverageIntensity = getSumFromData<char>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_UINT8:
-                mAverageIntensity = getSumFromData<uchar>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_INT16:
-                mAverageIntensity = getSumFromData<short>(data,nrOfElements) / nrOfElements;
-                break;
-            case TYPE_UINT16:
-                mAverageIntensity = getSumFromData<ushort>(data,nrOfElements) / nrOfElements;
-                break;
-            }
+            // Host data is up to date, calculate average, min and max on host
+            calculateStatisticsOnHost();
+            return mAverageIntensity;
         } else {
             reportInfo() << "calculating sum with OpenCL" << Reporter::end();
             // TODO the logic here can be improved. For instance choose the best device
@@ -914,6 +887,33 @@ float Image::calculateAverageIntensity() {
     return mAverageIntensity;
 }
 
+void Image::calculateStatisticsOnHost(uint nrOfBins) {
+    ImageStatistics statistics;
+    {
+        ImageAccess::pointer access = getImageAccess(ACCESS_READ);
+        statistics = calculateImageStatistics(access->get(), (std::size_t)mWidth*mHeight*mDepth*mChannels, mType, nrOfBins);
+    }
+    mMinimumIntensity = statistics.minimum;
+    mMaximumIntensity = statistics.maximum;
+    mAverageIntensity = statistics.getAverage();
+    mHistogram = statistics.histogram;
+    mMaxMinTimestamp = getTimestamp();
+    mMaxMinInitialized = true;
+    mAverageIntensityTimestamp = getTimestamp();
+    mAverageInitialized = true;
+}
+
+std::vector<uint64_t> Image::calculateHistogram(uint nrOfBins) {
+    if(!isInitialized())
+        throw Exception("Image has not been initialized.");
+    if(nrOfBins == 0)
+        throw Exception("Number of bins in histogram must be larger than 0");
+    if(!mMaxMinInitialized || mMaxMinTimestamp != getTimestamp() || mHistogram.size() != nrOfBins)
+        calculateStatisticsOnHost(nrOfBins);
+
+    return mHistogram;
+}
+
 float Image::calculateMaximumIntensity() {
     if(!isInitialized())
         throw Exception("Image has not been initialized.");
@@ -1032,16 +1032,14 @@ void Image::fill(float value) {
     	cl::Image* clImage;
         OpenCLDevice::pointer clDevice = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
     	if(getDimensions() == 2) {
-			clImage = new cl::Image2D(
-				clDevice->getContext(),
-				CL_MEM_READ_WRITE,
+			clImage = ImageBufferPool::getInstance()->allocateOpenCLImage(
+				clDevice,
 				getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE2D, mType, mChannels),
 				mWidth, mHeight
 			);
     	} else {
-			clImage = new cl::Image3D(
-				clDevice->getContext(),
-				CL_MEM_READ_WRITE,
+			clImage = ImageBufferPool::getInstance()->allocateOpenCLImage(
+				clDevice,
 				getOpenCLImageFormat(clDevice, CL_MEM_OBJECT_IMAGE3D, mType, mChannels),
 				mWidth, mHeight, mDepth
 			);
@@ -1205,7 +1203,7 @@ Image::pointer Image::crop(VectorXi offset, VectorXi size, bool allowOutOfBounds
     AffineTransformation::pointer T = AffineTransformation::New();
     newImage->setSpacing(getSpacing());
     // Multiply with spacing here to convert voxel translation to world(mm) translation
-    T->getTransform().translation() = getSpacing().cwiseProduct(getDimensions() == 2 ? Vector3f(offset.x(), offset.y(), 0) : Vector3f(offset.x(), offset.y(), offset.z()));
+    T->setTransform(Affine3f(Eigen::Translation3f(getSpacing().cwiseProduct(getDimensions() == 2 ? Vector3f(offset.x(), offset.y(), 0) : Vector3f(offset.x(), offset.y(), offset.z())))));
     newImage->getSceneGraphNode()->setTransformation(T);
     SceneGraph::setParentNode(newImage, std::static_pointer_cast<SpatialDataObject>(mPtr.lock()));
 
@@ -1229,8 +1227,8 @@ BoundingBox Image::getBoundingBox() const {
     return SpatialDataObject::getBoundingBox().getTransformedBoundingBox(T);
 }
 
-int Image::getNrOfVoxels() const {
-    return mWidth*mHeight*mDepth;
+std::size_t Image::getNrOfVoxels() const {
+    return (std::size_t)mWidth*mHeight*mDepth;
 }
 
 Image::~Image() {
@@ -2,6 +2,7 @@
 
 #include <FAST/Data/SpatialDataObject.hpp>
 #include <FAST/Data/DataTypes.hpp>
+#include <FAST/Data/ImageStatistics.hpp>
 #include <FAST/ExecutionDevice.hpp>
 #include <FAST/Data/Access/ImageAccess.hpp>
 #include <FAST/Data/Access/OpenCLImageAccess.hpp>
@@ -202,6 +203,17 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         template <class T>
         void create(VectorXui, DataType type, uint nrOfChannels, std::unique_ptr<T> ptr);
 
+        /**
+         * Moves the 2D/3D pixel pointer to the host. The deleter of the pointer is used when the data
+         * is freed, thus the data can for instance be a memory mapped file.
+         *
+         * @param size
+         * @param type
+         * @param nrOfChannels
+         * @param ptr
+         */
+        void create(VectorXui size, DataType type, uint nrOfChannels, unique_pixel_ptr ptr);
+
         OpenCLImageAccess::pointer getOpenCLImageAccess(accessType type, OpenCLDevice::pointer);
         OpenCLBufferAccess::pointer getOpenCLBufferAccess(accessType type, OpenCLDevice::pointer);
         ImageAccess::pointer getImageAccess(accessType type);
@@ -214,7 +226,7 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         /**
          * @return the number of pixels/voxels width*height*depth
          */
-        int getNrOfVoxels() const;
+        std::size_t getNrOfVoxels() const;
         Vector3ui getSize() const;
         uchar getDimensions() const;
         DataType getDataType() const;
@@ -226,6 +238,14 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         float calculateMaximumIntensity();
         float calculateMinimumIntensity();
         float calculateAverageIntensity();
+        /**
+         * Calculate a histogram of all pixel values with equally sized bins between
+         * the minimum and maximum intensity. The result is cached until the image is modified.
+         *
+         * @param nrOfBins
+         * @return histogram
+         */
+        std::vector<uint64_t> calculateHistogram(uint nrOfBins = 256);
 
         /**
          * Copy image and put contents to specific device
@@ -297,7 +317,7 @@ class FAST_EXPORT  Image : public SpatialDataObject {
 
         bool hasAnyData();
 
-        uint getBufferSize() const;
+        std::size_t getBufferSize() const;
 
         uint mWidth, mHeight, mDepth;
         uchar mDimensions;
@@ -311,6 +331,9 @@ class FAST_EXPORT  Image : public SpatialDataObject {
         unsigned long mMaxMinTimestamp, mAverageIntensityTimestamp;
         bool mMaxMinInitialized, mAverageInitialized;
         void calculateMaxAndMinIntensity();
+        // Calculate min, max, average and optionally histogram on host in one pass, and cache them
+        void calculateStatisticsOnHost(uint nrOfBins = 0);
+        std::vector<uint64_t> mHistogram;
 
         // Declare as friends so they can get access to the accessFinished methods
         friend class ImageAccess;
@@ -0,0 +1,252 @@
+#include "ImageBufferPool.hpp"
+
+namespace fast {
+
+ImageBufferPool* ImageBufferPool::getInstance() {
+    // Never deleted, as buffers may be released to the pool after static destruction has begun
+    static ImageBufferPool* instance = new ImageBufferPool();
+    return instance;
+}
+
+ImageBufferPool::ImageBufferPool() {
+    m_maximumHostMemory = 512*1024*1024;
+    m_maximumOpenCLMemory = 256*1024*1024;
+}
+
+bool ImageBufferPool::Key::operator==(const Key& other) const {
+    return context == other.context && type == other.type && channelOrder == other.channelOrder &&
+        channelType == other.channelType && width == other.width && height == other.height && depth == other.depth;
+}
+
+std::size_t ImageBufferPool::KeyHash::operator()(const Key& key) const {
+    std::size_t hash = std::hash<void*>()(key.context);
+    for(uint64_t value : {key.type, key.channelOrder, key.channelType, key.width, key.height, key.depth})
+        hash ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+void* ImageBufferPool::allocateHost(std::size_t size, DataType type) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_hostArrays.find({nullptr, (uint64_t)type, 0, 0, size, 0, 0});
+        if(it != m_hostArrays.end() && !it->second.empty()) {
+            void* data = it->second.back();
+            it->second.pop_back();
+            m_hostMemory -= size*getSizeOfDataType(type, 1);
+            ++m_hits;
+            return data;
+        }
+        ++m_misses;
+    }
+    switch(type) {
+        fastSwitchTypeMacro(return new FAST_TYPE[size])
+    }
+    throw Exception("Unknown data type in ImageBufferPool::allocateHost");
+}
+
+void ImageBufferPool::releaseHost(void* data, std::size_t size, DataType type) {
+    if(data == nullptr)
+        return;
+    const std::size_t bytes = size*getSizeOfDataType(type, 1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_hostMemory + bytes <= m_maximumHostMemory) {
+            m_hostArrays[{nullptr, (uint64_t)type, 0, 0, size, 0, 0}].push_back(data);
+            m_hostMemory += bytes;
+            return;
+        }
+    }
+    // Pool is full
+    deleteArray(data, type);
+}
+
+cl::Image* ImageBufferPool::allocateOpenCLImage(OpenCLDevice::pointer device, cl::ImageFormat format, uint width, uint height) {
+    const Key key = {device->getContext()(), CL_MEM_OBJECT_IMAGE2D, format.image_channel_order, format.image_channel_data_type, width, height, 1};
+    PooledObject<cl::Image> pooled = {nullptr};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_openCLImages.find(key);
+        if(it != m_openCLImages.end() && !it->second.empty()) {
+            pooled = it->second.back();
+            it->second.pop_back();
+            m_openCLMemory -= pooled.object->getImageInfo<CL_IMAGE_ELEMENT_SIZE>()*width*height;
+            ++m_hits;
+        } else {
+            ++m_misses;
+        }
+    }
+    if(pooled.object != nullptr) {
+        // Wait for commands using the image before it was released
+        pooled.lastUse.wait();
+        return pooled.object;
+    }
+    return new cl::Image2D(device->getContext(), CL_MEM_READ_WRITE, format, width, height);
+}
+
+cl::Image* ImageBufferPool::allocateOpenCLImage(OpenCLDevice::pointer device, cl::ImageFormat format, uint width, uint height, uint depth) {
+    const Key key = {device->getContext()(), CL_MEM_OBJECT_IMAGE3D, format.image_channel_order, format.image_channel_data_type, width, height, depth};
+    PooledObject<cl::Image> pooled = {nullptr};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_openCLImages.find(key);
+        if(it != m_openCLImages.end() && !it->second.empty()) {
+            pooled = it->second.back();
+            it->second.pop_back();
+            m_openCLMemory -= pooled.object->getImageInfo<CL_IMAGE_ELEMENT_SIZE>()*width*height*depth;
+            ++m_hits;
+        } else {
+            ++m_misses;
+        }
+    }
+    if(pooled.object != nullptr) {
+        // Wait for commands using the image before it was released
+        pooled.lastUse.wait();
+        return pooled.object;
+    }
+    return new cl::Image3D(device->getContext(), CL_MEM_READ_WRITE, format, width, height, depth);
+}
+
+ImageBufferPool::Key ImageBufferPool::getImageKey(const cl::Image& image) {
+    const cl_image_format format = image.getImageInfo<CL_IMAGE_FORMAT>();
+    const cl_mem_object_type type = image.getInfo<CL_MEM_TYPE>();
+    return {
+        image.getInfo<CL_MEM_CONTEXT>()(),
+        type,
+        format.image_channel_order,
+        format.image_channel_data_type,
+        image.getImageInfo<CL_IMAGE_WIDTH>(),
+        image.getImageInfo<CL_IMAGE_HEIGHT>(),
+        type == CL_MEM_OBJECT_IMAGE3D ? image.getImageInfo<CL_IMAGE_DEPTH>() : 1
+    };
+}
+
+cl::Event ImageBufferPool::getLastUseEvent(OpenCLDevice::pointer device) {
+    // The marker completes when all commands enqueued on the device so far are finished
+    cl::Event event;
+#if !defined(CL_VERSION_1_2) || defined(CL_USE_DEPRECATED_OPENCL_1_1_APIS)
+    device->getCommandQueue().enqueueMarker(&event);
+#else
+    device->getCommandQueue().enqueueMarkerWithWaitList(NULL, &event);
+#endif
+    device->getCommandQueue().flush();
+    return event;
+}
+
+void ImageBufferPool::releaseOpenCLImage(OpenCLDevice::pointer device, cl::Image* image) {
+    if(image == nullptr)
+        return;
+    const Key key = getImageKey(*image);
+    const std::size_t bytes = image->getImageInfo<CL_IMAGE_ELEMENT_SIZE>()*key.width*key.height*key.depth;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_openCLMemory + bytes <= m_maximumOpenCLMemory) {
+            m_openCLImages[key].push_back({image, getLastUseEvent(device)});
+            m_openCLMemory += bytes;
+            return;
+        }
+    }
+    // Pool is full
+    delete image;
+}
+
+cl::Buffer* ImageBufferPool::allocateOpenCLBuffer(OpenCLDevice::pointer device, std::size_t size) {
+    const Key key = {device->getContext()(), CL_MEM_OBJECT_BUFFER, 0, 0, size, 0, 0};
+    PooledObject<cl::Buffer> pooled = {nullptr};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_openCLBuffers.find(key);
+        if(it != m_openCLBuffers.end() && !it->second.empty()) {
+            pooled = it->second.back();
+            it->second.pop_back();
+            m_openCLMemory -= size;
+            ++m_hits;
+        } else {
+            ++m_misses;
+        }
+    }
+    if(pooled.object != nullptr) {
+        // Wait for commands using the buffer before it was released
+        pooled.lastUse.wait();
+        return pooled.object;
+    }
+    return new cl::Buffer(device->getContext(), CL_MEM_READ_WRITE, size);
+}
+
+void ImageBufferPool::releaseOpenCLBuffer(OpenCLDevice::pointer device, cl::Buffer* buffer) {
+    if(buffer == nullptr)
+        return;
+    const std::size_t size = buffer->getInfo<CL_MEM_SIZE>();
+    const Key key = {buffer->getInfo<CL_MEM_CONTEXT>()(), CL_MEM_OBJECT_BUFFER, 0, 0, size, 0, 0};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_openCLMemory + size <= m_maximumOpenCLMemory) {
+            m_openCLBuffers[key].push_back({buffer, getLastUseEvent(device)});
+            m_openCLMemory += size;
+            return;
+        }
+    }
+    // Pool is full
+    delete buffer;
+}
+
+void ImageBufferPool::setMaximumHostMemory(std::size_t bytes) {
+    bool tooLarge;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maximumHostMemory = bytes;
+        tooLarge = m_hostMemory > bytes;
+    }
+    if(tooLarge)
+        clear();
+}
+
+void ImageBufferPool::setMaximumOpenCLMemory(std::size_t bytes) {
+    bool tooLarge;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maximumOpenCLMemory = bytes;
+        tooLarge = m_openCLMemory > bytes;
+    }
+    if(tooLarge)
+        clear();
+}
+
+void ImageBufferPool::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto&& arrays : m_hostArrays) {
+        for(auto data : arrays.second)
+            deleteArray(data, (DataType)arrays.first.type);
+    }
+    m_hostArrays.clear();
+    m_hostMemory = 0;
+    // Deleting only releases the OpenCL objects, the runtime keeps them alive until queued commands using them are finished
+    for(auto&& images : m_openCLImages) {
+        for(auto&& image : images.second)
+            delete image.object;
+    }
+    m_openCLImages.clear();
+    for(auto&& buffers : m_openCLBuffers) {
+        for(auto&& buffer : buffers.second)
+            delete buffer.object;
+    }
+    m_openCLBuffers.clear();
+    m_openCLMemory = 0;
+}
+
+uint64_t ImageBufferPool::getNrOfHits() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t ImageBufferPool::getNrOfMisses() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void ImageBufferPool::resetCounters() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
+
+}
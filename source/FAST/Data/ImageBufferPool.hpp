@@ -0,0 +1,116 @@
+#pragma once
+
+#include <FAST/Data/DataTypes.hpp>
+#include <FAST/ExecutionDevice.hpp>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+namespace fast {
+
+/**
+ * A pool of recyclable pixel buffers used by Image.
+ * When an image is freed, its host array and OpenCL images/buffers are returned to this pool,
+ * and new images of the same size and type reuse them instead of allocating new memory.
+ * This removes per frame allocations in streaming pipelines.
+ *
+ * Host arrays are keyed on data type and number of elements, OpenCL images on context, format and size,
+ * and OpenCL buffers on context and size in bytes. When the pool is full, released buffers are deleted.
+ *
+ * Commands using an OpenCL image or buffer may still be queued when it is released. Therefore a marker
+ * is enqueued on the device's queue at release, and allocate waits for it before handing the object out again.
+ */
+class FAST_EXPORT ImageBufferPool {
+    public:
+        static ImageBufferPool* getInstance();
+        /**
+         * Get a host array with the given number of elements of the given type.
+         * The array is not initialized.
+         */
+        void* allocateHost(std::size_t size, DataType type);
+        /**
+         * Give a host array created by allocateHost back to the pool
+         */
+        void releaseHost(void* data, std::size_t size, DataType type);
+        /**
+         * Get a 2D OpenCL image. The image content is not initialized.
+         */
+        cl::Image* allocateOpenCLImage(OpenCLDevice::pointer device, cl::ImageFormat format, uint width, uint height);
+        /**
+         * Get a 3D OpenCL image. The image content is not initialized.
+         */
+        cl::Image* allocateOpenCLImage(OpenCLDevice::pointer device, cl::ImageFormat format, uint width, uint height, uint depth);
+        /**
+         * Give an OpenCL image back to the pool. The pool takes ownership of the object.
+         * @param device Device whose queue the image was last used on
+         * @param image
+         */
+        void releaseOpenCLImage(OpenCLDevice::pointer device, cl::Image* image);
+        /**
+         * Get an OpenCL buffer of the given size in bytes. The buffer content is not initialized.
+         */
+        cl::Buffer* allocateOpenCLBuffer(OpenCLDevice::pointer device, std::size_t size);
+        /**
+         * Give an OpenCL buffer back to the pool. The pool takes ownership of the object.
+         * @param device Device whose queue the buffer was last used on
+         * @param buffer
+         */
+        void releaseOpenCLBuffer(OpenCLDevice::pointer device, cl::Buffer* buffer);
+        /**
+         * Set maximum number of bytes of host memory kept in the pool. 0 disables pooling of host arrays.
+         */
+        void setMaximumHostMemory(std::size_t bytes);
+        /**
+         * Set maximum number of bytes of OpenCL memory kept in the pool. 0 disables pooling of OpenCL images and buffers.
+         */
+        void setMaximumOpenCLMemory(std::size_t bytes);
+        /**
+         * Delete all buffers in the pool
+         */
+        void clear();
+        /**
+         * @return number of allocations served from the pool
+         */
+        uint64_t getNrOfHits();
+        /**
+         * @return number of allocations which had to create a new buffer
+         */
+        uint64_t getNrOfMisses();
+        void resetCounters();
+    private:
+        struct Key {
+            void* context; // nullptr for host
+            uint64_t type; // DataType for host, OpenCL memory object type otherwise
+            uint64_t channelOrder;
+            uint64_t channelType;
+            uint64_t width; // Nr of elements/bytes for host arrays/buffers
+            uint64_t height;
+            uint64_t depth;
+            bool operator==(const Key& other) const;
+        };
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const;
+        };
+        // An OpenCL memory object in the pool, and a marker which completes when all commands using it are finished
+        template <class T>
+        struct PooledObject {
+            T* object;
+            cl::Event lastUse;
+        };
+        ImageBufferPool();
+        static Key getImageKey(const cl::Image& image);
+        static cl::Event getLastUseEvent(OpenCLDevice::pointer device);
+
+        std::mutex m_mutex;
+        std::unordered_map<Key, std::vector<void*>, KeyHash> m_hostArrays;
+        std::unordered_map<Key, std::vector<PooledObject<cl::Image>>, KeyHash> m_openCLImages;
+        std::unordered_map<Key, std::vector<PooledObject<cl::Buffer>>, KeyHash> m_openCLBuffers;
+        std::size_t m_maximumHostMemory;
+        std::size_t m_maximumOpenCLMemory;
+        std::size_t m_hostMemory = 0;
+        std::size_t m_openCLMemory = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+};
+
+}
@@ -3,6 +3,7 @@
 #include <FAST/Utility.hpp>
 #include <FAST/Data/Image.hpp>
 #include <FAST/Data/Access/ImagePyramidAccess.hpp>
+#include <FAST/ThreadPool.hpp>
 #ifdef WIN32
 #include <winbase.h>
 #else
@@ -156,6 +157,8 @@ void ImagePyramid::create(openslide_t *fileHandle, std::vector<ImagePyramidLevel
 
 ImagePyramid::ImagePyramid() {
     m_initialized = false;
+    m_nrOfPrefetchThreads = std::max(std::thread::hardware_concurrency() / 2, 1u);
+    m_cancelPrefetch = false;
 }
 
 int ImagePyramid::getNrOfLevels() {
@@ -187,6 +190,17 @@ void ImagePyramid::free(ExecutionDevice::pointer device) {
 }
 
 void ImagePyramid::freeAll() {
+    // Wait for prefetching to stop before the file is closed
+    m_cancelPrefetch = true;
+    std::shared_ptr<ThreadPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+        pool = std::move(m_prefetchPool);
+    }
+    if(pool)
+        pool->waitToFinish();
+    m_cancelPrefetch = false;
+    clearPatchCache();
     if(m_fileHandle != nullptr) {
         m_levels.clear();
         openslide_close(m_fileHandle);
@@ -259,4 +273,173 @@ void ImagePyramid::clearDirtyPatches(std::set<std::string> patches) {
 		m_dirtyPatches.erase(patch);
 }
 
+static std::string getPatchKey(int level, int x, int y, int width, int height) {
+    return std::to_string(level) + "_" + std::to_string(x) + "_" + std::to_string(y) + "_" +
+        std::to_string(width) + "_" + std::to_string(height);
+}
+
+ImagePyramid::PatchData ImagePyramid::readPatchFromFile(int level, int x, int y, int width, int height) {
+    auto data = make_uninitialized_unique<uchar[]>((std::size_t)width*height*4);
+    float scale = (float)getFullWidth()/getLevelWidth(level);
+    openslide_read_region(m_fileHandle, (uint32_t*)data.get(), x * scale, y * scale, level, width, height);
+    return PatchData(data.release(), std::default_delete<uchar[]>());
+}
+
+ImagePyramid::PatchData ImagePyramid::readPatch(int level, int x, int y, int width, int height) {
+    const std::string key = getPatchKey(level, x, y, width, height);
+    std::promise<PatchData> promise;
+    {
+        std::unique_lock<std::mutex> lock(m_patchCacheMutex);
+        if(m_maximumPatchCacheSize == 0) {
+            ++m_patchCacheMisses;
+            lock.unlock();
+            return readPatchFromFile(level, x, y, width, height);
+        }
+        auto it = m_patchCache.find(key);
+        if(it != m_patchCache.end()) {
+            ++m_patchCacheHits;
+            m_patchCacheLRU.splice(m_patchCacheLRU.begin(), m_patchCacheLRU, it->second.position);
+            // Patch may still be read by a prefetch thread, if so wait for it outside the lock
+            auto future = it->second.data;
+            lock.unlock();
+            PatchData data;
+            try {
+                data = future.get();
+            } catch(...) {
+                // Prefetch failed, try again below to report the error to the caller
+            }
+            if(!data) {
+                // Prefetch was cancelled or failed, remove it so that the patch is read and cached again as a miss
+                lock.lock();
+                --m_patchCacheHits;
+                erasePatchIfFailed(key);
+                lock.unlock();
+                return readPatch(level, x, y, width, height);
+            }
+            return data;
+        }
+        ++m_patchCacheMisses;
+        m_patchCacheLRU.push_front(key);
+        m_patchCache[key] = {promise.get_future().share(), (std::size_t)width*height*4, m_patchCacheLRU.begin()};
+        m_patchCacheSize += (std::size_t)width*height*4;
+        evictPatches();
+    }
+    // Read outside the lock, so that several patches can be read in parallel
+    try {
+        PatchData data = readPatchFromFile(level, x, y, width, height);
+        promise.set_value(data);
+        return data;
+    } catch(...) {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+        auto it = m_patchCache.find(key);
+        if(it != m_patchCache.end()) {
+            m_patchCacheSize -= it->second.bytes;
+            m_patchCacheLRU.erase(it->second.position);
+            m_patchCache.erase(it);
+        }
+        throw;
+    }
+}
+
+void ImagePyramid::evictPatches() {
+    // Assumes m_patchCacheMutex is locked. Never evict the newest patch.
+    while(m_patchCacheSize > m_maximumPatchCacheSize && m_patchCacheLRU.size() > 1) {
+        auto it = m_patchCache.find(m_patchCacheLRU.back());
+        m_patchCacheSize -= it->second.bytes;
+        m_patchCache.erase(it);
+        m_patchCacheLRU.pop_back();
+    }
+}
+
+void ImagePyramid::erasePatchIfFailed(const std::string& key) {
+    // Assumes m_patchCacheMutex is locked
+    auto it = m_patchCache.find(key);
+    if(it == m_patchCache.end())
+        return;
+    // Another read of the patch may have replaced the entry already
+    if(it->second.data.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+    try {
+        if(it->second.data.get())
+            return;
+    } catch(...) {
+    }
+    m_patchCacheSize -= it->second.bytes;
+    m_patchCacheLRU.erase(it->second.position);
+    m_patchCache.erase(it);
+}
+
+void ImagePyramid::clearPatchCache() {
+    std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+    m_patchCache.clear();
+    m_patchCacheLRU.clear();
+    m_patchCacheSize = 0;
+}
+
+void ImagePyramid::prefetchPatch(int level, int x, int y, int width, int height) {
+    if(m_fileHandle == nullptr)
+        return;
+    const std::string key = getPatchKey(level, x, y, width, height);
+    auto promise = std::make_shared<std::promise<PatchData>>();
+    std::shared_ptr<ThreadPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+        if(m_maximumPatchCacheSize == 0 || m_patchCache.count(key) > 0)
+            return;
+        m_patchCacheLRU.push_front(key);
+        m_patchCache[key] = {promise->get_future().share(), (std::size_t)width*height*4, m_patchCacheLRU.begin()};
+        m_patchCacheSize += (std::size_t)width*height*4;
+        evictPatches();
+        if(!m_prefetchPool)
+            m_prefetchPool = std::make_shared<ThreadPool>(m_nrOfPrefetchThreads);
+        pool = m_prefetchPool;
+    }
+    pool->enqueue([this, promise, level, x, y, width, height]() {
+        if(m_cancelPrefetch) {
+            promise->set_value(nullptr);
+            return;
+        }
+        try {
+            promise->set_value(readPatchFromFile(level, x, y, width, height));
+        } catch(...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+}
+
+void ImagePyramid::setPatchCacheSize(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+    m_maximumPatchCacheSize = bytes;
+    if(bytes == 0) {
+        m_patchCache.clear();
+        m_patchCacheLRU.clear();
+        m_patchCacheSize = 0;
+    } else {
+        evictPatches();
+    }
+}
+
+void ImagePyramid::setNumberOfPrefetchThreads(int threads) {
+    if(threads <= 0)
+        throw Exception("Number of prefetch threads must be larger than 0");
+    std::shared_ptr<ThreadPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+        m_nrOfPrefetchThreads = threads;
+        // A new pool will be created on the next prefetch
+        pool = std::move(m_prefetchPool);
+    }
+}
+
+uint64_t ImagePyramid::getNrOfPatchCacheHits() {
+    std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+    return m_patchCacheHits;
+}
+
+uint64_t ImagePyramid::getNrOfPatchCacheMisses() {
+    std::lock_guard<std::mutex> lock(m_patchCacheMutex);
+    return m_patchCacheMisses;
+}
+
 }
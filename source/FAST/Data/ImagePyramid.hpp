@@ -4,12 +4,17 @@
 #include <FAST/Data/Access/Access.hpp>
 #include <FAST/Data/Access/ImagePyramidAccess.hpp>
 #include <set>
+#include <list>
+#include <unordered_map>
+#include <future>
+#include <atomic>
 
 // Forward declare
 
 namespace fast {
 
 class Image;
+class ThreadPool;
 
 /**
  * Data object for storing large images as tiled image pyramids.
@@ -32,11 +37,54 @@ class FAST_EXPORT ImagePyramid : public SpatialDataObject {
         std::set<std::string> getDirtyPatches();
         void setDirtyPatch(int level, int patchIdX, int patchIdY);
         void clearDirtyPatches(std::set<std::string> patches);
+        /**
+         * Set maximum number of bytes used by the cache of patches read from an OpenSlide file.
+         * Least recently used patches are removed when the cache is full. 0 disables the cache.
+         * Default is 256 MB.
+         */
+        void setPatchCacheSize(std::size_t bytes);
+        /**
+         * Set number of threads used to read patches in advance, see prefetchPatch.
+         * Default is half the number of cores.
+         */
+        void setNumberOfPrefetchThreads(int threads);
+        /**
+         * Start reading a patch from the OpenSlide file in the background. A later call to
+         * ImagePyramidAccess::getPatchData with the same region will be served from the patch cache.
+         * Has no effect if the image pyramid is not backed by an OpenSlide file, or the patch cache is disabled.
+         */
+        void prefetchPatch(int level, int x, int y, int width, int height);
+        /**
+         * @return number of patch reads served from the patch cache
+         */
+        uint64_t getNrOfPatchCacheHits();
+        /**
+         * @return number of patch reads which had to read from the OpenSlide file
+         */
+        uint64_t getNrOfPatchCacheMisses();
         void free(ExecutionDevice::pointer device) override;
         void freeAll() override;
         ~ImagePyramid();
     private:
         ImagePyramid();
+        friend class ImagePyramidAccess;
+        typedef std::shared_ptr<uchar> PatchData;
+        struct PatchCacheEntry {
+            std::shared_future<PatchData> data;
+            std::size_t bytes;
+            std::list<std::string>::iterator position; // Position in LRU list
+        };
+        /**
+         * Get patch data from the OpenSlide file through the patch cache. The returned data must not be modified.
+         */
+        PatchData readPatch(int level, int x, int y, int width, int height);
+        PatchData readPatchFromFile(int level, int x, int y, int width, int height);
+        void evictPatches();
+        /**
+         * Remove the patch from the cache if its read was cancelled or failed
+         */
+        void erasePatchIfFailed(const std::string& key);
+        void clearPatchCache();
         std::vector<Level> m_levels;
 
         openslide_t* m_fileHandle = nullptr;
@@ -47,6 +95,18 @@ class FAST_EXPORT ImagePyramid : public SpatialDataObject {
         std::set<std::string> m_dirtyPatches;
         static int m_counter;
         std::mutex m_dirtyPatchMutex;
+
+        std::mutex m_patchCacheMutex;
+        std::unordered_map<std::string, PatchCacheEntry> m_patchCache;
+        std::list<std::string> m_patchCacheLRU; // Most recently used first
+        std::size_t m_patchCacheSize = 0;
+        std::size_t m_maximumPatchCacheSize = 256*1024*1024;
+        uint64_t m_patchCacheHits = 0;
+        uint64_t m_patchCacheMisses = 0;
+        // Shared, so that it can be swapped out under the lock while a prefetch is enqueuing tasks
+        std::shared_ptr<ThreadPool> m_prefetchPool;
+        int m_nrOfPrefetchThreads;
+        std::atomic<bool> m_cancelPrefetch;
 };
 
 }
@@ -0,0 +1,259 @@
+#include "ImageStatistics.hpp"
+#include <algorithm>
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FAST_STATISTICS_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FAST_STATISTICS_SSE2
+#endif
+
+namespace fast {
+
+float ImageStatistics::getAverage() const {
+    if(nrOfElements == 0)
+        return 0.0f;
+    return (float)(sum / nrOfElements);
+}
+
+// Reduction result of one block of the data
+struct BlockResult {
+    double minimum;
+    double maximum;
+    double sum;
+};
+
+// Scalar reduction with several independent accumulators, so that the compiler can vectorize the loop
+template <class T, class SumType>
+static BlockResult reduceBlock(const T* data, std::size_t size) {
+    const int lanes = 8;
+    T minimum[lanes], maximum[lanes];
+    SumType sum[lanes];
+    for(int j = 0; j < lanes; ++j) {
+        minimum[j] = data[0];
+        maximum[j] = data[0];
+        sum[j] = 0;
+    }
+    std::size_t i = 0;
+    for(; i + lanes <= size; i += lanes) {
+        for(int j = 0; j < lanes; ++j) {
+            const T value = data[i + j];
+            minimum[j] = value < minimum[j] ? value : minimum[j];
+            maximum[j] = value > maximum[j] ? value : maximum[j];
+            sum[j] += value;
+        }
+    }
+    for(; i < size; ++i) {
+        minimum[0] = std::min(minimum[0], data[i]);
+        maximum[0] = std::max(maximum[0], data[i]);
+        sum[0] += data[i];
+    }
+    BlockResult result = {(double)minimum[0], (double)maximum[0], 0.0};
+    for(int j = 0; j < lanes; ++j) {
+        result.minimum = std::min(result.minimum, (double)minimum[j]);
+        result.maximum = std::max(result.maximum, (double)maximum[j]);
+        result.sum += (double)sum[j];
+    }
+    return result;
+}
+
+#if defined(FAST_STATISTICS_AVX)
+template <>
+BlockResult reduceBlock<float, double>(const float* data, std::size_t size) {
+    __m256 minimum = _mm256_set1_ps(data[0]);
+    __m256 maximum = minimum;
+    // Sum in double precision to avoid loss of precision for large images
+    __m256d sumLow = _mm256_setzero_pd();
+    __m256d sumHigh = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for(; i + 8 <= size; i += 8) {
+        const __m256 value = _mm256_loadu_ps(data + i);
+        // Value as first operand: NaN values are ignored
+        minimum = _mm256_min_ps(value, minimum);
+        maximum = _mm256_max_ps(value, maximum);
+        sumLow = _mm256_add_pd(sumLow, _mm256_cvtps_pd(_mm256_castps256_ps128(value)));
+        sumHigh = _mm256_add_pd(sumHigh, _mm256_cvtps_pd(_mm256_extractf128_ps(value, 1)));
+    }
+    float minimums[8], maximums[8];
+    double sums[4];
+    _mm256_storeu_ps(minimums, minimum);
+    _mm256_storeu_ps(maximums, maximum);
+    _mm256_storeu_pd(sums, _mm256_add_pd(sumLow, sumHigh));
+    BlockResult result = {minimums[0], maximums[0], sums[0] + sums[1] + sums[2] + sums[3]};
+    for(int j = 1; j < 8; ++j) {
+        result.minimum = std::min(result.minimum, (double)minimums[j]);
+        result.maximum = std::max(result.maximum, (double)maximums[j]);
+    }
+    for(; i < size; ++i) {
+        result.minimum = std::min(result.minimum, (double)data[i]);
+        result.maximum = std::max(result.maximum, (double)data[i]);
+        result.sum += data[i];
+    }
+    return result;
+}
+#elif defined(FAST_STATISTICS_SSE2)
+template <>
+BlockResult reduceBlock<float, double>(const float* data, std::size_t size) {
+    __m128 minimum = _mm_set1_ps(data[0]);
+    __m128 maximum = minimum;
+    // Sum in double precision to avoid loss of precision for large images
+    __m128d sumLow = _mm_setzero_pd();
+    __m128d sumHigh = _mm_setzero_pd();
+    std::size_t i = 0;
+    for(; i + 4 <= size; i += 4) {
+        const __m128 value = _mm_loadu_ps(data + i);
+        // Value as first operand: NaN values are ignored
+        minimum = _mm_min_ps(value, minimum);
+        maximum = _mm_max_ps(value, maximum);
+        sumLow = _mm_add_pd(sumLow, _mm_cvtps_pd(value));
+        sumHigh = _mm_add_pd(sumHigh, _mm_cvtps_pd(_mm_movehl_ps(value, value)));
+    }
+    float minimums[4], maximums[4];
+    double sums[2];
+    _mm_storeu_ps(minimums, minimum);
+    _mm_storeu_ps(maximums, maximum);
+    _mm_storeu_pd(sums, _mm_add_pd(sumLow, sumHigh));
+    BlockResult result = {minimums[0], maximums[0], sums[0] + sums[1]};
+    for(int j = 1; j < 4; ++j) {
+        result.minimum = std::min(result.minimum, (double)minimums[j]);
+        result.maximum = std::max(result.maximum, (double)maximums[j]);
+    }
+    for(; i < size; ++i) {
+        result.minimum = std::min(result.minimum, (double)data[i]);
+        result.maximum = std::max(result.maximum, (double)data[i]);
+        result.sum += data[i];
+    }
+    return result;
+}
+#endif
+
+#if defined(FAST_STATISTICS_SSE2)
+template <>
+BlockResult reduceBlock<uchar, uint64_t>(const uchar* data, std::size_t size) {
+    __m128i minimum = _mm_set1_epi8((char)data[0]);
+    __m128i maximum = minimum;
+    __m128i sum = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        const __m128i value = _mm_loadu_si128((const __m128i*)(data + i));
+        minimum = _mm_min_epu8(minimum, value);
+        maximum = _mm_max_epu8(maximum, value);
+        // Sum of absolute differences with zero gives the sum of each 8 byte half as two 64 bit integers
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(value, zero));
+    }
+    uchar minimums[16], maximums[16];
+    uint64_t sums[2];
+    _mm_storeu_si128((__m128i*)minimums, minimum);
+    _mm_storeu_si128((__m128i*)maximums, maximum);
+    _mm_storeu_si128((__m128i*)sums, sum);
+    BlockResult result = {(double)minimums[0], (double)maximums[0], (double)(sums[0] + sums[1])};
+    for(int j = 1; j < 16; ++j) {
+        result.minimum = std::min(result.minimum, (double)minimums[j]);
+        result.maximum = std::max(result.maximum, (double)maximums[j]);
+    }
+    for(; i < size; ++i) {
+        result.minimum = std::min(result.minimum, (double)data[i]);
+        result.maximum = std::max(result.maximum, (double)data[i]);
+        result.sum += data[i];
+    }
+    return result;
+}
+#endif
+
+// Split data in at most this many blocks, and never less than minimumBlockSize elements per block
+static const int maximumNrOfBlocks = 256;
+static const std::size_t minimumBlockSize = 1 << 16;
+
+static std::size_t getBlockSize(std::size_t nrOfElements) {
+    return std::max(minimumBlockSize, (nrOfElements + maximumNrOfBlocks - 1) / maximumNrOfBlocks);
+}
+
+template <class T, class SumType>
+static void calculateStatistics(const T* data, std::size_t nrOfElements, uint nrOfBins, ImageStatistics& statistics) {
+    const std::size_t blockSize = getBlockSize(nrOfElements);
+    const int nrOfBlocks = (int)((nrOfElements + blockSize - 1) / blockSize);
+    std::vector<BlockResult> results(nrOfBlocks);
+    #pragma omp parallel for if(nrOfBlocks > 1)
+    for(int block = 0; block < nrOfBlocks; ++block) {
+        const std::size_t start = block*blockSize;
+        results[block] = reduceBlock<T, SumType>(data + start, std::min(blockSize, nrOfElements - start));
+    }
+    BlockResult total = results[0];
+    total.sum = 0.0;
+    for(auto&& result : results) {
+        total.minimum = std::min(total.minimum, result.minimum);
+        total.maximum = std::max(total.maximum, result.maximum);
+        total.sum += result.sum;
+    }
+    statistics.minimum = (float)total.minimum;
+    statistics.maximum = (float)total.maximum;
+    statistics.sum = total.sum;
+
+    if(nrOfBins == 0)
+        return;
+    // Histogram needs minimum and maximum, thus a second pass
+    std::vector<std::vector<uint64_t>> histograms(nrOfBlocks);
+    const double minimum = total.minimum;
+    const double scale = total.maximum > total.minimum ? nrOfBins / (total.maximum - total.minimum) : 0.0;
+    #pragma omp parallel for if(nrOfBlocks > 1)
+    for(int block = 0; block < nrOfBlocks; ++block) {
+        std::vector<uint64_t>& histogram = histograms[block];
+        histogram.resize(nrOfBins, 0);
+        const std::size_t start = block*blockSize;
+        const std::size_t end = std::min(start + blockSize, nrOfElements);
+        for(std::size_t i = start; i < end; ++i) {
+            const double bin = (data[i] - minimum)*scale;
+            if(bin >= 0.0) // False for NaN
+                ++histogram[std::min((uint)bin, nrOfBins - 1)];
+        }
+    }
+    statistics.histogram = std::vector<uint64_t>(nrOfBins, 0);
+    for(auto&& histogram : histograms) {
+        for(uint bin = 0; bin < nrOfBins; ++bin)
+            statistics.histogram[bin] += histogram[bin];
+    }
+}
+
+ImageStatistics calculateImageStatistics(const void* data, std::size_t nrOfElements, DataType type, uint nrOfBins) {
+    ImageStatistics statistics;
+    statistics.nrOfElements = nrOfElements;
+    if(nrOfElements == 0)
+        return statistics;
+
+    switch(type) {
+        case TYPE_FLOAT:
+            calculateStatistics<float, double>((const float*)data, nrOfElements, nrOfBins, statistics);
+            break;
+        case TYPE_UINT8:
+            calculateStatistics<uchar, uint64_t>((const uchar*)data, nrOfElements, nrOfBins, statistics);
+            break;
+        case TYPE_INT8:
+            calculateStatistics<char, int64_t>((const char*)data, nrOfElements, nrOfBins, statistics);
+            break;
+        case TYPE_UINT16:
+        case TYPE_UNORM_INT16:
+            calculateStatistics<ushort, uint64_t>((const ushort*)data, nrOfElements, nrOfBins, statistics);
+            break;
+        case TYPE_INT16:
+        case TYPE_SNORM_INT16:
+            calculateStatistics<short, int64_t>((const short*)data, nrOfElements, nrOfBins, statistics);
+            break;
+    }
+
+    // Normalized types are interpreted as floats
+    if(type == TYPE_UNORM_INT16) {
+        statistics.minimum /= 65535.0f;
+        statistics.maximum /= 65535.0f;
+        statistics.sum /= 65535.0;
+    } else if(type == TYPE_SNORM_INT16) {
+        statistics.minimum = std::max(-1.0f, statistics.minimum / 32767.0f);
+        statistics.maximum = std::max(-1.0f, statistics.maximum / 32767.0f);
+        statistics.sum /= 32767.0;
+    }
+
+    return statistics;
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <FAST/Data/DataTypes.hpp>
+#include <vector>
+
+namespace fast {
+
+/**
+ * Result of a reduction over the elements of an image
+ */
+struct FAST_EXPORT ImageStatistics {
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    double sum = 0.0;
+    std::size_t nrOfElements = 0;
+    /**
+     * Histogram with equally sized bins between minimum and maximum. Empty if not requested.
+     */
+    std::vector<uint64_t> histogram;
+
+    float getAverage() const;
+};
+
+/**
+ * Calculate minimum, maximum and sum of a host data array in one pass.
+ * The array is split in chunks which are reduced in parallel using OpenMP.
+ * Float and uint8 chunks are reduced with SSE2/AVX instructions when available,
+ * other types use a loop with independent accumulators which compilers auto-vectorize.
+ * Normalized integer types (TYPE_UNORM_INT16 and TYPE_SNORM_INT16) are returned as normalized float values.
+ *
+ * @param data
+ * @param nrOfElements Number of scalar elements, including channels
+ * @param type
+ * @param nrOfBins If larger than 0, a histogram with this many bins between minimum and maximum is also calculated.
+ *      Since its range depends on minimum and maximum, this requires a second pass over the data.
+ * @return
+ */
+FAST_EXPORT ImageStatistics calculateImageStatistics(const void* data, std::size_t nrOfElements, DataType type, uint nrOfBins = 0);
+
+}
@@ -8,6 +8,8 @@ void Tensor::create(std::unique_ptr<float[]> data, TensorShape shape) {
     if(shape.empty())
         throw Exception("Shape can't be empty");
     m_data = std::move(data);
+    m_externalData = nullptr;
+    m_externalDataOwner.reset();
     m_shape = shape;
     m_spacing = VectorXf::Ones(shape.getDimensions());
     mHostDataIsUpToDate = true;
@@ -24,6 +26,9 @@ void Tensor::create(TensorShape shape) {
     if(shape.getUnknownDimensions() > 0)
         throw Exception("When creating a tensor, shape must be fully defined");
     m_data = make_uninitialized_unique<float[]>(shape.getTotalSize());
+    m_externalData = nullptr;
+    m_externalDataOwner.reset();
+    m_shape = shape;
     m_spacing = VectorXf::Ones(shape.getDimensions());
     mHostDataIsUpToDate = true;
     if(m_shape.getDimensions() >= 3) {
@@ -38,6 +43,8 @@ void Tensor::create(std::initializer_list<float> data) {
 		throw Exception("Shape can't be empty");
 
 	m_data = std::make_unique<float[]>(data.size());
+    m_externalData = nullptr;
+    m_externalDataOwner.reset();
 	int i = 0;
 	for(auto item : data) {
 		m_data[i] = item;
@@ -53,6 +60,48 @@ void Tensor::create(std::initializer_list<float> data) {
     }
 }
 
+void Tensor::create(float* data, TensorShape shape, std::shared_ptr<void> owner) {
+    if(shape.empty())
+        throw Exception("Shape can't be empty");
+    if(shape.getUnknownDimensions() > 0)
+        throw Exception("When creating a tensor, shape must be fully defined");
+    if(data == nullptr)
+        throw Exception("External data of tensor can't be a null pointer");
+    m_data.reset();
+    m_externalData = data;
+    m_externalDataOwner = owner;
+    m_shape = shape;
+    m_spacing = VectorXf::Ones(shape.getDimensions());
+    mHostDataIsUpToDate = true;
+    if(m_shape.getDimensions() >= 3) {
+        const int width = m_shape[m_shape.getDimensions() - 2];
+        const int height = m_shape[m_shape.getDimensions() - 3];
+        mBoundingBox = BoundingBox(Vector3f(width, height, 1));
+    }
+}
+
+Tensor::pointer Tensor::getSubTensor(int i) {
+    if(!isInitialized())
+        throw Exception("Tensor has not been initialized.");
+    if(m_shape.getDimensions() < 2)
+        throw Exception("Tensor must have at least 2 dimensions to get a sub tensor");
+    if(i < 0 || i >= m_shape[0])
+        throw Exception("Sub tensor index " + std::to_string(i) + " out of range in Tensor::getSubTensor");
+
+    {
+        // Make sure host data is up to date
+        auto access = getAccess(ACCESS_READ);
+    }
+
+    TensorShape shape;
+    for(int j = 1; j < m_shape.getDimensions(); ++j)
+        shape.addDimension(m_shape[j]);
+    auto view = Tensor::New();
+    // The view keeps this tensor, and thereby its data, alive
+    view->create(getHostDataPointer() + (std::size_t)i*shape.getTotalSize(), shape, mPtr.lock());
+    return view;
+}
+
 void Tensor::expandDims(int position) {
 	if(position < 0) { // append to end
 		m_shape.addDimension(1);
@@ -93,6 +142,8 @@ TensorAccess::pointer Tensor::getAccess(accessType type) {
 void Tensor::free(ExecutionDevice::pointer device) {
     if(device->isHost()) {
         m_data.reset();
+        m_externalData = nullptr;
+        m_externalDataOwner.reset();
     } else {
         auto clDevice = std::dynamic_pointer_cast<OpenCLDevice>(device);
         delete mCLBuffers[clDevice];
@@ -103,6 +154,8 @@ void Tensor::free(ExecutionDevice::pointer device) {
 
 void Tensor::freeAll() {
     m_data.reset();
+    m_externalData = nullptr;
+    m_externalDataOwner.reset();
     for(auto buffer : mCLBuffers) {
         delete buffer.second;
     }
@@ -142,7 +195,7 @@ bool Tensor::isInitialized() {
 }
 
 bool Tensor::hasAnyData() {
-    return m_data.get() != nullptr || mCLBuffers.size() > 0;
+    return getHostDataPointer() != nullptr || mCLBuffers.size() > 0;
 }
 
 void Tensor::updateOpenCLBufferData(OpenCLDevice::pointer device) {
@@ -190,7 +243,7 @@ void Tensor::transferCLBufferFromHost(OpenCLDevice::pointer device) {
 }
 
 void Tensor::transferCLBufferToHost(OpenCLDevice::pointer device) {
-	if(!m_data) {
+	if(getHostDataPointer() == nullptr) {
 		// Must allocate memory for host data
         m_data = make_uninitialized_unique<float[]>(m_shape.getTotalSize());
 	}
@@ -214,7 +267,7 @@ void Tensor::updateHostData() {
         return;
 
     bool updated = false;
-    if(!m_data) {
+    if(getHostDataPointer() == nullptr) {
         // Data is not initialized, do that first
         m_data = make_uninitialized_unique<float[]>(m_shape.getTotalSize());
 
@@ -278,6 +331,8 @@ BoundingBox Tensor::getBoundingBox() const {
 }
 
 float* Tensor::getHostDataPointer() {
+    if(m_externalData != nullptr)
+        return m_externalData;
     return m_data.get();
 }
 
@@ -28,6 +28,23 @@ class FAST_EXPORT Tensor : public SpatialDataObject {
 		 * @param data
 		 */
 		virtual void create(std::initializer_list<float> data);
+        /**
+         * Create a tensor which uses externally owned memory. The data is not copied.
+         * The owner object is kept alive as long as the tensor uses the memory,
+         * and should be the object which owns the data, e.g. a buffer of an inference engine.
+         * @param data
+         * @param shape
+         * @param owner
+         */
+        virtual void create(float* data, TensorShape shape, std::shared_ptr<void> owner);
+        /**
+         * Get a view of element i of the first dimension, e.g. one sample of a batch.
+         * The view has the remaining dimensions as shape and shares memory with this tensor, thus no data is copied.
+         * Changes to this tensor after the view was created, are not tracked by the view.
+         * @param i
+         * @return tensor
+         */
+        virtual SharedPointer<Tensor> getSubTensor(int i);
 		/**
 		 * Add a dimension of size 1 at provided position. -1 is last position.
 		 * @param position
@@ -58,6 +75,9 @@ class FAST_EXPORT Tensor : public SpatialDataObject {
         virtual float* getHostDataPointer();
 
         std::unique_ptr<float[]> m_data;
+        // External data, used instead of m_data if set
+        float* m_externalData = nullptr;
+        std::shared_ptr<void> m_externalDataOwner;
         std::unordered_map<SharedPointer<OpenCLDevice>, cl::Buffer*> mCLBuffers;
         std::unordered_map<SharedPointer<OpenCLDevice>, bool> mCLBuffersIsUpToDate;
         TensorShape m_shape;
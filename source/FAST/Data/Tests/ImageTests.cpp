@@ -1,5 +1,7 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Data/Image.hpp"
+#include "FAST/Data/ImageBufferPool.hpp"
+#include "FAST/Data/ImageStatistics.hpp"
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Tests/DataComparison.hpp"
 #include "FAST/Utility.hpp"
@@ -1482,4 +1484,106 @@ TEST_CASE("createFromImage on 3D image", "[fast][image]") {
     }
 }
 
+TEST_CASE("Image buffers are reused through the buffer pool", "[fast][image][ImageBufferPool]") {
+    // The pool is shared by all tests, thus only count the allocations done here.
+    // The size is not used by any other test, so that no buffers of this size are in the pool already.
+    auto pool = ImageBufferPool::getInstance();
+    const uint64_t hits = pool->getNrOfHits();
+    const uint64_t misses = pool->getNrOfMisses();
+    OpenCLDevice::pointer device = DeviceManager::getInstance()->getOneOpenCLDevice();
+
+    for(int i = 0; i < 5; ++i) {
+        Image::pointer image = Image::New();
+        image->create(67, 31, TYPE_UINT8, 1);
+        {
+            ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+        }
+        {
+            OpenCLImageAccess::pointer access = image->getOpenCLImageAccess(ACCESS_READ, device);
+        }
+        {
+            OpenCLBufferAccess::pointer access = image->getOpenCLBufferAccess(ACCESS_READ, device);
+        }
+    }
 
+    // Host array, OpenCL image and OpenCL buffer is only allocated for the first image
+    CHECK(pool->getNrOfMisses() - misses == 3);
+    CHECK(pool->getNrOfHits() - hits == 12);
+}
+
+TEST_CASE("calculateImageStatistics returns minimum, maximum, sum and histogram for all data types", "[fast][image][ImageStatistics]") {
+    // Odd size to test remainder of vectorized loops and multiple blocks
+    const std::size_t size = 300007;
+    for(DataType type : {TYPE_FLOAT, TYPE_UINT8, TYPE_INT8, TYPE_UINT16, TYPE_INT16}) {
+        void* data = allocateRandomData(size, type);
+        float minimum, maximum;
+        double sum = 0.0;
+        switch(type) {
+            fastSwitchTypeMacro(
+                getMaxAndMinFromData<FAST_TYPE>(data, size, &minimum, &maximum);
+                for(std::size_t i = 0; i < size; ++i)
+                    sum += ((FAST_TYPE*)data)[i];
+            )
+        }
+
+        ImageStatistics statistics = calculateImageStatistics(data, size, type, 16);
+        CHECK(statistics.nrOfElements == size);
+        CHECK(statistics.minimum == Approx(minimum));
+        CHECK(statistics.maximum == Approx(maximum));
+        CHECK(statistics.sum == Approx(sum));
+        CHECK(statistics.getAverage() == Approx(sum / size));
+        REQUIRE(statistics.histogram.size() == 16);
+        uint64_t total = 0;
+        for(auto count : statistics.histogram)
+            total += count;
+        CHECK(total == size);
+        deleteArray(data, type);
+    }
+}
+
+TEST_CASE("calculateAverageIntensity and calculateHistogram on host array", "[fast][image][ImageStatistics]") {
+    const int width = 37;
+    const int height = 23;
+    std::vector<uchar> data(width*height);
+    for(int i = 0; i < width*height; ++i)
+        data[i] = i % 2 == 0 ? 10 : 20;
+    Image::pointer image = Image::New();
+    image->create(width, height, TYPE_UINT8, 1, data.data());
+
+    CHECK(image->calculateMinimumIntensity() == 10);
+    CHECK(image->calculateMaximumIntensity() == 20);
+    CHECK(image->calculateAverageIntensity() == Approx((10.0*426 + 20.0*425) / (width*height)));
+    std::vector<uint64_t> histogram = image->calculateHistogram(2);
+    REQUIRE(histogram.size() == 2);
+    CHECK(histogram[0] == 426);
+    CHECK(histogram[1] == 425);
+
+    // Statistics must be updated when image changes
+    {
+        ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+        ((uchar*)access->get())[0] = 100;
+    }
+    CHECK(image->calculateMaximumIntensity() == 100);
+    CHECK(image->calculateHistogram(2)[1] == 1);
+}
+
+TEST_CASE("Image statistics performance on large volumes", "[fast][image][ImageStatistics][benchmark]") {
+    const std::size_t size = 512*512*512;
+    for(DataType type : {TYPE_FLOAT, TYPE_UINT8, TYPE_INT16}) {
+        void* data = allocateRandomData(size, type);
+        float minimum, maximum;
+        auto start = std::chrono::high_resolution_clock::now();
+        switch(type) {
+            fastSwitchTypeMacro(getMaxAndMinFromData<FAST_TYPE>(data, size, &minimum, &maximum))
+        }
+        std::chrono::duration<double, std::milli> serial = std::chrono::high_resolution_clock::now() - start;
+        start = std::chrono::high_resolution_clock::now();
+        ImageStatistics statistics = calculateImageStatistics(data, size, type);
+        std::chrono::duration<double, std::milli> parallel = std::chrono::high_resolution_clock::now() - start;
+        CHECK(statistics.minimum == Approx(minimum));
+        CHECK(statistics.maximum == Approx(maximum));
+        Reporter::info() << "Data type " << getCTypeAsString(type) << ": serial min/max " << serial.count() << " ms, " <<
+            "calculateImageStatistics min/max/sum " << parallel.count() << " ms" << Reporter::end();
+        deleteArray(data, type);
+    }
+}
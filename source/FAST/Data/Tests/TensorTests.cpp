@@ -0,0 +1,53 @@
+#include <FAST/Testing.hpp>
+#include <FAST/Data/Tensor.hpp>
+
+using namespace fast;
+
+TEST_CASE("Create tensor with external data", "[fast][Tensor]") {
+    auto data = std::make_shared<std::vector<float>>(2*3, 1.0f);
+    auto tensor = Tensor::New();
+    tensor->create(data->data(), TensorShape({2, 3}), data);
+    CHECK(tensor->getShape().getTotalSize() == 6);
+    {
+        auto access = tensor->getAccess(ACCESS_READ_WRITE);
+        // No copy: The tensor writes to the external data
+        CHECK(access->getRawData() == data->data());
+        access->getRawData()[4] = 5.0f;
+    }
+    CHECK((*data)[4] == 5.0f);
+
+    // Tensor keeps the owner alive
+    std::weak_ptr<std::vector<float>> weakData = data;
+    data.reset();
+    CHECK(!weakData.expired());
+    tensor = nullptr;
+    CHECK(weakData.expired());
+}
+
+TEST_CASE("Sub tensor is a view of the parent tensor", "[fast][Tensor]") {
+    auto tensor = Tensor::New();
+    tensor->create(TensorShape({3, 2, 2}));
+    {
+        auto access = tensor->getAccess(ACCESS_READ_WRITE);
+        float* data = access->getRawData();
+        for(int i = 0; i < 12; ++i)
+            data[i] = i;
+    }
+    auto subTensor = tensor->getSubTensor(1);
+    REQUIRE(subTensor->getShape().getDimensions() == 2);
+    CHECK(subTensor->getShape()[0] == 2);
+    CHECK(subTensor->getShape()[1] == 2);
+    {
+        auto access = subTensor->getAccess(ACCESS_READ);
+        auto parentAccess = tensor->getAccess(ACCESS_READ);
+        CHECK(access->getRawData() == parentAccess->getRawData() + 4);
+        CHECK(access->getRawData()[0] == 4.0f);
+        CHECK(access->getRawData()[3] == 7.0f);
+    }
+    CHECK_THROWS(tensor->getSubTensor(3));
+
+    // View keeps the data of the parent alive
+    tensor = nullptr;
+    auto access = subTensor->getAccess(ACCESS_READ);
+    CHECK(access->getRawData()[1] == 5.0f);
+}
@@ -0,0 +1,146 @@
+#include "RingBufferDataChannel.hpp"
+#include <thread>
+
+namespace fast {
+
+void RingBufferDataChannel::addFrame(DataObject::pointer data) {
+    // If stop is signaled, throw an exception to stop the entire computation thread
+    if(m_stopped.load(std::memory_order_acquire))
+        throw ThreadStopped();
+
+    const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+
+    // Wait if buffer is full, first by spinning, then by parking on the condition variable
+    auto isFull = [this, tail]() {
+        return tail - m_head.load(std::memory_order_acquire) >= mMaximumNumberOfFrames;
+    };
+    uint spin = m_spinCount;
+    while(isFull() && spin > 0 && !m_stopped.load(std::memory_order_relaxed)) {
+        --spin;
+        std::this_thread::yield();
+    }
+    if(isFull()) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_producerWaiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while(isFull() && !m_stopped.load())
+            m_notFull.wait(lock);
+        m_producerWaiting.store(false);
+    }
+    if(m_stopped.load(std::memory_order_acquire))
+        throw ThreadStopped();
+
+    m_buffer[tail & m_mask] = std::move(data);
+    m_tail.store(tail + 1, std::memory_order_release);
+
+    // Only take the lock if the consumer is parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_consumerWaiting.load()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_notEmpty.notify_one();
+    }
+}
+
+void RingBufferDataChannel::setConsumer(const ProcessObject* po) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_consumer != nullptr && m_consumer != po)
+        throw Exception("A RingBufferDataChannel can only have a single consumer. Call getOutputPort once for each process object instead.");
+    m_consumer = po;
+}
+
+DataObject::pointer RingBufferDataChannel::getNextDataFrame() {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+
+    // Wait if buffer is empty, first by spinning, then by parking on the condition variable
+    auto isEmpty = [this, head]() {
+        return m_tail.load(std::memory_order_acquire) == head;
+    };
+    uint spin = m_spinCount;
+    while(isEmpty() && spin > 0 && !m_stopped.load(std::memory_order_relaxed)) {
+        --spin;
+        std::this_thread::yield();
+    }
+    if(isEmpty()) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_consumerWaiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while(isEmpty() && !m_stopped.load())
+            m_notEmpty.wait(lock);
+        m_consumerWaiting.store(false);
+    }
+
+    // If stop is signaled, throw an exception to stop the entire computation thread
+    if(m_stopped.load(std::memory_order_acquire))
+        throw ThreadStopped();
+
+    // Get frame next in buffer, moving it out releases the slot's reference to it
+    DataObject::pointer data = std::move(m_buffer[head & m_mask]);
+    m_head.store(head + 1, std::memory_order_release);
+
+    // Only take the lock if the producer is parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_producerWaiting.load()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_notFull.notify_one();
+    }
+
+    return data;
+}
+
+int RingBufferDataChannel::getSize() {
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+    return m_tail.load(std::memory_order_acquire) - head;
+}
+
+void RingBufferDataChannel::setMaximumNumberOfFrames(uint frames) {
+    if(getSize() > 0)
+        throw Exception("Have to call setMaximumNumberOfFrames before executing pipeline");
+    if(frames == 0)
+        throw Exception("Maximum number of frames in RingBufferDataChannel must be larger than 0");
+    mMaximumNumberOfFrames = frames;
+    // Round buffer size up to nearest power of two, so that indices can be masked instead of using modulo
+    uint64_t size = 1;
+    while(size < frames)
+        size <<= 1;
+    m_buffer = std::vector<DataObject::pointer>(size);
+    m_mask = size - 1;
+    m_head = 0;
+    m_tail = 0;
+}
+
+void RingBufferDataChannel::setSpinCount(uint iterations) {
+    m_spinCount = iterations;
+}
+
+void RingBufferDataChannel::stop() {
+    DataChannel::stop();
+    m_stopped.store(true);
+
+    // Since getNextFrame or addFrame might be parked, we need to notify them to stop blocking
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+}
+
+bool RingBufferDataChannel::hasCurrentData() {
+    return getSize() > 0;
+}
+
+DataObject::pointer RingBufferDataChannel::getFrame() {
+    // Consumer thread only, thus the slot at head can't be popped while it is copied
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    if(m_tail.load(std::memory_order_acquire) == head)
+        throw Exception("No frames available in getFrame");
+    return m_buffer[head & m_mask];
+}
+
+RingBufferDataChannel::RingBufferDataChannel() {
+    m_stopped = false;
+    m_consumerWaiting = false;
+    m_producerWaiting = false;
+    m_head = 0;
+    m_tail = 0;
+    setMaximumNumberOfFrames(50);
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <FAST/DataChannels/DataChannel.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <vector>
+
+namespace fast {
+
+/**
+ * A bounded, lock-free single-producer/single-consumer ring buffer data channel.
+ * The producer and consumer only touch their own index in the fast path, and the indices
+ * are placed on separate cache lines to avoid false sharing.
+ * A waiting thread first spins for a number of iterations, and then parks on a condition variable.
+ *
+ * Only one thread may call addFrame and only one thread may call getNextFrame at a time.
+ * This holds for the data channels of streamers, since ProcessObject::getOutputPort creates
+ * one data channel per consumer. It is used on the output data channels of streamers when
+ * streaming mode is PROCESS_ALL_FRAMES. Connecting the same channel to several process objects
+ * is not allowed, and makes setConsumer throw.
+ */
+class FAST_EXPORT RingBufferDataChannel : public DataChannel {
+    FAST_OBJECT(RingBufferDataChannel)
+    public:
+        /**
+         * Add frame to the data channel. This call may block
+         * if the buffer is full.
+         */
+        void addFrame(DataObject::pointer data) override;
+
+        /**
+         * @return the number of frames stored in this DataChannel
+         */
+        int getSize() override;
+
+        /**
+         * Set the maximum nr of frames that can be stored in this data channel
+         */
+        void setMaximumNumberOfFrames(uint frames) override;
+
+        /**
+         * Set how many times a blocked thread checks the buffer before it parks.
+         * 0 means park immediately.
+         */
+        void setSpinCount(uint iterations);
+
+        /**
+         * Register the process object consuming the data of this channel.
+         * Throws if the channel already has a different consumer.
+         */
+        void setConsumer(const ProcessObject* po);
+
+        /**
+         * This will unblock if this DataChannel is currently blocking. Used to stop a pipeline.
+         */
+        void stop() override;
+
+        // TODO consider removing, it is equal to getSize() > 0 atm
+        bool hasCurrentData() override;
+
+        /**
+         * Get current frame, throws if current frame is not available.
+         * Only the consumer thread may call this, as getNextFrame moves the frame out of its slot.
+         * ProcessObject::updateSelf of the consumer calls it on the same thread as getNextFrame.
+         */
+        DataObject::pointer getFrame() override;
+    protected:
+        static constexpr int CACHE_LINE_SIZE = 64;
+
+        // Written by the consumer only
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_head;
+        // Written by the producer only
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_tail;
+        alignas(CACHE_LINE_SIZE) std::atomic<bool> m_stopped;
+        std::atomic<bool> m_consumerWaiting;
+        std::atomic<bool> m_producerWaiting;
+
+        std::vector<DataObject::pointer> m_buffer;
+        uint64_t m_mask;
+        uint mMaximumNumberOfFrames;
+        uint m_spinCount = 4000;
+        const ProcessObject* m_consumer = nullptr;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+
+        DataObject::pointer getNextDataFrame() override;
+        RingBufferDataChannel();
+};
+
+}
@@ -1,5 +1,6 @@
 #include "FAST/DeviceManager.hpp"
 #include "FAST/Exception.hpp"
+#include "FAST/Config.hpp"
 #include <algorithm>
 #ifdef FAST_MODULE_VISUALIZATION
 #include "FAST/Visualization/Window.hpp"
@@ -68,7 +69,8 @@ throw Exception("Not able to get sharegroup");
 DeviceManager* DeviceManager::getInstance() {
     if(mInstance == NULL) {
 #ifdef FAST_MODULE_VISUALIZATION
-        Window::initializeQtApp();
+        if(Config::getVisualization())
+            Window::initializeQtApp();
 #endif
         mInstance = new DeviceManager();
     }
@@ -86,7 +88,10 @@ void DeviceManager::deleteInstance() {
 
 std::vector<OpenCLDevice::pointer> DeviceManager::getDevices(DeviceCriteria criteria, bool enableVisualization) {
     unsigned long * glContext = NULL;
-    if(!isGLInteropEnabled()) {
+    if(!Config::getVisualization()) {
+        // No display, thus no GL context
+        enableVisualization = false;
+    } else if(!isGLInteropEnabled()) {
         enableVisualization = false;
 #ifdef FAST_MODULE_VISUALIZATION
         fast::Window::getMainGLContext(); // Still have to create GL context
@@ -3,6 +3,12 @@
 #include "FAST/Utility.hpp"
 #include <mutex>
 #include <fstream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <sstream>
 #include "FAST/Config.hpp"
 
 #if defined(__APPLE__) || defined(__MACOSX)
@@ -16,14 +22,10 @@
 #endif
 #endif
 
-// Some include files for reading the modification date of files
 #ifdef WIN32
 #include <windows.h>
 #undef min
 #undef max
-#else
-#include <sys/stat.h>
-#include <time.h>
 #endif
 
 namespace fast {
@@ -91,9 +93,6 @@ OpenCLDevice::OpenCLDevice() {
     mIsHost = false;
 }
 
-
-std::mutex buildBinaryMutex; // a global mutex
-
 bool OpenCLDevice::isImageFormatSupported(cl_channel_order order, cl_channel_type type, cl_mem_object_type imageType) {
     std::vector<cl::ImageFormat> formats;
     context.getSupportedImageFormats(CL_MEM_READ_WRITE, imageType, &formats);
@@ -193,57 +192,54 @@ OpenCLDevice::OpenCLDevice(std::vector<cl::Device> devices, unsigned long* OpenG
     }
 }
 
+std::string OpenCLDevice::readSource(std::string filename) {
+    std::string sourceCode = readFile(filename);
+    // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
+    if(isWritingTo3DTexturesSupported())
+        sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
+    return sourceCode;
+}
+
+int OpenCLDevice::addProgram(cl::Program program) {
+    std::lock_guard<std::mutex> lock(m_programMutex);
+    programs.push_back(program);
+    return programs.size()-1;
+}
+
 int OpenCLDevice::createProgramFromSource(std::string filename, std::string buildOptions, bool useCaching) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
     cl::Program program;
     if(useCaching) {
         program = buildProgramFromBinary(filename, buildOptions);
     } else {
-        std::string sourceCode = readFile(filename);
-        // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
-        if(isWritingTo3DTexturesSupported())
-            sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
+        std::string sourceCode = readSource(filename);
         cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
         program = buildSources(source, buildOptions);
     }
-    programs.push_back(program);
-    return programs.size()-1;
+    return addProgram(program);
 }
 
 /**
  * Compile several source files together
  */
 int OpenCLDevice::createProgramFromSource(std::vector<std::string> filenames, std::string buildOptions) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
-    // Do this in a weird way, because the the logical way does not work.
-    std::string sourceCode = readFile(filenames[0]);
-    if(isWritingTo3DTexturesSupported())
-        sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
-    cl::Program::Sources sources(filenames.size(), std::make_pair(sourceCode.c_str(), sourceCode.length()));
-    for(int i = 1; i < filenames.size(); i++) {
-        std::string sourceCode2 = readFile(filenames[i]);
-        // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
-        if(isWritingTo3DTexturesSupported())
-            sourceCode2 = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode2;
-        sources[i] = std::make_pair(sourceCode2.c_str(), sourceCode2.length());
-    }
-
-    cl::Program program = buildSources(sources, buildOptions);
-    programs.push_back(program);
-    return programs.size()-1;
+    std::vector<std::string> sourceCodes;
+    for(auto&& filename : filenames)
+        sourceCodes.push_back(readSource(filename));
+    cl::Program::Sources sources;
+    for(auto&& sourceCode : sourceCodes)
+        sources.push_back(std::make_pair(sourceCode.c_str(), sourceCode.length()));
+
+    return addProgram(buildSources(sources, buildOptions));
 }
 
 int OpenCLDevice::createProgramFromString(std::string code, std::string buildOptions) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
     cl::Program::Sources source(1, std::make_pair(code.c_str(), code.length()));
 
-    cl::Program program = buildSources(source, buildOptions);
-    programs.push_back(program);
-    return programs.size()-1;
+    return addProgram(buildSources(source, buildOptions));
 }
 
 cl::Program OpenCLDevice::getProgram(unsigned int i) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
+    std::lock_guard<std::mutex> lock(m_programMutex);
     return programs.at(i);
 }
 
@@ -273,6 +269,9 @@ cl::Program OpenCLDevice::buildSources(cl::Program::Sources source, std::string
     // Make program of the source code in the context
     cl::Program program = cl::Program(context, source);
 
+    // Kernels can include other kernel files relative to the kernel source path
+    buildOptions += " -I \"" + Config::getKernelSourcePath() + "\"";
+
     // Build program for the context devices
     try{
         program.build(devices, buildOptions.c_str());
@@ -294,55 +293,68 @@ RuntimeMeasurementsManager::pointer OpenCLDevice::getRunTimeMeasurementManager()
 }
 
 
-cl::Program OpenCLDevice::writeBinary(std::string filename, std::string buildOptions) {
-    // Build program from source file and store the binary file
-    std::string sourceCode = readFile(filename);
-    // If 3d image writes is supported, append the enable line to all source files (fix error on Intel devices)
-    if(isWritingTo3DTexturesSupported())
-        sourceCode = "#pragma OPENCL EXTENSION cl_khr_3d_image_writes : enable\n\n" + sourceCode;
-
-    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
-    cl::Program program = buildSources(source, buildOptions);
-
-    std::vector<std::size_t> binarySizes;
-    binarySizes = program.getInfo<CL_PROGRAM_BINARY_SIZES>();
+// 64 bit FNV-1a hash. Unlike std::hash, this gives the same result across compilers and runs.
+static uint64_t hashString(const std::string& data, uint64_t hash = 14695981039346656037ULL) {
+    for(unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
 
-    std::vector<std::vector<uchar>> binaries;
-    binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+static std::string toHex(uint64_t value) {
+    std::stringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << value;
+    return stream.str();
+}
 
-    std::string deviceName = getDevice(0).getInfo<CL_DEVICE_NAME>();
-    std::size_t hash = std::hash<std::string>{}(buildOptions + deviceName);
-    std::string binaryPath = Config::getKernelBinaryPath();
-    // TODO fix this for both install and build
+std::string OpenCLDevice::getCacheFilename(std::string filename, std::string key, std::string extension) {
+    // Keep the directory structure of the kernel source path in the cache, to make it human readable
     std::string kernelSourcePath = Config::getKernelSourcePath();
-    std::string binaryFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".bin";
-    std::string cacheFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".cache";
-
-    // Create directories if they don't exist
-    if(binaryFilename.rfind("/") != std::string::npos) {
-        std::string directoryPath = binaryFilename.substr(0, binaryFilename.rfind("/"));
-//        QDir dir(directoryPath.c_str());
-//        if (!dir.exists()) {
-//            dir.mkpath(".");
-//        }
-        createDirectories(directoryPath);
+    std::string name = filename;
+    if(filename.compare(0, kernelSourcePath.size(), kernelSourcePath) == 0) {
+        name = filename.substr(kernelSourcePath.size());
+    } else if(filename.find_last_of("/\\") != std::string::npos) {
+        name = filename.substr(filename.find_last_of("/\\") + 1);
     }
-    FILE * file = fopen(binaryFilename.c_str(), "wb");
+    return Config::getKernelBinaryPath() + name + "_" + toHex(hashString(key)) + extension;
+}
+
+// Write to a temporary file first, then move it in place, so that other threads or processes
+// never read a partially written file.
+static void writeFileAtomically(std::string filename, const char* data, std::size_t size) {
+    if(filename.find_last_of("/\\") != std::string::npos)
+        createDirectories(filename.substr(0, filename.find_last_of("/\\")));
+    std::string temporaryFilename = filename + "." +
+            std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "." +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+    FILE * file = fopen(temporaryFilename.c_str(), "wb");
     if(!file)
-        throw Exception("Could not write kernel binary to file: " + binaryFilename);
-    fwrite(binaries[0].data(), sizeof(char), (int)binarySizes[0], file);
+        throw Exception("Could not write to file: " + temporaryFilename);
+    const bool success = fwrite(data, sizeof(char), size, file) == size;
     fclose(file);
+    if(!success) {
+        std::remove(temporaryFilename.c_str());
+        throw Exception("Could not write to file: " + temporaryFilename);
+    }
+#ifdef WIN32
+    if(!MoveFileExA(temporaryFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if(std::rename(temporaryFilename.c_str(), filename.c_str()) != 0) {
+#endif
+        std::remove(temporaryFilename.c_str());
+        throw Exception("Could not move file " + temporaryFilename + " to " + filename);
+    }
+}
 
-    // Write cache file
-    FILE * cacheFile = fopen(cacheFilename.c_str(), "w");
-    std::string timeStr = getModifiedDate(filename);
-    std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-    timeStr += "-" + devices[0].getInfo<CL_DEVICE_NAME>() + "\n";
-    timeStr += "-" + buildOptions;
-    fwrite(timeStr.c_str(), sizeof(char), timeStr.size(), cacheFile);
-    fclose(cacheFile);
+void OpenCLDevice::writeBinary(cl::Program program, std::string binaryFilename) {
+    std::vector<std::size_t> binarySizes;
+    binarySizes = program.getInfo<CL_PROGRAM_BINARY_SIZES>();
 
-    return program;
+    std::vector<std::vector<uchar>> binaries;
+    binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+
+    writeFileAtomically(binaryFilename, (const char*)binaries[0].data(), binarySizes[0]);
 }
 
 cl::Program OpenCLDevice::readBinary(std::string filename) {
@@ -367,94 +379,176 @@ cl::Program OpenCLDevice::readBinary(std::string filename) {
     return program;
 }
 
-cl::Program OpenCLDevice::buildProgramFromBinary(std::string filename, std::string buildOptions) {
-    cl::Program program;
+// Append the contents of the files included by the source code, and the files they include, to the key.
+// Includes are resolved relative to the kernel source path, like when the program is built.
+static void appendIncludedSources(const std::string& sourceCode, std::string& key, std::set<std::string>& included) {
+    std::istringstream stream(sourceCode);
+    std::string line;
+    while(std::getline(stream, line)) {
+        const std::size_t position = line.find_first_not_of(" \t");
+        if(position == std::string::npos || line.compare(position, 8, "#include") != 0)
+            continue;
+        const std::size_t start = line.find_first_of("\"<", position + 8);
+        if(start == std::string::npos)
+            continue;
+        const std::size_t end = line.find(line[start] == '"' ? '"' : '>', start + 1);
+        if(end == std::string::npos)
+            continue;
+        const std::string filename = Config::getKernelSourcePath() + line.substr(start + 1, end - start - 1);
+        if(!included.insert(filename).second || !fileExists(filename))
+            continue;
+        const std::string includedSourceCode = readFile(filename);
+        key += '\0' + filename + '\0' + includedSourceCode;
+        appendIncludedSources(includedSourceCode, key, included);
+    }
+}
 
-    std::string deviceName = getDevice(0).getInfo<CL_DEVICE_NAME>();
-    std::size_t hash = std::hash<std::string>{}(buildOptions + deviceName);
-    std::string binaryPath = Config::getKernelBinaryPath();
-    std::string kernelSourcePath = Config::getKernelSourcePath();
-    std::string binaryFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".bin";
-    std::string cacheFilename = binaryPath + filename.substr(kernelSourcePath.size()) + "_" + std::to_string(hash) + ".cache";
+cl::Program OpenCLDevice::buildProgramFromBinary(std::string filename, std::string buildOptions) {
+    const std::string sourceCode = readSource(filename);
+
+    // The binary is identified by everything which affects the compiled result
+    cl::Device device = getDevice(0);
+    std::string key = sourceCode;
+    std::set<std::string> included;
+    appendIncludedSources(sourceCode, key, included);
+    key += '\0' + buildOptions;
+    key += '\0' + device.getInfo<CL_DEVICE_NAME>();
+    key += '\0' + device.getInfo<CL_DEVICE_VERSION>();
+    key += '\0' + device.getInfo<CL_DRIVER_VERSION>();
+    key += '\0' + platform.getInfo<CL_PLATFORM_VERSION>();
+    const std::string binaryFilename = getCacheFilename(filename, key, ".bin");
 
-    // Check if a binary file exists
-    std::ifstream binaryFile(binaryFilename.c_str(), std::ios_base::binary | std::ios_base::in);
-    if(binaryFile.fail()) {
-        program = writeBinary(filename, buildOptions);
-    } else {
-        // Compare modified dates of binary file and source file
-
-        // Read cache file
-        std::ifstream cacheFile(cacheFilename.c_str());
-        std::string cache(
-            std::istreambuf_iterator<char>(cacheFile),
-            (std::istreambuf_iterator<char>()));
-
-        bool outOfDate = true;
-        bool wrongDeviceID = true;
-        bool buildOptionsChanged = true;
-        const size_t pos = cache.find("-");
-        const size_t pos2 = cache.find("-", pos+1);
-        if(pos != std::string::npos && pos2 != std::string::npos) {
-            // Get modification date of file
-            #ifdef WIN32
-            HANDLE hFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
-            FILETIME ftCreate, ftAccess, ftWrite;
-			SYSTEMTIME sysTime;
-            GetFileTime(hFile, &ftCreate, &ftAccess, &ftWrite);
-			FileTimeToSystemTime(&ftWrite, &sysTime);
-			char* buffer = new char[255];
-			sprintf(buffer, "%d%d%d%d%d", sysTime.wYear, sysTime.wMonth, sysTime.wDay, sysTime.wHour,sysTime.wMinute,sysTime.wSecond);
-			outOfDate = strcmp(buffer, cache.substr(0, pos).c_str()) != 0;
-			delete[] buffer;
-            #else
-            struct stat attrib; // create a file attribute structure
-            stat(filename.c_str(), &attrib);
-            outOfDate = strcmp(ctime(&(attrib.st_mtime)), cache.substr(0, pos).c_str()) != 0;
-            #endif
-            std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-            wrongDeviceID = cache.substr(pos+1, pos2-pos-2) != devices[0].getInfo<CL_DEVICE_NAME>();
-            buildOptionsChanged = cache.substr(pos2+1) != buildOptions;
+    cl::Program program;
+    bool loaded = false;
+    if(fileExists(binaryFilename)) {
+        try {
+            program = readBinary(binaryFilename);
+            loaded = true;
+        } catch(cl::Error &error) {
+            reportWarning() << "Kernel binary " << binaryFilename << " could not be loaded (" <<
+                getCLErrorString(error.err()) << "). Compiling..." << reportEnd();
         }
+    } else {
+        reportInfo() << "No kernel binary found for " << filename << ". Compiling..." << reportEnd();
+    }
 
-        if(outOfDate || wrongDeviceID || buildOptionsChanged) {
-            Reporter::warning() << "Kernel binary " << filename.substr(kernelSourcePath.size()) << " is out of date. Compiling..." << Reporter::end();
-            program = writeBinary(filename, buildOptions);
-        } else {
-            //std::cout << "Binary is not out of date." << std::endl;
-            program = readBinary(binaryFilename);
+    try {
+        if(!loaded) {
+            cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+            program = buildSources(source, buildOptions);
+            writeBinary(program, binaryFilename);
         }
+        addCachedBuildOptions(filename, buildOptions);
+    } catch(Exception &e) {
+        // The program is still usable, even if the cache could not be written
+        reportWarning() << e.what() << reportEnd();
     }
 
     return program;
 }
 
+static std::mutex buildOptionsMutex;
+// Warm up builds the program with all cached build options, thus only keep the most recently used ones
+static const int maxNrOfCachedBuildOptions = 16;
+
+void OpenCLDevice::addCachedBuildOptions(std::string filename, std::string buildOptions) {
+    std::lock_guard<std::mutex> lock(buildOptionsMutex);
+    std::vector<std::string> allBuildOptions = getCachedBuildOptions(filename);
+    if(!allBuildOptions.empty() && allBuildOptions.back() == buildOptions)
+        return;
+    // Move the build options last, so that the least recently used are removed first
+    allBuildOptions.erase(std::remove(allBuildOptions.begin(), allBuildOptions.end(), buildOptions), allBuildOptions.end());
+    allBuildOptions.push_back(buildOptions);
+    if(allBuildOptions.size() > maxNrOfCachedBuildOptions)
+        allBuildOptions.erase(allBuildOptions.begin(), allBuildOptions.end() - maxNrOfCachedBuildOptions);
+    std::string content;
+    for(auto&& options : allBuildOptions)
+        content += options + "\n";
+    writeFileAtomically(getCacheFilename(filename, getName(), ".options"), content.c_str(), content.size());
+}
+
+std::vector<std::string> OpenCLDevice::getCachedBuildOptions(std::string filename) {
+    std::vector<std::string> allBuildOptions;
+    std::ifstream file(getCacheFilename(filename, getName(), ".options"));
+    std::string line;
+    while(std::getline(file, line)) {
+        if(std::find(allBuildOptions.begin(), allBuildOptions.end(), line) == allBuildOptions.end())
+            allBuildOptions.push_back(line);
+    }
+    return allBuildOptions;
+}
+
+int OpenCLDevice::createProgramWithName(std::string programName, std::function<cl::Program()> buildFunction) {
+    std::promise<void> built;
+    {
+        std::unique_lock<std::mutex> lock(m_programMutex);
+        if(programNames.count(programName) > 0)
+            return programNames[programName];
+        if(m_programsBeingBuilt.count(programName) > 0) {
+            // Another thread is building this program, wait for it to finish
+            std::shared_future<void> future = m_programsBeingBuilt[programName];
+            lock.unlock();
+            future.get(); // Rethrows build errors
+            lock.lock();
+            return programNames.at(programName);
+        }
+        m_programsBeingBuilt[programName] = built.get_future().share();
+    }
+
+    cl::Program program;
+    try {
+        program = buildFunction();
+    } catch(...) {
+        std::lock_guard<std::mutex> lock(m_programMutex);
+        m_programsBeingBuilt.erase(programName);
+        built.set_exception(std::current_exception());
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(m_programMutex);
+    programs.push_back(program);
+    programNames[programName] = programs.size()-1;
+    m_programsBeingBuilt.erase(programName);
+    built.set_value();
+    return programNames[programName];
+}
+
 int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::string filename,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromSource(filename,buildOptions);
-    return programNames[programName];
+    return createProgramWithName(programName, [=]() {
+        return buildProgramFromBinary(filename, buildOptions);
+    });
 }
 
 int OpenCLDevice::createProgramFromSourceWithName(
         std::string programName,
         std::vector<std::string> filenames,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromSource(filenames,buildOptions);
-    return programNames[programName];
+    return createProgramWithName(programName, [=]() {
+        std::vector<std::string> sourceCodes;
+        for(auto&& filename : filenames)
+            sourceCodes.push_back(readSource(filename));
+        cl::Program::Sources sources;
+        for(auto&& sourceCode : sourceCodes)
+            sources.push_back(std::make_pair(sourceCode.c_str(), sourceCode.length()));
+        return buildSources(sources, buildOptions);
+    });
 }
 
 int OpenCLDevice::createProgramFromStringWithName(
         std::string programName,
         std::string code,
         std::string buildOptions) {
-    programNames[programName] = createProgramFromString(code,buildOptions);
-    return programNames[programName];
+    return createProgramWithName(programName, [=]() {
+        cl::Program::Sources source(1, std::make_pair(code.c_str(), code.length()));
+        return buildSources(source, buildOptions);
+    });
 }
 
 cl::Program OpenCLDevice::getProgram(std::string name) {
-    std::lock_guard<std::mutex> lock(buildBinaryMutex);
+    std::lock_guard<std::mutex> lock(m_programMutex);
     if(programNames.count(name) == 0) {
         std::string msg ="Could not find OpenCL program with the name" + name;
         throw Exception(msg.c_str(), __LINE__, __FILE__);
@@ -467,6 +561,7 @@ cl::Program OpenCLDevice::getProgram(std::string name) {
 }
 
 bool OpenCLDevice::hasProgram(std::string name) {
+    std::lock_guard<std::mutex> lock(m_programMutex);
     return programNames.count(name) > 0;
 }
 
@@ -3,6 +3,9 @@
 
 #include "FAST/Object.hpp"
 #include "RuntimeMeasurementManager.hpp"
+#include <functional>
+#include <future>
+#include <mutex>
 
 namespace fast {
 
@@ -71,6 +74,16 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         cl::CommandQueue getCommandQueue();
         cl::Device getDevice();
 
+        /**
+         * Build a program from a source file. If caching is enabled, the program binary is stored in the
+         * kernel binary path, using a hash of the source code, the files it includes, build options,
+         * device and driver version as key. Thus, the binary is reused as long as none of these change.
+         *
+         * @param filename
+         * @param buildOptions
+         * @param caching
+         * @return program id
+         */
         int createProgramFromSource(std::string filename, std::string buildOptions = "", bool caching = true);
         int createProgramFromSource(std::vector<std::string> filenames, std::string buildOptions = "");
         int createProgramFromString(std::string code, std::string buildOptions = "");
@@ -80,6 +93,14 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         cl::Program getProgram(unsigned int i);
         cl::Program getProgram(std::string name);
         bool hasProgram(std::string name);
+        /**
+         * Get the build options which the given source file has previously been built with
+         * on this device, according to the kernel binary cache.
+         *
+         * @param filename
+         * @return list of build options
+         */
+        std::vector<std::string> getCachedBuildOptions(std::string filename);
 
         bool isImageFormatSupported(cl_channel_order order, cl_channel_type type, cl_mem_object_type imageType);
 
@@ -103,10 +124,19 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
     private:
         OpenCLDevice();
         unsigned long * mGLContext;
-        cl::Program writeBinary(std::string filename, std::string buildOptions);
+        std::string readSource(std::string filename);
+        std::string getCacheFilename(std::string filename, std::string key, std::string extension);
+        void writeBinary(cl::Program program, std::string binaryFilename);
         cl::Program readBinary(std::string filename);
         cl::Program buildProgramFromBinary(std::string filename, std::string buildOptions);
         cl::Program buildSources(cl::Program::Sources source, std::string buildOptions);
+        void addCachedBuildOptions(std::string filename, std::string buildOptions);
+        int addProgram(cl::Program program);
+        /**
+         * Build program with the given function and add it with a name. If the program is already
+         * being built by another thread, wait for it instead of building it again.
+         */
+        int createProgramWithName(std::string programName, std::function<cl::Program()> buildFunction);
 
         cl::Context context;
         std::vector<cl::CommandQueue> queues;
@@ -114,6 +144,9 @@ class FAST_EXPORT  OpenCLDevice : public ExecutionDevice {
         std::vector<cl::Program> programs;
         std::vector<cl::Device> devices;
         cl::Platform platform;
+        // Protects programs and program names. Programs are built without holding this lock.
+        std::mutex m_programMutex;
+        std::map<std::string, std::shared_future<void>> m_programsBeingBuilt;
 
         bool profilingEnabled;
         RuntimeMeasurementsManager::pointer runtimeManager;
@@ -1,6 +1,7 @@
 #include "MetaImageExporter.hpp"
 #include "FAST/Data/Image.hpp"
 #include <fstream>
+#include <algorithm>
 #include <zlib.h>
 
 namespace fast {
@@ -17,40 +18,96 @@ MetaImageExporter::MetaImageExporter() {
     mUseCompression = false;
 }
 
+// Size of uncompressed chunks which are compressed in parallel
+static const std::size_t compressionChunkSize = 4 << 20;
+
+/**
+ * Compress data in chunks in parallel and write it to file as one zlib stream, thus it can be read by any zlib reader.
+ * Each chunk is deflated independently and ends with a full flush, which makes it possible to also inflate the
+ * chunks in parallel when the compressed size of each chunk is known.
+ * Returns the compressed size of each chunk.
+ */
+static std::vector<std::size_t> writeCompressed(FILE* file, const Bytef* data, std::size_t size) {
+    const int nrOfChunks = std::max<std::size_t>(1, (size + compressionChunkSize - 1) / compressionChunkSize);
+    std::vector<std::unique_ptr<Bytef[]>> compressedChunks(nrOfChunks);
+    std::vector<std::size_t> compressedSizes(nrOfChunks);
+    std::vector<uLong> checksums(nrOfChunks);
+    std::vector<int> results(nrOfChunks, Z_OK);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfChunks; ++i) {
+        const std::size_t offset = i*compressionChunkSize;
+        const std::size_t chunkSize = std::min(compressionChunkSize, size - offset);
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        // Negative window bits gives a raw deflate stream without zlib header and checksum
+        results[i] = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        if(results[i] != Z_OK)
+            continue;
+        // Room for the flush marker in addition to the bound
+        const std::size_t bound = deflateBound(&stream, chunkSize) + 16;
+        compressedChunks[i] = std::unique_ptr<Bytef[]>(new Bytef[bound]);
+        stream.next_in = (Bytef*)data + offset;
+        stream.avail_in = chunkSize;
+        stream.next_out = compressedChunks[i].get();
+        stream.avail_out = bound;
+        // Full flush resets the compression state, thus the next chunk doesn't depend on this one
+        const bool lastChunk = i == nrOfChunks - 1;
+        const int z_result = deflate(&stream, lastChunk ? Z_FINISH : Z_FULL_FLUSH);
+        if((lastChunk && z_result != Z_STREAM_END) || (!lastChunk && (z_result != Z_OK || stream.avail_in > 0))) {
+            results[i] = z_result == Z_OK ? Z_BUF_ERROR : z_result;
+        }
+        compressedSizes[i] = bound - stream.avail_out;
+        deflateEnd(&stream);
+        checksums[i] = adler32(adler32(0L, Z_NULL, 0), data + offset, chunkSize);
+    }
+    for(int result : results) {
+        switch(result) {
+            case Z_OK:
+                break;
+            case Z_MEM_ERROR:
+                throw Exception("Out of memory while compressing raw file");
+            case Z_BUF_ERROR:
+                throw Exception("Output buffer was not large enough while compressing raw file");
+            default:
+                throw Exception("Error compressing raw file");
+        }
+    }
+
+    // zlib header: deflate with 32K window and default compression
+    const Bytef header[2] = {0x78, 0x9C};
+    fwrite(header, 1, 2, file);
+    uLong checksum = adler32(0L, Z_NULL, 0);
+    for(int i = 0; i < nrOfChunks; ++i) {
+        fwrite(compressedChunks[i].get(), 1, compressedSizes[i], file);
+        checksum = adler32_combine(checksum, checksums[i], (z_off_t)std::min(compressionChunkSize, size - i*compressionChunkSize));
+    }
+    // zlib trailer: adler32 checksum of the uncompressed data in big endian
+    const Bytef trailer[4] = {(Bytef)(checksum >> 24), (Bytef)(checksum >> 16), (Bytef)(checksum >> 8), (Bytef)checksum};
+    fwrite(trailer, 1, 4, file);
+
+    return compressedSizes;
+}
+
 template <class T>
-inline std::size_t writeToRawFile(std::string filename, T * data, unsigned int numberOfElements, bool useCompression) {
-    // TODO use mapped_file_sink form boost instead
+inline std::size_t writeToRawFile(std::string filename, T * data, std::size_t numberOfElements, bool useCompression, std::vector<std::size_t>& compressedChunkSizes) {
     FILE* file = fopen(filename.c_str(), "wb");
     if(file == NULL) {
         throw Exception("Could not open file " + filename + " for writing");
     }
     std::size_t returnSize;
     if(useCompression) {
-        // Have to allocate enough memory for compression: 1.1*DATA_SIZE_IN_BYTES + 12
-        std::size_t sizeDataCompressed = compressBound(sizeof(T)*numberOfElements);
-        std::size_t sizeDataOriginal = sizeof(T)*numberOfElements;
-        Bytef* writeData = (Bytef*)malloc(sizeDataCompressed);
-        int z_result = compress(
-                (Bytef*)writeData,
-                (uLongf*)&sizeDataCompressed,
-                (Bytef*)data,
-                sizeDataOriginal
-        );
-        switch(z_result) {
-        case Z_OK:
-            break;
-        case Z_MEM_ERROR:
-            throw Exception("Out of memory while compressing raw file");
-            break;
-        case Z_BUF_ERROR:
-            throw Exception("Output buffer was not large enough while compressing raw file");
-            break;
+        try {
+            compressedChunkSizes = writeCompressed(file, (const Bytef*)data, sizeof(T)*numberOfElements);
+        } catch(Exception&) {
+            fclose(file);
+            throw;
         }
-        // sizeDataCompressed was changed after compress call
-        fwrite(writeData, sizeDataCompressed, 1, file);
-        returnSize = sizeDataCompressed;
+        returnSize = 2 + 4; // zlib header and trailer
+        for(auto size : compressedChunkSizes)
+            returnSize += size;
         fclose(file);
-        free(writeData);
     } else {
         returnSize = sizeof(T)*numberOfElements;
         fwrite(data, sizeof(T), numberOfElements, file);
@@ -113,38 +170,43 @@ void MetaImageExporter::execute() {
         extension = ".zraw";
     }
     std::string rawFilename = mFilename.substr(0,mFilename.length()-4) + extension;
-    const unsigned int numberOfElements = input->getWidth()*input->getHeight()*
-            input->getDepth()*input->getNrOfChannels();
+    const std::size_t numberOfElements = input->getNrOfVoxels()*input->getNrOfChannels();
 
     ImageAccess::pointer access = input->getImageAccess(ACCESS_READ);
     void* data = access->get();
     std::size_t compressedSize;
+    std::vector<std::size_t> compressedChunkSizes;
     switch(input->getDataType()) {
     case TYPE_FLOAT:
         mhdFile << "ElementType = MET_FLOAT\n";
-        compressedSize = writeToRawFile<float>(rawFilename,(float*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<float>(rawFilename,(float*)data,numberOfElements,mUseCompression,compressedChunkSizes);
         break;
     case TYPE_UINT8:
         mhdFile << "ElementType = MET_UCHAR\n";
-        compressedSize = writeToRawFile<uchar>(rawFilename,(uchar*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<uchar>(rawFilename,(uchar*)data,numberOfElements,mUseCompression,compressedChunkSizes);
         break;
     case TYPE_INT8:
         mhdFile << "ElementType = MET_CHAR\n";
-        compressedSize = writeToRawFile<char>(rawFilename,(char*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<char>(rawFilename,(char*)data,numberOfElements,mUseCompression,compressedChunkSizes);
         break;
     case TYPE_UINT16:
         mhdFile << "ElementType = MET_USHORT\n";
-        compressedSize = writeToRawFile<ushort>(rawFilename,(ushort*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<ushort>(rawFilename,(ushort*)data,numberOfElements,mUseCompression,compressedChunkSizes);
         break;
     case TYPE_INT16:
         mhdFile << "ElementType = MET_SHORT\n";
-        compressedSize = writeToRawFile<short>(rawFilename,(short*)data,numberOfElements,mUseCompression);
+        compressedSize = writeToRawFile<short>(rawFilename,(short*)data,numberOfElements,mUseCompression,compressedChunkSizes);
         break;
     }
 
     if(mUseCompression) {
         mhdFile << "CompressedData = True" << "\n";
         mhdFile << "CompressedDataSize = " << compressedSize << "\n";
+        // Layout of the compressed data, used by the MetaImageImporter to decompress in parallel
+        mhdFile << "CompressedDataChunks = " << compressionChunkSize;
+        for(auto size : compressedChunkSizes)
+            mhdFile << " " << size;
+        mhdFile << "\n";
     }
 
     // Add metadata
@@ -5,9 +5,17 @@
 #include "VTKMeshFileExporter.hpp"
 #include "MetaImageExporter.hpp"
 #include <FAST/Utility.hpp>
+#include <fstream>
+#include <algorithm>
 
 namespace fast {
 
+static uint64_t getFileSize(std::string filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if(!file.is_open())
+        return 0;
+    return (uint64_t)file.tellg();
+}
 
 void StreamToFileExporter::setPath(std::string path) {
     m_path = path;
@@ -58,34 +66,209 @@ void StreamToFileExporter::execute() {
     if(m_frameCounter >= m_frameLimit)
         throw Exception("Maximum nr of frames (" + std::to_string(m_frameLimit) + ") reached in StreamToFileExporter");
 
-    std::string currentFileName = join(m_path, m_currentFolder, m_filename + "_" + std::to_string(m_frameCounter));
-    if(auto imageInput = std::dynamic_pointer_cast<Image>(input)) {
+    if(!std::dynamic_pointer_cast<Image>(input) && !std::dynamic_pointer_cast<Mesh>(input))
+        throw Exception("StreamToFileExporter can only handle Image and Mesh data objects");
+
+    WriteTask task;
+    task.data = input;
+    task.filename = join(m_path, m_currentFolder, m_filename + "_" + std::to_string(m_frameCounter));
+    task.compress = true;
+    if(m_queueSize == 0) {
+        writeFrame(task);
+    } else {
+        queueFrame(std::move(task));
+    }
+    m_frameCounter += 1;
+    addOutputData(0, input);
+
+    // Make sure the entire recording is on disk when the stream ends
+    if(input->isLastFrame())
+        flush();
+}
+
+void StreamToFileExporter::writeFrame(const WriteTask& task) {
+    uint64_t bytes = 0;
+    if(std::dynamic_pointer_cast<Image>(task.data)) {
         auto exporter = MetaImageExporter::New();
-        exporter->enableCompression();
-        exporter->setFilename(currentFileName + ".mhd");
-        exporter->setInputData(input);
+        exporter->setCompression(task.compress);
+        exporter->setFilename(task.filename + ".mhd");
+        exporter->setInputData(task.data);
         exporter->update();
-    } else if(auto meshInput = std::dynamic_pointer_cast<Mesh>(input)) {
+        bytes = getFileSize(task.filename + ".mhd") + getFileSize(task.filename + (task.compress ? ".zraw" : ".raw"));
+    } else {
         auto exporter = VTKMeshFileExporter::New();
-        exporter->setFilename(currentFileName + ".vtk");
-        exporter->setInputData(input);
+        exporter->setFilename(task.filename + ".vtk");
+        exporter->setInputData(task.data);
         exporter->update();
-    } else {
-        throw Exception("StreamToFileExporter can only handle Image and Mesh data objects");
+        bytes = getFileSize(task.filename + ".vtk");
     }
-    m_frameCounter += 1;
-    addOutputData(0, input);
+    m_bytesWritten += bytes;
+}
+
+void StreamToFileExporter::queueFrame(WriteTask task) {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    if(!m_writeError.empty()) {
+        std::string error = m_writeError;
+        m_writeError.clear();
+        throw Exception("Failed to write frame in StreamToFileExporter: " + error);
+    }
+    if(m_writerThreads.empty()) {
+        m_stopWriters = false;
+        for(uint i = 0; i < m_nrOfWriterThreads; ++i)
+            m_writerThreads.push_back(std::thread(&StreamToFileExporter::writerLoop, this));
+    }
+
+    if(m_queue.size() >= m_queueSize) {
+        switch(m_queueFullPolicy) {
+            case QueueFullPolicy::BLOCK:
+                m_frameDequeued.wait(lock, [this]() { return m_queue.size() < m_queueSize; });
+                break;
+            case QueueFullPolicy::DROP_OLDEST:
+                m_queue.pop_front();
+                m_droppedFrames += 1;
+                break;
+            case QueueFullPolicy::SPILL_UNCOMPRESSED:
+                // Skipping compression is much cheaper than waiting for the writer threads
+                lock.unlock();
+                task.compress = false;
+                writeFrame(task);
+                return;
+        }
+    }
+    m_queue.push_back(std::move(task));
+    m_peakQueueSize = std::max(m_peakQueueSize, (uint)m_queue.size());
+    lock.unlock();
+    m_frameQueued.notify_one();
+}
+
+void StreamToFileExporter::writerLoop() {
+    while(true) {
+        WriteTask task;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_frameQueued.wait(lock, [this]() { return m_stopWriters || !m_queue.empty(); });
+            // Remaining frames are written before the writers stop
+            if(m_queue.empty())
+                return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+            ++m_framesBeingWritten;
+        }
+        m_frameDequeued.notify_all();
+
+        try {
+            writeFrame(task);
+        } catch(std::exception& e) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if(m_writeError.empty())
+                m_writeError = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            --m_framesBeingWritten;
+        }
+        m_frameDequeued.notify_all();
+    }
+}
+
+void StreamToFileExporter::flush() {
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_frameDequeued.wait(lock, [this]() { return m_queue.empty() && m_framesBeingWritten == 0; });
+    if(!m_writeError.empty()) {
+        std::string error = m_writeError;
+        m_writeError.clear();
+        throw Exception("Failed to write frame in StreamToFileExporter: " + error);
+    }
+}
+
+void StreamToFileExporter::stopWriters() {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopWriters = true;
+    }
+    m_frameQueued.notify_all();
+    for(auto& thread : m_writerThreads)
+        thread.join();
+    m_writerThreads.clear();
+}
+
+void StreamToFileExporter::setWriteBehind(uint queueSize, uint nrOfThreads) {
+    if(nrOfThreads == 0)
+        throw Exception("Nr of writer threads in StreamToFileExporter must be at least 1");
+    stopWriters();
+    m_queueSize = queueSize;
+    m_nrOfWriterThreads = nrOfThreads;
+}
+
+void StreamToFileExporter::setQueueFullPolicy(QueueFullPolicy policy) {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_queueFullPolicy = policy;
+}
+
+uint StreamToFileExporter::getNrOfQueuedFrames() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_queue.size();
+}
+
+uint StreamToFileExporter::getPeakNrOfQueuedFrames() {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_peakQueueSize;
+}
+
+uint64_t StreamToFileExporter::getBytesWritten() const {
+    return m_bytesWritten;
+}
+
+uint64_t StreamToFileExporter::getNrOfDroppedFrames() const {
+    return m_droppedFrames;
+}
+
+StreamToFileExporter::~StreamToFileExporter() {
+    stopWriters();
 }
 
 void StreamToFileExporter::reset() {
+    flush();
     m_frameCounter = 0;
+    m_bytesWritten = 0;
+    m_droppedFrames = 0;
+    m_peakQueueSize = 0;
     m_currentFolder = "";
     m_hasStarted = false;
 }
 
 StreamToFileExporter::StreamToFileExporter() {
+    m_bytesWritten = 0;
+    m_droppedFrames = 0;
     createInputPort<DataObject>(0);
     createOutputPort<DataObject>(0);
+
+    createStringAttribute("path", "Path", "Path to store recordings in", m_path);
+    createStringAttribute("folder", "Folder", "Name of recording folder. If empty, the current date and time is used", m_folder);
+    createStringAttribute("frame-filename", "Frame filename", "Filename of each frame, the frame number is added to it", m_filename);
+    createIntegerAttribute("frame-limit", "Frame limit", "Maximum nr of frames to store", m_frameLimit);
+    createIntegerAttribute("write-behind-queue-size", "Write-behind queue size", "Maximum nr of frames waiting to be written by background threads. 0 writes each frame before forwarding it", m_queueSize);
+    createIntegerAttribute("write-behind-threads", "Write-behind threads", "Nr of threads writing frames in the background", m_nrOfWriterThreads);
+    createStringAttribute("queue-full-policy", "Queue full policy", "What to do when the write-behind queue is full: block, drop-oldest or spill-uncompressed", "block");
+}
+
+void StreamToFileExporter::loadAttributes() {
+    setPath(getStringAttribute("path"));
+    setRecordingFolderName(getStringAttribute("folder"));
+    setFrameFilename(getStringAttribute("frame-filename"));
+    setFrameLimit(getIntegerAttribute("frame-limit"));
+    setWriteBehind(getIntegerAttribute("write-behind-queue-size"), getIntegerAttribute("write-behind-threads"));
+    std::string policy = getStringAttribute("queue-full-policy");
+    if(policy == "block") {
+        setQueueFullPolicy(QueueFullPolicy::BLOCK);
+    } else if(policy == "drop-oldest") {
+        setQueueFullPolicy(QueueFullPolicy::DROP_OLDEST);
+    } else if(policy == "spill-uncompressed") {
+        setQueueFullPolicy(QueueFullPolicy::SPILL_UNCOMPRESSED);
+    } else {
+        throw Exception("Unknown queue full policy " + policy + " given to StreamToFileExporter");
+    }
 }
 
 bool StreamToFileExporter::isEnabled() {
@@ -2,12 +2,32 @@
 
 #include <FAST/ProcessObject.hpp>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
 
 namespace fast {
 
+/**
+ * Stores a stream of images or meshes to disk, one file per frame, and forwards the input.
+ *
+ * Images are stored as compressed metaimages (.mhd), meshes as VTK files (.vtk).
+ * With write-behind enabled, frames are put in a bounded queue and written by a set of
+ * writer threads, so that compression and disk I/O does not stall the pipeline.
+ */
 class FAST_EXPORT StreamToFileExporter : public ProcessObject {
     FAST_OBJECT(StreamToFileExporter)
     public:
+        /**
+         * What to do with a new frame when the write-behind queue is full
+         */
+        enum class QueueFullPolicy {
+            BLOCK,              // Wait until a writer thread has taken a frame from the queue
+            DROP_OLDEST,        // Discard the oldest frame in the queue, its file is never written
+            SPILL_UNCOMPRESSED, // Write the frame immediately, without compression
+        };
         void setPath(std::string path);
         void setRecordingFolderName(std::string folder);
         void setFrameFilename(std::string name);
@@ -18,9 +38,49 @@ class FAST_EXPORT StreamToFileExporter : public ProcessObject {
         float getRecordingDuration() const;
         void reset();
         bool isEnabled();
+        void loadAttributes() override;
+        /**
+         * Write frames in the background. Frames are put in a queue and written by a set of writer threads,
+         * while the input is forwarded immediately.
+         *
+         * @param queueSize Maximum nr of frames waiting to be written. 0 disables write-behind, which is the default.
+         * @param nrOfThreads Nr of writer threads
+         */
+        void setWriteBehind(uint queueSize, uint nrOfThreads = 1);
+        /**
+         * Set what to do when the write-behind queue is full. Default is to block.
+         */
+        void setQueueFullPolicy(QueueFullPolicy policy);
+        /**
+         * Block until all queued frames have been written
+         */
+        void flush();
+        /**
+         * @return nr of frames currently waiting in the write-behind queue
+         */
+        uint getNrOfQueuedFrames();
+        /**
+         * @return largest nr of frames which have been waiting in the write-behind queue at the same time
+         */
+        uint getPeakNrOfQueuedFrames();
+        uint64_t getBytesWritten() const;
+        /**
+         * @return nr of frames discarded because the write-behind queue was full
+         */
+        uint64_t getNrOfDroppedFrames() const;
+        ~StreamToFileExporter();
     private:
+        struct WriteTask {
+            DataObject::pointer data;
+            std::string filename;
+            bool compress;
+        };
         StreamToFileExporter();
         void execute() override;
+        void writeFrame(const WriteTask& task);
+        void queueFrame(WriteTask task);
+        void writerLoop();
+        void stopWriters();
 
         std::string m_path = "";
         std::string m_folder;
@@ -31,6 +91,21 @@ class FAST_EXPORT StreamToFileExporter : public ProcessObject {
         std::chrono::high_resolution_clock::time_point m_recordingStartTime;
         bool m_enabled = true;
         bool m_hasStarted = false;
+
+        uint m_queueSize = 0;
+        uint m_nrOfWriterThreads = 1;
+        QueueFullPolicy m_queueFullPolicy = QueueFullPolicy::BLOCK;
+        std::deque<WriteTask> m_queue;
+        std::vector<std::thread> m_writerThreads;
+        std::mutex m_queueMutex;
+        std::condition_variable m_frameQueued;
+        std::condition_variable m_frameDequeued;
+        uint m_framesBeingWritten = 0;
+        uint m_peakQueueSize = 0;
+        bool m_stopWriters = false;
+        std::string m_writeError;
+        std::atomic<uint64_t> m_bytesWritten;
+        std::atomic<uint64_t> m_droppedFrames;
 };
 
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "FAST/Importers/MetaImageImporter.hpp"
 #include "FAST/Data/Image.hpp"
 #include "FAST/Tests/DataComparison.hpp"
+#include <cstring>
 
 using namespace fast;
 
@@ -339,3 +340,113 @@ TEST_CASE("Write a compressed 3D image with the MetaImageExporter", "[fast][Meta
         }
     }
 }
+
+TEST_CASE("Write and read a 3D float image larger than 4 GB with the MetaImageExporter", "[.][fast][MetaImageExporter][large]") {
+    const uint width = 2048;
+    const uint height = 2048;
+    const uint depth = 260;
+
+    Image::pointer image = Image::New();
+    image->create(width, height, depth, TYPE_FLOAT, 1);
+    REQUIRE(image->getNrOfVoxels()*sizeof(float) > ((std::size_t)1 << 32));
+    {
+        ImageAccess::pointer access = image->getImageAccess(ACCESS_READ_WRITE);
+        for(std::size_t i = 0; i < image->getNrOfVoxels(); ++i)
+            access->setScalarFast<float>(i, (float)(i % 1000));
+    }
+
+    MetaImageExporter::pointer exporter = MetaImageExporter::New();
+    exporter->setFilename("MetaImageExporterTestLarge.mhd");
+    exporter->setInputData(image);
+    exporter->update();
+
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename("MetaImageExporterTestLarge.mhd");
+    importer->setMainDevice(Host::getInstance());
+    DataChannel::pointer port = importer->getOutputPort();
+    importer->update();
+    Image::pointer image2 = port->getNextFrame<Image>();
+
+    CHECK(image2->getWidth() == width);
+    CHECK(image2->getHeight() == height);
+    CHECK(image2->getDepth() == depth);
+    CHECK(image2->getNrOfVoxels() == image->getNrOfVoxels());
+
+    // Check voxels on both sides of the 2^32 byte boundary
+    ImageAccess::pointer access = image2->getImageAccess(ACCESS_READ);
+    for(std::size_t position : {(std::size_t)0, ((std::size_t)1 << 30) - 1, (std::size_t)1 << 30, image->getNrOfVoxels() - 1}) {
+        CHECK(access->getScalarFast<float>(position) == (float)(position % 1000));
+        CHECK(access->getScalar(position) == (float)(position % 1000));
+    }
+    CHECK(access->getScalar(Vector3i(width - 1, height - 1, depth - 1)) == (float)((image->getNrOfVoxels() - 1) % 1000));
+    float min = image2->calculateMinimumIntensity();
+    float max = image2->calculateMaximumIntensity();
+    CHECK(min == 0.0f);
+    CHECK(max == 999.0f);
+}
+
+TEST_CASE("Write and read a compressed 3D image of several chunks with the MetaImageExporter", "[fast][MetaImageExporter]") {
+    // Larger than the compression chunk size, and not a multiple of it
+    const uint width = 256;
+    const uint height = 256;
+    const uint depth = 37;
+    Image::pointer image = Image::New();
+    void* data = allocateRandomData(width*height*depth, TYPE_FLOAT);
+    image->create(width, height, depth, TYPE_FLOAT, 1, Host::getInstance(), data);
+
+    MetaImageExporter::pointer exporter = MetaImageExporter::New();
+    exporter->setFilename("MetaImageExporterTestChunks.mhd");
+    exporter->setInputData(image);
+    exporter->setCompression(true);
+    exporter->update();
+
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename("MetaImageExporterTestChunks.mhd");
+    auto port = importer->getOutputPort();
+    importer->update();
+    Image::pointer image2 = port->getNextFrame<Image>();
+
+    CHECK(image2->getDepth() == depth);
+    CHECK(image2->getMetadata().count("CompressedDataChunks") == 0);
+    ImageAccess::pointer access = image2->getImageAccess(ACCESS_READ);
+    CHECK(compareDataArrays(data, access->get(), width*height*depth, TYPE_FLOAT) == true);
+    deleteArray(data, TYPE_FLOAT);
+}
+
+TEST_CASE("Writing to a memory mapped image from the MetaImageImporter does not change the file", "[fast][MetaImageExporter]") {
+    const uint width = 128;
+    const uint height = 128;
+    const uint depth = 32;
+    Image::pointer image = Image::New();
+    void* data = allocateRandomData(width*height*depth, TYPE_UINT16);
+    image->create(width, height, depth, TYPE_UINT16, 1, Host::getInstance(), data);
+
+    MetaImageExporter::pointer exporter = MetaImageExporter::New();
+    exporter->setFilename("MetaImageExporterTestMapped.mhd");
+    exporter->setInputData(image);
+    exporter->update();
+
+    {
+        MetaImageImporter::pointer importer = MetaImageImporter::New();
+        importer->setFilename("MetaImageExporterTestMapped.mhd");
+        importer->setMemoryMapping(true);
+        auto port = importer->getOutputPort();
+        importer->update();
+        Image::pointer image2 = port->getNextFrame<Image>();
+        ImageAccess::pointer access = image2->getImageAccess(ACCESS_READ_WRITE);
+        CHECK(compareDataArrays(data, access->get(), width*height*depth, TYPE_UINT16) == true);
+        std::memset(access->get(), 0, width*height*depth*sizeof(ushort));
+        access->release();
+        CHECK(image2->calculateMaximumIntensity() == 0.0f);
+    }
+
+    // The file still has the original data
+    MetaImageImporter::pointer importer = MetaImageImporter::New();
+    importer->setFilename("MetaImageExporterTestMapped.mhd");
+    auto port = importer->getOutputPort();
+    importer->update();
+    Image::pointer image3 = port->getNextFrame<Image>();
+    ImageAccess::pointer access = image3->getImageAccess(ACCESS_READ);
+    CHECK(compareDataArrays(data, access->get(), width*height*depth, TYPE_UINT16) == true);
+    deleteArray(data, TYPE_UINT16);
+}
@@ -0,0 +1,99 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Exporters/StreamToFileExporter.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/Utility.hpp"
+#include <chrono>
+
+using namespace fast;
+
+TEST_CASE("StreamToFileExporter with write-behind writes all frames", "[fast][StreamToFileExporter]") {
+    auto exporter = StreamToFileExporter::New();
+    exporter->setPath(".");
+    exporter->setRecordingFolderName("StreamToFileExporterWriteBehindTest");
+    exporter->setWriteBehind(4, 2);
+    exporter->setQueueFullPolicy(StreamToFileExporter::QueueFullPolicy::BLOCK);
+
+    std::vector<uchar> data(64*64);
+    for(int frame = 0; frame < 10; ++frame) {
+        std::fill(data.begin(), data.end(), (uchar)frame);
+        auto image = Image::New();
+        image->create(64, 64, TYPE_UINT8, 1, data.data());
+        exporter->setInputData(image);
+        exporter->update();
+    }
+    exporter->flush();
+
+    CHECK(exporter->getFrameCounter() == 10);
+    CHECK(exporter->getNrOfQueuedFrames() == 0);
+    CHECK(exporter->getPeakNrOfQueuedFrames() <= 4);
+    CHECK(exporter->getNrOfDroppedFrames() == 0);
+    CHECK(exporter->getBytesWritten() > 0);
+    for(int frame = 0; frame < 10; ++frame)
+        CHECK(fileExists(join(exporter->getCurrentDestinationFolder(), "frame_" + std::to_string(frame) + ".mhd")));
+}
+
+// Random data compresses slowly, thus the writer thread can't keep up with frames being added
+static void overrunWriteBehindQueue(StreamToFileExporter::pointer exporter, int frames) {
+    const int size = 1024;
+    std::vector<float> data(size*size);
+    for(auto&& value : data)
+        value = (float)rand() / RAND_MAX;
+    for(int frame = 0; frame < frames; ++frame) {
+        auto image = Image::New();
+        image->create(size, size, TYPE_FLOAT, 1, data.data());
+        exporter->setInputData(image);
+        exporter->update();
+    }
+    exporter->flush();
+}
+
+TEST_CASE("StreamToFileExporter with write-behind drops oldest frames when queue overruns", "[fast][StreamToFileExporter]") {
+    auto exporter = StreamToFileExporter::New();
+    exporter->setPath(".");
+    // Unique folder, so that files from earlier runs are not counted
+    exporter->setRecordingFolderName("StreamToFileExporterDropOldestTest_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()));
+    exporter->setWriteBehind(1, 1);
+    exporter->setQueueFullPolicy(StreamToFileExporter::QueueFullPolicy::DROP_OLDEST);
+    const int frames = 10;
+    overrunWriteBehindQueue(exporter, frames);
+
+    CHECK(exporter->getFrameCounter() == frames);
+    CHECK(exporter->getNrOfQueuedFrames() == 0);
+    CHECK(exporter->getPeakNrOfQueuedFrames() == 1);
+    CHECK(exporter->getNrOfDroppedFrames() > 0);
+    int written = 0;
+    for(int frame = 0; frame < frames; ++frame) {
+        if(fileExists(join(exporter->getCurrentDestinationFolder(), "frame_" + std::to_string(frame) + ".mhd")))
+            ++written;
+    }
+    CHECK(written + exporter->getNrOfDroppedFrames() == frames);
+    // The newest frame is never dropped
+    CHECK(fileExists(join(exporter->getCurrentDestinationFolder(), "frame_" + std::to_string(frames - 1) + ".mhd")));
+}
+
+TEST_CASE("StreamToFileExporter with write-behind spills uncompressed frames when queue overruns", "[fast][StreamToFileExporter]") {
+    auto exporter = StreamToFileExporter::New();
+    exporter->setPath(".");
+    // Unique folder, so that files from earlier runs are not counted
+    exporter->setRecordingFolderName("StreamToFileExporterSpillTest_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()));
+    exporter->setWriteBehind(1, 1);
+    exporter->setQueueFullPolicy(StreamToFileExporter::QueueFullPolicy::SPILL_UNCOMPRESSED);
+    const int frames = 10;
+    overrunWriteBehindQueue(exporter, frames);
+
+    CHECK(exporter->getFrameCounter() == frames);
+    CHECK(exporter->getNrOfQueuedFrames() == 0);
+    CHECK(exporter->getPeakNrOfQueuedFrames() == 1);
+    CHECK(exporter->getNrOfDroppedFrames() == 0);
+    int spilled = 0;
+    for(int frame = 0; frame < frames; ++frame) {
+        const std::string filename = join(exporter->getCurrentDestinationFolder(), "frame_" + std::to_string(frame));
+        CHECK(fileExists(filename + ".mhd"));
+        // Spilled frames are written without compression, the rest are compressed by the writer thread
+        const bool uncompressed = fileExists(filename + ".raw");
+        CHECK(uncompressed != fileExists(filename + ".zraw"));
+        if(uncompressed)
+            ++spilled;
+    }
+    CHECK(spilled > 0);
+}
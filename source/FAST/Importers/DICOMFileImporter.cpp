@@ -4,6 +4,11 @@
 #include <dcmtk/dcmdata/dcdeftag.h>
 #include <dcmtk/dcmimgle/dcmimage.h>
 #include "FAST/Data/Image.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
 
 namespace fast {
 
@@ -29,8 +34,15 @@ static void* readRawData(const DiPixel* pixelData) {
     return outputData;
 }
 
-static DataType getDataType(const DicomImage &image) {
+static const DiPixel* getPixelData(const DicomImage &image) {
     const DiPixel* pixelData = image.getInterData();
+    if(image.getStatus() != EIS_Normal || pixelData == nullptr)
+        throw Exception("Could not get pixel data of DICOM image");
+    return pixelData;
+}
+
+static DataType getDataType(const DicomImage &image) {
+    const DiPixel* pixelData = getPixelData(image);
     EP_Representation rep = pixelData->getRepresentation();
     DataType type;
     switch(rep) {
@@ -55,7 +67,7 @@ static DataType getDataType(const DicomImage &image) {
 }
 
 static void* getDataFromImage(const DicomImage &image, DataType &type) {
-    const DiPixel* pixelData = image.getInterData();
+    const DiPixel* pixelData = getPixelData(image);
     EP_Representation rep = pixelData->getRepresentation();
     void* data;
     switch(rep) {
@@ -84,41 +96,139 @@ static void* getDataFromImage(const DicomImage &image, DataType &type) {
     return data;
 }
 
-static void* inserSliceFromImage(const DicomImage &image, int width, int height, int sliceNr, void* data) {
-    const DiPixel* pixelData = image.getInterData();
-    EP_Representation rep = pixelData->getRepresentation();
-    int currentPosition = width*height*sliceNr;
-    DataType type;
-    void* sliceData;
-    switch(rep) {
-        case EPR_Sint8:
-            type = TYPE_INT8;
-            sliceData = readRawData<char>(pixelData);
-            memcpy((char*)data + currentPosition, sliceData, width*height*getSizeOfDataType(type, 1));
-            break;
-        case EPR_Uint8:
-            type = TYPE_UINT8;
-            sliceData = readRawData<uchar>(pixelData);
-            memcpy((uchar*)data + currentPosition, sliceData, width*height*getSizeOfDataType(type, 1));
-            break;
-        case EPR_Sint16:
-            type = TYPE_INT16;
-            sliceData = readRawData<short>(pixelData);
-            memcpy((short*)data + currentPosition, sliceData, width*height*getSizeOfDataType(type, 1));
-            break;
-        case EPR_Uint16:
-            type = TYPE_UINT16;
-            sliceData = readRawData<ushort>(pixelData);
-            memcpy((ushort*)data + currentPosition, sliceData, width*height*getSizeOfDataType(type, 1));
-            break;
-        case EPR_Sint32:
-        case EPR_Uint32:
-            throw Exception("Unsupported data type of 32 bit integer in DICOMFileImporter");
-            break;
+/**
+ * The meta data of a DICOM file needed to group and sort the slices of a series
+ */
+struct DICOMSliceHeader {
+    std::string filename;
+    std::string seriesID;
+    int instanceNumber = 0;
+    bool hasPosition = false;
+    Vector3f position;
+    Vector3f rowDirection;
+    Vector3f columnDirection;
+    float sliceLocation = 0;
+};
+
+/**
+ * Read the meta data of a DICOM file, without loading the pixel data
+ * @return false if the file is not a DICOM file with a series instance UID
+ */
+static bool readSliceHeader(const std::string& filename, DICOMSliceHeader& header) {
+    DcmFileFormat fileformat;
+    // Parsing stops at the pixel data, which is always the last large element
+    OFCondition status = fileformat.loadFileUntilTag(filename.c_str(), EXS_Unknown, EGL_noChange, DCM_MaxReadLength, ERM_autoDetect, DCM_PixelData);
+    if(status.bad())
+        return false;
+    DcmDataset* dataset = fileformat.getDataset();
+    OFString seriesID;
+    if(!dataset->findAndGetOFString(DCM_SeriesInstanceUID, seriesID).good())
+        return false;
+    header.filename = filename;
+    header.seriesID = seriesID.c_str();
+    Sint32 instanceNumber = 0;
+    dataset->findAndGetSint32(DCM_InstanceNumber, instanceNumber);
+    header.instanceNumber = instanceNumber;
+
+    Float64 values[9];
+    header.hasPosition = true;
+    for(int i = 0; i < 3; ++i)
+        header.hasPosition = header.hasPosition && dataset->findAndGetFloat64(DCM_ImagePositionPatient, values[i], i).good();
+    for(int i = 0; i < 6; ++i)
+        header.hasPosition = header.hasPosition && dataset->findAndGetFloat64(DCM_ImageOrientationPatient, values[3 + i], i).good();
+    if(header.hasPosition) {
+        header.position = Vector3f(values[0], values[1], values[2]);
+        header.rowDirection = Vector3f(values[3], values[4], values[5]);
+        header.columnDirection = Vector3f(values[6], values[7], values[8]);
     }
-    deleteArray(sliceData, type);
+    return true;
+}
 
-    return data;
+struct DICOMDirectoryIndex {
+    // Name, size and modification time of each file in the directory
+    std::vector<std::string> files;
+    std::vector<DICOMSliceHeader> headers;
+};
+static std::mutex seriesIndexCacheMutex;
+// DicomImage uses global state in DCMTK which is not thread safe, thus only one can be created or destroyed at a time
+static std::mutex dicomImageMutex;
+static std::unordered_map<std::string, DICOMDirectoryIndex> seriesIndexCache;
+
+static std::string getFileSignature(const std::string& filename) {
+    struct stat info;
+    if(stat(filename.c_str(), &info) != 0)
+        return filename;
+    return filename + ":" + std::to_string((long long)info.st_size) + ":" + std::to_string((long long)info.st_mtime);
+}
+
+/**
+ * Read the headers of all DICOM files in a directory in parallel
+ */
+static std::vector<DICOMSliceHeader> readDirectoryHeaders(const std::string& dirName, bool useCache) {
+    std::vector<std::string> files = getDirectoryList(dirName);
+    std::sort(files.begin(), files.end());
+    std::vector<std::string> fileSignatures;
+    if(useCache) {
+        for(auto&& file : files)
+            fileSignatures.push_back(getFileSignature(join(dirName, file)));
+        std::lock_guard<std::mutex> lock(seriesIndexCacheMutex);
+        auto it = seriesIndexCache.find(dirName);
+        // The index is only valid if no files have been added, removed or changed
+        if(it != seriesIndexCache.end() && it->second.files == fileSignatures)
+            return it->second.headers;
+    }
+
+    std::vector<DICOMSliceHeader> allHeaders(files.size());
+    std::vector<char> isDICOM(files.size(), 0);
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < (int)files.size(); ++i)
+        isDICOM[i] = readSliceHeader(join(dirName, files[i]), allHeaders[i]);
+
+    std::vector<DICOMSliceHeader> headers;
+    for(int i = 0; i < (int)files.size(); ++i) {
+        if(isDICOM[i])
+            headers.push_back(std::move(allHeaders[i]));
+    }
+
+    if(useCache) {
+        std::lock_guard<std::mutex> lock(seriesIndexCacheMutex);
+        seriesIndexCache[dirName] = {fileSignatures, headers};
+    }
+    return headers;
+}
+
+/**
+ * Sort slices along the slice normal using ImagePositionPatient and ImageOrientationPatient.
+ * If some slices are missing these tags, the slices are sorted by InstanceNumber instead.
+ * @return true if the slices were sorted by position
+ */
+static bool sortSlices(std::vector<DICOMSliceHeader>& slices) {
+    bool usePosition = true;
+    for(auto&& slice : slices)
+        usePosition = usePosition && slice.hasPosition;
+
+    if(usePosition) {
+        const Vector3f normal = slices[0].rowDirection.cross(slices[0].columnDirection);
+        for(auto&& slice : slices)
+            slice.sliceLocation = normal.dot(slice.position);
+        std::stable_sort(slices.begin(), slices.end(), [](const DICOMSliceHeader& a, const DICOMSliceHeader& b) {
+            return a.sliceLocation < b.sliceLocation;
+        });
+    } else {
+        std::stable_sort(slices.begin(), slices.end(), [](const DICOMSliceHeader& a, const DICOMSliceHeader& b) {
+            return a.instanceNumber < b.instanceNumber;
+        });
+    }
+    return usePosition;
+}
+
+void DICOMFileImporter::clearSeriesIndexCache() {
+    std::lock_guard<std::mutex> lock(seriesIndexCacheMutex);
+    seriesIndexCache.clear();
+}
+
+void DICOMFileImporter::setSeriesIndexCaching(bool cache) {
+    mCacheSeriesIndex = cache;
 }
 
 void DICOMFileImporter::execute() {
@@ -126,7 +236,8 @@ void DICOMFileImporter::execute() {
         throw Exception("DICOMFileImporter needs filename to be set");
 
     DcmFileFormat fileformat;
-    OFCondition status = fileformat.loadFile(mFilename.c_str());
+    // Only the meta data is needed here, the pixel data is read by DicomImage
+    OFCondition status = fileformat.loadFileUntilTag(mFilename.c_str(), EXS_Unknown, EGL_noChange, DCM_MaxReadLength, ERM_autoDetect, DCM_PixelData);
     if(status.good()) {
         Image::pointer output = getOutputData<Image>();
         // Get pixel spacing
@@ -142,44 +253,66 @@ void DICOMFileImporter::execute() {
             if(!fileformat.getDataset()->findAndGetOFString(DCM_SeriesInstanceUID, seriesID).good())
                 throw Exception("Could not get series instance UID of DICOM file.");
 
-            // Get all files in directory which has same series instance UID
-            std::string dirName = getDirName(mFilename);
-            std::vector<std::string> files = getDirectoryList(dirName);
-            std::vector<std::string> seriesFiles;
-            for(auto&& file : files) {
-                OFString seriesID2;
-                DcmFileFormat fileformat2;
-                OFCondition status = fileformat2.loadFile((dirName + "/" + file).c_str());
-                fileformat2.getDataset()->findAndGetOFString(DCM_SeriesInstanceUID, seriesID2);
-                if(seriesID == seriesID2) {
-                    seriesFiles.push_back(dirName + "/" + file);
-                }
+            // Get all files in directory which has same series instance UID, by only reading their headers
+            std::vector<DICOMSliceHeader> slices;
+            for(auto&& header : readDirectoryHeaders(getDirName(mFilename), mCacheSeriesIndex)) {
+                if(header.seriesID == seriesID.c_str())
+                    slices.push_back(header);
+            }
+            if(slices.empty())
+                throw Exception("Could not find any slices of the DICOM series of " + mFilename);
+            if(sortSlices(slices) && slices.size() > 1) {
+                // Use the distance between the slices, as slice thickness can be different from it
+                spacingZ = std::fabs(slices.back().sliceLocation - slices.front().sliceLocation) / (slices.size() - 1);
             }
 
             // Get size and type of image
-            DicomImage image(mFilename.c_str());
-            const int width = image.getWidth();
-            const int height = image.getHeight();
-            const int depth = seriesFiles.size();
-            const DataType type = getDataType(image);
-
-			std::cout << "DEPTH: " << depth << std::endl;
-            // Allocate space for volume
-            void* data = allocateDataArray(width*height*depth, type, 1);
-
-            // Get data of each slice
-            for(auto&& file : seriesFiles) {
-                DcmFileFormat fileformat2;
-                OFCondition status = fileformat2.loadFile(file.c_str());
-                Sint32 sliceNr;
-                fileformat2.getDataset()->findAndGetSint32(DCM_InstanceNumber, sliceNr);
-                inserSliceFromImage(DicomImage(file.c_str()), width, height, sliceNr-1, data);
+            uint width, height;
+            DataType type;
+            EP_Representation representation;
+            {
+                std::lock_guard<std::mutex> lock(dicomImageMutex);
+                DicomImage image(mFilename.c_str());
+                if(image.getStatus() != EIS_Normal)
+                    throw Exception("Error: cannot read DICOM image " + mFilename);
+                width = image.getWidth();
+                height = image.getHeight();
+                type = getDataType(image);
+                representation = getPixelData(image)->getRepresentation();
             }
+            const int depth = slices.size();
+            const std::size_t sliceSize = (std::size_t)width*height*getSizeOfDataType(type, 1);
 
-            output->create(image.getWidth(), image.getHeight(), seriesFiles.size(), type, 1, data);
+            // Read the slice files in parallel and copy the slices directly into the volume.
+            // Decoding and the modality transform are done by DicomImage, thus one slice at a time.
+            auto data = allocatePixelArray((std::size_t)width*height*depth, type);
+            std::string failedFilename;
+            #pragma omp parallel for schedule(dynamic)
+            for(int i = 0; i < depth; ++i) {
+                DcmFileFormat sliceFile;
+                std::unique_ptr<DicomImage> slice;
+                if(sliceFile.loadFile(slices[i].filename.c_str()).good()) {
+                    std::lock_guard<std::mutex> lock(dicomImageMutex);
+                    slice = std::make_unique<DicomImage>(&sliceFile, sliceFile.getDataset()->getOriginalXfer());
+                }
+                const DiPixel* pixelData = slice ? slice->getInterData() : nullptr;
+                if(!slice || slice->getStatus() != EIS_Normal || pixelData == nullptr || slice->getWidth() != width ||
+                        slice->getHeight() != height || pixelData->getRepresentation() != representation) {
+                    #pragma omp critical
+                    failedFilename = slices[i].filename;
+                } else {
+                    std::memcpy((uchar*)data.get() + i*sliceSize, pixelData->getData(), sliceSize);
+                }
+                std::lock_guard<std::mutex> lock(dicomImageMutex);
+                slice.reset();
+            }
+            if(!failedFilename.empty())
+                throw Exception("Slice " + failedFilename + " does not match the size and type of the DICOM series");
+
+            output->create(Vector3ui(width, height, depth), type, 1, std::move(data));
             output->setSpacing(spacingX, spacingY, spacingZ);
-            deleteArray(data, type);
         } else {
+            std::lock_guard<std::mutex> lock(dicomImageMutex);
             DicomImage image(mFilename.c_str());
             DataType type;
             void* data = getDataFromImage(image, type);
@@ -6,16 +6,32 @@
 
 namespace fast {
 
+/**
+ * Import a DICOM image, or the entire series of 2D images in the same directory as a 3D image.
+ *
+ * To find the series, only the headers of the files in the directory are read. The slices are
+ * sorted by ImagePositionPatient, or by InstanceNumber if positions are missing. The slice files are
+ * read in parallel, but decoding is serial, as DicomImage in DCMTK is not thread safe.
+ */
 class FAST_EXPORT DICOMFileImporter : public Importer {
     FAST_OBJECT(DICOMFileImporter)
     public:
         void setFilename(std::string filename);
         void setLoadSeries(bool load);
+        /**
+         * Keep the headers of all files of a directory in memory, so that the directory is not scanned
+         * again when another series in it is loaded. The index is rebuilt if files are added, removed or changed.
+         *
+         * @param cache
+         */
+        void setSeriesIndexCaching(bool cache);
+        static void clearSeriesIndexCache();
     private:
         DICOMFileImporter();
         void execute() override;
 
         bool mLoadSeries = true;
+        bool mCacheSeriesIndex = false;
         std::string mFilename = "";
 };
 
@@ -4,6 +4,15 @@
 #include "FAST/Utility.hpp"
 #include <fstream>
 #include <set>
+#include <limits>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include <zlib.h>
 using namespace fast;
@@ -13,6 +22,11 @@ void MetaImageImporter::setFilename(std::string filename) {
     mIsModified = true;
 }
 
+void MetaImageImporter::setMemoryMapping(bool memoryMapping) {
+    m_memoryMapping = memoryMapping;
+    mIsModified = true;
+}
+
 MetaImageImporter::MetaImageImporter() {
     mFilename = "";
     mIsModified = true;
@@ -38,8 +52,156 @@ std::vector<std::string> stringSplit(std::string str, std::string delimiter) {
     return values;
 }
 
+// Inflate a zlib stream (raw = false) or a raw deflate stream (raw = true) of any size
+static void inflateData(Bytef* source, std::size_t sourceSize, Bytef* destination, std::size_t destinationSize, bool raw) {
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = source;
+    stream.avail_in = 0;
+    if(inflateInit2(&stream, raw ? -MAX_WBITS : MAX_WBITS) != Z_OK)
+        throw Exception("Failed to initialize zlib while decompressing raw file");
+
+    // avail_in and avail_out are 32 bit, so large data has to be fed in several steps
+    const std::size_t maxStep = std::numeric_limits<uInt>::max();
+    std::size_t sourceLeft = sourceSize;
+    std::size_t destinationLeft = destinationSize;
+    stream.next_out = destination;
+    stream.avail_out = 0;
+    int z_result;
+    while(true) {
+        if(stream.avail_in == 0) {
+            stream.avail_in = (uInt)std::min(sourceLeft, maxStep);
+            sourceLeft -= stream.avail_in;
+        }
+        if(stream.avail_out == 0) {
+            stream.avail_out = (uInt)std::min(destinationLeft, maxStep);
+            destinationLeft -= stream.avail_out;
+        }
+        z_result = inflate(&stream, Z_NO_FLUSH);
+        if(z_result == Z_BUF_ERROR && stream.avail_in == 0 && sourceLeft == 0) {
+            // All input is consumed. Chunks of a raw deflate stream end with a full flush instead of the end of the stream
+            z_result = Z_OK;
+            break;
+        }
+        if(z_result != Z_OK)
+            break;
+    }
+    const std::size_t decompressedSize = destinationSize - destinationLeft - stream.avail_out;
+    inflateEnd(&stream);
+    switch(z_result) {
+        case Z_OK:
+        case Z_STREAM_END:
+            break;
+        case Z_MEM_ERROR:
+            throw Exception("Out of memory while decompressing raw file");
+        case Z_BUF_ERROR:
+            throw Exception("Output buffer was not large enough while decompressing raw file");
+        default:
+            throw Exception("Compressed data was corrupt while decompressing raw file");
+    }
+    if(decompressedSize != destinationSize)
+        throw Exception("Unexpected size of decompressed raw file. Expected: " + std::to_string(destinationSize) + " got: " + std::to_string(decompressedSize));
+}
+
+/**
+ * Decompress data written in chunks by the MetaImageExporter. The compressed data is one zlib stream
+ * where each chunk of chunkSize bytes is deflated independently and ends with a full flush,
+ * thus the chunks can be inflated in parallel.
+ */
+static void inflateChunks(Bytef* source, std::size_t sourceSize, Bytef* destination, std::size_t destinationSize, std::size_t chunkSize, const std::vector<std::size_t>& compressedChunkSizes) {
+    const int nrOfChunks = compressedChunkSizes.size();
+    std::vector<std::size_t> offsets(nrOfChunks + 1);
+    offsets[0] = 2; // zlib header
+    for(int i = 0; i < nrOfChunks; ++i)
+        offsets[i + 1] = offsets[i] + compressedChunkSizes[i];
+    if(chunkSize == 0 || (destinationSize + chunkSize - 1) / chunkSize != (std::size_t)nrOfChunks || offsets[nrOfChunks] + 4 > sourceSize)
+        throw Exception("Compressed data chunks in MetaImage file does not match the compressed raw file");
+
+    std::vector<uLong> checksums(nrOfChunks);
+    std::vector<std::string> errors(nrOfChunks);
+    #pragma omp parallel for
+    for(int i = 0; i < nrOfChunks; ++i) {
+        const std::size_t size = std::min(chunkSize, destinationSize - i*chunkSize);
+        try {
+            inflateData(source + offsets[i], compressedChunkSizes[i], destination + i*chunkSize, size, true);
+            checksums[i] = adler32(adler32(0L, Z_NULL, 0), destination + i*chunkSize, (uInt)size);
+        } catch(Exception& e) {
+            // Exceptions can't be thrown out of an OpenMP loop
+            errors[i] = e.what();
+        }
+    }
+    for(auto&& error : errors) {
+        if(!error.empty())
+            throw Exception(error);
+    }
+
+    // Verify the adler32 checksum at the end of the zlib stream
+    uLong checksum = adler32(0L, Z_NULL, 0);
+    for(int i = 0; i < nrOfChunks; ++i)
+        checksum = adler32_combine(checksum, checksums[i], (z_off_t)std::min(chunkSize, destinationSize - i*chunkSize));
+    const Bytef* trailer = source + offsets[nrOfChunks];
+    const uLong expectedChecksum = ((uLong)trailer[0] << 24) | ((uLong)trailer[1] << 16) | ((uLong)trailer[2] << 8) | (uLong)trailer[3];
+    if(checksum != expectedChecksum)
+        throw Exception("Checksum mismatch while decompressing raw file");
+}
+
+/**
+ * Memory map a file with copy-on-write. The pages are shared with the file system cache until they are written to,
+ * and writes are never stored in the file. Returns an empty pointer if the file could not be mapped.
+ */
+static unique_pixel_ptr mapFile(std::string filename, std::size_t expectedSize) {
+#ifdef WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        throw FileNotFoundException(filename);
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || (std::size_t)size.QuadPart != expectedSize) {
+        CloseHandle(file);
+        throw Exception("Unexpected file size when opening " + filename + " expected: " + std::to_string(expectedSize) + " got: " + std::to_string(size.QuadPart));
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if(mapping == NULL) {
+        CloseHandle(file);
+        return unique_pixel_ptr(nullptr, pixel_deleter_t());
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, expectedSize);
+    if(data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return unique_pixel_ptr(nullptr, pixel_deleter_t());
+    }
+    return unique_pixel_ptr(data, [file, mapping](void* ptr) {
+        UnmapViewOfFile(ptr);
+        CloseHandle(mapping);
+        CloseHandle(file);
+    });
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd == -1)
+        throw FileNotFoundException(filename);
+    struct stat fileInfo;
+    if(fstat(fd, &fileInfo) == -1 || (std::size_t)fileInfo.st_size != expectedSize) {
+        close(fd);
+        throw Exception("Unexpected file size when opening " + filename + " expected: " + std::to_string(expectedSize) + " got: " + std::to_string(fileInfo.st_size));
+    }
+    void* data = mmap(0, expectedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if(data == MAP_FAILED)
+        return unique_pixel_ptr(nullptr, pixel_deleter_t());
+    return unique_pixel_ptr(data, [expectedSize](void* ptr) {
+        munmap(ptr, expectedSize);
+    });
+#endif
+}
+
+// Small files are faster to read than to map
+static const std::size_t minimumMemoryMappingSize = 1 << 20;
+
 template <class T>
-static std::unique_ptr<T[]> readRawData(std::string rawFilename, std::size_t voxels, unsigned int nrOfComponents, bool compressed, std::size_t compressedFileSize) {
+static std::unique_ptr<T[]> readRawData(std::string rawFilename, std::size_t voxels, unsigned int nrOfComponents, bool compressed, std::size_t compressedFileSize, std::size_t chunkSize, const std::vector<std::size_t>& compressedChunkSizes, bool memoryMapping) {
     auto data = make_uninitialized_unique<T[]>(voxels*nrOfComponents);
     if(compressed) {
         // Read compressed data
@@ -50,39 +212,29 @@ static std::unique_ptr<T[]> readRawData(std::string rawFilename, std::size_t vox
         // Determine the file length
         file.seekg(0, std::ios_base::end);
         std::size_t size = file.tellg();
-        file.seekg(0, std::ios_base::beg);
-
-        auto fileData = make_uninitialized_unique<Bytef[]>(size);
-        file.read((char*)&fileData[0], size);
         file.close();
 
-        unsigned long uncompressedSize = sizeof(T)*voxels*nrOfComponents;
-		int z_result = uncompress(
-            (Bytef*)data.get(),       // destination for the uncompressed
-                                    // data.  This should be the size of
-                                    // the original data, which you should
-                                    // already know.
-
-            (uLongf *)&uncompressedSize,  // length of destination (uncompressed)
-                                    // buffer
-
-            fileData.get(),   // source buffer - the compressed data
-
-            (uLong)compressedFileSize);   // length of compressed data in bytes
-        switch( z_result )
-        {
-        case Z_OK:
-            break;
-
-        case Z_MEM_ERROR:
-            throw Exception("Out of memory while decompressing raw file");
-            break;
+        // Map the compressed file instead of reading it, to avoid an extra copy.
+        // The mapping is only used while decompressing.
+        unique_pixel_ptr fileData(nullptr, pixel_deleter_t());
+        if(memoryMapping)
+            fileData = mapFile(rawFilename, size);
+        if(!fileData) {
+            fileData = allocatePixelArray(size, TYPE_UINT8);
+            file.open(rawFilename, std::ifstream::binary | std::ifstream::in);
+            file.read((char*)fileData.get(), size);
+            file.close();
+        }
 
-        case Z_BUF_ERROR:
-            throw Exception("Output buffer was not large enough while decompressing raw file");
-            break;
+        const std::size_t uncompressedSize = sizeof(T)*voxels*nrOfComponents;
+        if(compressedFileSize == 0 || compressedFileSize > size)
+            compressedFileSize = size;
+        if(compressedChunkSizes.empty()) {
+            // Compressed by another program, inflate as one stream
+            inflateData((Bytef*)fileData.get(), compressedFileSize, (Bytef*)data.get(), uncompressedSize, false);
+        } else {
+            inflateChunks((Bytef*)fileData.get(), compressedFileSize, (Bytef*)data.get(), uncompressedSize, chunkSize, compressedChunkSizes);
         }
-        file.close();
     } else {
         std::ifstream file(rawFilename, std::ifstream::binary | std::ifstream::in);
         if(!file.is_open())
@@ -148,6 +300,8 @@ void MetaImageImporter::execute() {
     Matrix3f transformMatrix = Matrix3f::Identity();
     bool isCompressed = false;
     std::size_t compressedDataSize = 0;
+    std::size_t compressedChunkSize = 0;
+    std::vector<std::size_t> compressedChunkSizes;
     std::unordered_map<std::string, std::string> metadata;
 
     // Blacklist of keys to avoid importing as metadata
@@ -192,7 +346,16 @@ void MetaImageImporter::execute() {
         } else if(key == "CompressedData" && value == "True") {
             isCompressed = true;
         } else if(key == "CompressedDataSize") {
-            compressedDataSize = std::stoi(value);
+            compressedDataSize = std::stoull(value);
+        } else if(key == "CompressedDataChunks") {
+            // Written by the MetaImageExporter: uncompressed chunk size, followed by the compressed size of each chunk
+            std::vector<std::string> values = split(value);
+            values.erase(std::remove(values.begin(), values.end(), ""), values.end());
+            if(values.size() < 2)
+                throw Exception("CompressedDataChunks in MetaImage file must contain at least 2 numbers");
+            compressedChunkSize = std::stoull(values[0]);
+            for(int i = 1; i < values.size(); ++i)
+                compressedChunkSizes.push_back(std::stoull(values[i]));
         } else if(key == "ElementDataFile") {
             rawFilename = value;
             rawFilenameFound = true;
@@ -343,47 +506,71 @@ void MetaImageImporter::execute() {
         throw Exception("Error reading the mhd file", __LINE__, __FILE__);
 
 
-    std::size_t voxels = size.x()*size.y();
+    std::size_t voxels = (std::size_t)size.x()*size.y();
     if(size.size() == 3)
         voxels *= size.z();
-    if(typeName == "MET_SHORT" || typeName == "MET_INT") {
-        std::unique_ptr<short[]> data;
-        if(typeName == "MET_SHORT") {
-            data = std::move(readRawData<short>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize));
-        } else {
-            reportWarning() << "Converting original dataset of type MET_INT (32 bit) to short (16 bit) overflow may occur." << reportEnd();
-            auto tmp = readRawData<int>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize);
-            auto tmp2 = make_uninitialized_unique<short[]>(voxels*nrOfComponents);
-            for(int i = 0; i < voxels*nrOfComponents; ++i)
-                tmp2[i] = (short)tmp[i];
-
-            data = std::move(tmp2);
+    // Types which are used as is, and thus can be memory mapped
+    const std::map<std::string, DataType> mappableTypes = {
+        {"MET_SHORT", TYPE_INT16},
+        {"MET_USHORT", TYPE_UINT16},
+        {"MET_CHAR", TYPE_INT8},
+        {"MET_UCHAR", TYPE_UINT8},
+        {"MET_FLOAT", TYPE_FLOAT},
+    };
+    bool isMapped = false;
+    if(m_memoryMapping && !isCompressed && getMainDevice()->isHost() && mappableTypes.count(typeName) > 0) {
+        const DataType type = mappableTypes.at(typeName);
+        const std::size_t bytes = voxels*getSizeOfDataType(type, nrOfComponents);
+        if(bytes >= minimumMemoryMappingSize) {
+            auto data = mapFile(rawFilename, bytes);
+            if(data) {
+                output->create(size, type, nrOfComponents, std::move(data));
+                isMapped = true;
+            } else {
+                reportWarning() << "Failed to memory map " << rawFilename << ", reading it instead" << reportEnd();
+            }
         }
-        output->create(size,TYPE_INT16,nrOfComponents,getMainDevice(),std::move(data));
+    }
+    if(!isMapped) {
+        if(typeName == "MET_SHORT" || typeName == "MET_INT") {
+            std::unique_ptr<short[]> data;
+            if(typeName == "MET_SHORT") {
+                data = std::move(readRawData<short>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping));
+            } else {
+                reportWarning() << "Converting original dataset of type MET_INT (32 bit) to short (16 bit) overflow may occur." << reportEnd();
+                auto tmp = readRawData<int>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping);
+                auto tmp2 = make_uninitialized_unique<short[]>(voxels*nrOfComponents);
+                for(std::size_t i = 0; i < voxels*nrOfComponents; ++i)
+                    tmp2[i] = (short)tmp[i];
 
-    } else if(typeName == "MET_USHORT" || typeName == "MET_UINT") {
-        std::unique_ptr<ushort[]> data;
-        if(typeName == "MET_USHORT") {
-            data = std::move(readRawData<unsigned short>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize));
-        } else {
-            reportWarning() << "Converting original dataset of type MET_UINT (32 bit) to unsigned short (16 bit) overflow may occur." << reportEnd();
-            auto tmp = readRawData<unsigned int>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize);
-            auto tmp2 = make_uninitialized_unique<ushort[]>(voxels*nrOfComponents);
-            for(int i = 0; i < voxels*nrOfComponents; ++i)
-                tmp2[i] = (unsigned short)tmp[i];
+                data = std::move(tmp2);
+            }
+            output->create(size,TYPE_INT16,nrOfComponents,getMainDevice(),std::move(data));
+
+        } else if(typeName == "MET_USHORT" || typeName == "MET_UINT") {
+            std::unique_ptr<ushort[]> data;
+            if(typeName == "MET_USHORT") {
+                data = std::move(readRawData<unsigned short>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping));
+            } else {
+                reportWarning() << "Converting original dataset of type MET_UINT (32 bit) to unsigned short (16 bit) overflow may occur." << reportEnd();
+                auto tmp = readRawData<unsigned int>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping);
+                auto tmp2 = make_uninitialized_unique<ushort[]>(voxels*nrOfComponents);
+                for(std::size_t i = 0; i < voxels*nrOfComponents; ++i)
+                    tmp2[i] = (unsigned short)tmp[i];
 
-            data = std::move(tmp2);
+                data = std::move(tmp2);
+            }
+            output->create(size,TYPE_UINT16,nrOfComponents,getMainDevice(),std::move(data));
+        } else if(typeName == "MET_CHAR") {
+            auto data = readRawData<char>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping);
+            output->create(size,TYPE_INT8,nrOfComponents,getMainDevice(),std::move(data));
+        } else if(typeName == "MET_UCHAR") {
+            auto data = readRawData<unsigned char>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping);
+            output->create(size,TYPE_UINT8,nrOfComponents,getMainDevice(),std::move(data));
+        } else if(typeName == "MET_FLOAT") {
+            auto data = readRawData<float>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize, compressedChunkSize, compressedChunkSizes, m_memoryMapping);
+            output->create(size,TYPE_FLOAT,nrOfComponents,getMainDevice(),std::move(data));
         }
-        output->create(size,TYPE_UINT16,nrOfComponents,getMainDevice(),std::move(data));
-    } else if(typeName == "MET_CHAR") {
-        auto data = readRawData<char>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize);
-        output->create(size,TYPE_INT8,nrOfComponents,getMainDevice(),std::move(data));
-    } else if(typeName == "MET_UCHAR") {
-        auto data = readRawData<unsigned char>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize);
-        output->create(size,TYPE_UINT8,nrOfComponents,getMainDevice(),std::move(data));
-    } else if(typeName == "MET_FLOAT") {
-        auto data = readRawData<float>(rawFilename, voxels, nrOfComponents, isCompressed, compressedDataSize);
-        output->create(size,TYPE_FLOAT,nrOfComponents,getMainDevice(),std::move(data));
     }
 
     output->setSpacing(spacing);
@@ -9,9 +9,21 @@ class FAST_EXPORT  MetaImageImporter : public Importer {
     FAST_OBJECT(MetaImageImporter)
     public:
         void setFilename(std::string filename);
+        /**
+         * Memory map uncompressed raw files instead of reading them, when the image is put on the host.
+         * The image data then shares memory with the file system cache until it is written to.
+         * Changes to the image are never written to the file. Default is false.
+         * The raw file must not be overwritten or truncated while the image is alive, e.g. by exporting to
+         * the same file with MetaImageExporter, as reading the image will then crash with SIGBUS.
+         * Compressed raw files are mapped only while they are decompressed, thus the image does not depend on them.
+         *
+         * @param memoryMapping
+         */
+        void setMemoryMapping(bool memoryMapping);
     private:
         MetaImageImporter();
         std::string mFilename;
+        bool m_memoryMapping = false;
         void execute();
 };
 
@@ -1,8 +1,12 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Importers/DICOMFileImporter.hpp"
+#include "FAST/Data/Image.hpp"
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
 #include "FAST/Visualization/SliceRenderer/SliceRenderer.hpp"
 #include "FAST/Visualization/SimpleWindow.hpp"
+#include <dcmtk/dcmdata/dcfilefo.h>
+#include <dcmtk/dcmdata/dcdeftag.h>
+#include <chrono>
 
 using namespace fast;
 
@@ -43,3 +47,74 @@ TEST_CASE("Dicom image read 3D", "[DICOM][visual]") {
     CHECK_NOTHROW(window->start());
 
 }
+
+TEST_CASE("Dicom series is the same with and without series index cache", "[DICOM][fast]") {
+    auto importer = DICOMFileImporter::New();
+    importer->setLoadSeries(true);
+    importer->setFilename(Config::getTestDataPath() + "/CT/LIDC-IDRI-0072/000001.dcm");
+    auto image = importer->updateAndGetOutputData<Image>();
+    CHECK(image->getDimensions() == 3);
+    CHECK(image->getDepth() > 1);
+
+    DICOMFileImporter::clearSeriesIndexCache();
+    for(int i = 0; i < 2; ++i) {
+        auto cachedImporter = DICOMFileImporter::New();
+        cachedImporter->setLoadSeries(true);
+        cachedImporter->setSeriesIndexCaching(true);
+        cachedImporter->setFilename(Config::getTestDataPath() + "/CT/LIDC-IDRI-0072/000001.dcm");
+        auto cachedImage = cachedImporter->updateAndGetOutputData<Image>();
+        CHECK(cachedImage->getSize() == image->getSize());
+        CHECK(cachedImage->getSpacing().isApprox(image->getSpacing()));
+        CHECK(cachedImage->calculateAverageIntensity() == Approx(image->calculateAverageIntensity()));
+    }
+    DICOMFileImporter::clearSeriesIndexCache();
+}
+
+// Write a 2x2 slice where pixel (1,0) is the given value. Pixel (0,0) is large, so that all slices get the same type.
+static void writeSlice(std::string filename, float z, int instanceNumber, Uint16 value) {
+    DcmFileFormat file;
+    DcmDataset* dataset = file.getDataset();
+    dataset->putAndInsertString(DCM_SOPClassUID, "1.2.840.10008.5.1.4.1.1.7");
+    dataset->putAndInsertString(DCM_SOPInstanceUID, ("1.2.826.0.1.3680043.2.1125.1." + std::to_string(instanceNumber)).c_str());
+    dataset->putAndInsertString(DCM_SeriesInstanceUID, "1.2.826.0.1.3680043.2.1125.2");
+    dataset->putAndInsertString(DCM_Modality, "OT");
+    dataset->putAndInsertString(DCM_InstanceNumber, std::to_string(instanceNumber).c_str());
+    dataset->putAndInsertString(DCM_ImagePositionPatient, ("0\\0\\" + std::to_string(z)).c_str());
+    dataset->putAndInsertString(DCM_ImageOrientationPatient, "1\\0\\0\\0\\1\\0");
+    dataset->putAndInsertString(DCM_PixelSpacing, "0.5\\0.5");
+    dataset->putAndInsertString(DCM_SliceThickness, "1");
+    dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2");
+    dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1);
+    dataset->putAndInsertUint16(DCM_Rows, 2);
+    dataset->putAndInsertUint16(DCM_Columns, 2);
+    dataset->putAndInsertUint16(DCM_BitsAllocated, 16);
+    dataset->putAndInsertUint16(DCM_BitsStored, 16);
+    dataset->putAndInsertUint16(DCM_HighBit, 15);
+    dataset->putAndInsertUint16(DCM_PixelRepresentation, 0);
+    const Uint16 pixels[4] = {4000, value, 0, 0};
+    dataset->putAndInsertUint16Array(DCM_PixelData, pixels, 4);
+    REQUIRE(file.saveFile(filename.c_str(), EXS_LittleEndianExplicit).good());
+}
+
+TEST_CASE("Dicom series is sorted by position and spaced by the distance between slices", "[DICOM][fast]") {
+    const std::string folder = "DICOMSeriesTest_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    createDirectories(folder);
+    // File names and instance numbers are both in a different order than the positions
+    writeSlice(join(folder, "a.dcm"), 15.0f, 1, 150);
+    writeSlice(join(folder, "b.dcm"), 10.0f, 3, 100);
+    writeSlice(join(folder, "c.dcm"), 12.5f, 2, 125);
+
+    auto importer = DICOMFileImporter::New();
+    importer->setFilename(join(folder, "a.dcm"));
+    auto image = importer->updateAndGetOutputData<Image>();
+    REQUIRE(image->getDimensions() == 3);
+    REQUIRE(image->getDepth() == 3);
+    CHECK(image->getSpacing().x() == Approx(0.5f));
+    CHECK(image->getSpacing().y() == Approx(0.5f));
+    // Distance between the slices, not the slice thickness
+    CHECK(image->getSpacing().z() == Approx(2.5f));
+    auto access = image->getImageAccess(ACCESS_READ);
+    CHECK(access->getScalar(Vector3i(1, 0, 0)) == 100);
+    CHECK(access->getScalar(Vector3i(1, 0, 1)) == 125);
+    CHECK(access->getScalar(Vector3i(1, 0, 2)) == 150);
+}
@@ -34,11 +34,27 @@ cl::Program OpenCLProgram::build(SharedPointer<OpenCLDevice> device,
     if(buildExists(device, buildOptions))
         return mOpenCLPrograms[device][buildOptions];
 
+    return buildWithFinalOptions(device, buildOptions);
+}
+
+cl::Program OpenCLProgram::buildWithFinalOptions(SharedPointer<OpenCLDevice> device, std::string buildOptions) {
     std::string programName = mSourceFilename + buildOptions;
-    // Only create program if it doesn't exist for this device from before
-    if(!device->hasProgram(programName))
-        device->createProgramFromSourceWithName(programName, mSourceFilename, buildOptions);
-    return device->getProgram(programName);
+    // Program is only created if it doesn't exist for this device from before
+    return device->getProgram(device->createProgramFromSourceWithName(programName, mSourceFilename, buildOptions));
+}
+
+void OpenCLProgram::warmUp(SharedPointer<OpenCLDevice> device) {
+    if(mSourceFilename == "")
+        throw Exception("No source filename was given to OpenCLProgram. Therefore build operation is not possible.");
+
+    // The cached build options already include the flags added by build
+    std::vector<std::string> cachedBuildOptions = device->getCachedBuildOptions(mSourceFilename);
+    if(cachedBuildOptions.empty()) {
+        build(device);
+    } else {
+        for(auto&& buildOptions : cachedBuildOptions)
+            buildWithFinalOptions(device, buildOptions);
+    }
 }
 
 OpenCLProgram::OpenCLProgram() {
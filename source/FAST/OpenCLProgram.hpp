@@ -22,9 +22,16 @@ class FAST_EXPORT  OpenCLProgram : public Object {
         void setSourceFilename(std::string filename);
         std::string getSourceFilename() const;
         cl::Program build(SharedPointer<OpenCLDevice>, std::string buildOptions = "");
+        /**
+         * Build this program for the given device with all build options it has been built with before,
+         * according to the kernel binary cache. If it has never been built, the default build options are used.
+         */
+        void warmUp(SharedPointer<OpenCLDevice>);
     protected:
         OpenCLProgram();
 
+        cl::Program buildWithFinalOptions(SharedPointer<OpenCLDevice>, std::string buildOptions);
+
         bool buildExists(SharedPointer<OpenCLDevice>, std::string buildOptions = "") const;
 
         std::string mName;
@@ -3,6 +3,7 @@
 #include "ProcessObject.hpp"
 #include <QDirIterator>
 #include <fstream>
+#include <algorithm>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QLineEdit>
@@ -179,6 +180,7 @@ void Pipeline::parseProcessObject(
 
         if(mProcessObjects.count(inputID) == 0)
             throw Exception("Input with id " + inputID + " was not found before " + objectID);
+        m_connectedProcessObjects.insert(inputID);
 
         if(isRenderer) {
             reportInfo() << "Connected process object " << inputID << " to renderer " << objectID << reportEnd();
@@ -196,12 +198,28 @@ void Pipeline::parseProcessObject(
     }
 }
 
-void Pipeline::parsePipelineFile(std::unordered_map<std::string, SharedPointer<ProcessObject>> processObjects) {
+void Pipeline::skipBlock(int& lineNr) {
+    // Skip the attribute and input lines following an object or view
+    ++lineNr;
+    while(lineNr < m_lines.size()) {
+        std::string line = m_lines[lineNr];
+        trim(line);
+        if(line.empty())
+            break;
+        std::vector<std::string> tokens = split(line);
+        if(tokens[0] != "Attribute" && tokens[0] != "Input")
+            break;
+        ++lineNr;
+    }
+}
+
+void Pipeline::parsePipelineFile(std::unordered_map<std::string, SharedPointer<ProcessObject>> processObjects, bool visualization) {
     // Parse file again, retrieve process objects, set attributes and create the pipeline
 
     mProcessObjects = processObjects;
     mRenderers.clear();
     m_views.clear();
+    m_connectedProcessObjects.clear();
 
     // Retrieve all POs and renderers
     for(int lineNr = 0; lineNr < m_lines.size(); ++lineNr) {
@@ -224,6 +242,10 @@ void Pipeline::parsePipelineFile(std::unordered_map<std::string, SharedPointer<P
             std::string object = tokens[2];
             parseProcessObject(object, id, lineNr);
             lineNr--;
+        } else if(!visualization && (key == "Renderer" || key == "View")) {
+            reportInfo() << "Skipping " << key << " " << tokens.at(1) << " since visualization is disabled" << reportEnd();
+            skipBlock(lineNr);
+            lineNr--;
         } else if(key == "Renderer") {
             if(tokens.size() != 3) {
                 throw Exception("Unable to parse pipeline file " + mFilename + ", expected 3 tokens but got line " + line);
@@ -317,6 +339,23 @@ std::unordered_map<std::string, SharedPointer<ProcessObject>> Pipeline::getProce
     return mProcessObjects;
 }
 
+std::unordered_map<std::string, SharedPointer<ProcessObject>> Pipeline::getSinks() {
+    std::unordered_map<std::string, SharedPointer<ProcessObject>> sinks;
+    for(auto&& processObject : getProcessObjects()) {
+        if(m_connectedProcessObjects.count(processObject.first) == 0 &&
+                std::find(mRenderers.begin(), mRenderers.end(), processObject.first) == mRenderers.end())
+            sinks[processObject.first] = processObject.second;
+    }
+    return sinks;
+}
+
+void Pipeline::warmUp() {
+    std::vector<SharedPointer<ProcessObject>> processObjects;
+    for(auto&& processObject : getProcessObjects())
+        processObjects.push_back(processObject.second);
+    ProcessObject::warmUp(processObjects);
+}
+
 
 PipelineWidget::PipelineWidget(Pipeline pipeline, QWidget* parent) : QToolBox(parent) {
     auto processObjects = pipeline.getProcessObjects();
@@ -23,8 +23,21 @@ class FAST_EXPORT  Pipeline : public Object {
         std::string getFilename() const;
         /**
          * Parse the pipeline file
+         *
+         * @param processObjects
+         * @param visualization If false, renderers and views are skipped, thus the pipeline can run without a display.
          */
-        void parsePipelineFile(std::unordered_map<std::string, SharedPointer<ProcessObject>> processObjects = {});
+        void parsePipelineFile(std::unordered_map<std::string, SharedPointer<ProcessObject>> processObjects = {}, bool visualization = true);
+        /**
+         * Get the process objects which are not input to any other process object or renderer in the parsed pipeline.
+         * These are typically exporters, and are used to drive the pipeline when it is run without a display.
+         */
+        std::unordered_map<std::string, SharedPointer<ProcessObject>> getSinks();
+        /**
+         * Build the OpenCL programs of all process objects in the pipeline in parallel,
+         * to avoid that the first frame stalls while kernels are compiled.
+         */
+        void warmUp();
 
     private:
         std::string mName;
@@ -33,6 +46,8 @@ class FAST_EXPORT  Pipeline : public Object {
         std::unordered_map<std::string, SharedPointer<ProcessObject>> mProcessObjects;
         std::unordered_map<std::string, View*> m_views;
         std::vector<std::string> mRenderers;
+        // Process objects which are connected to another process object or renderer
+        std::unordered_set<std::string> m_connectedProcessObjects;
         std::vector<std::string> m_lines;
 
         void parseProcessObject(
@@ -45,6 +60,7 @@ class FAST_EXPORT  Pipeline : public Object {
                 std::string objectID,
                 int& lineNr
         );
+        void skipBlock(int& lineNr);
 };
 
 /**
@@ -0,0 +1,241 @@
+#include "PipelineScheduler.hpp"
+#include "FAST/Streamers/Streamer.hpp"
+#include <unordered_map>
+#include <algorithm>
+
+namespace fast {
+
+PipelineScheduler::PipelineScheduler() {
+}
+
+PipelineScheduler::~PipelineScheduler() {
+    stop();
+}
+
+void PipelineScheduler::addProcessObject(SharedPointer<ProcessObject> po) {
+    m_processObjects.push_back(po);
+}
+
+void PipelineScheduler::setNumberOfThreads(uint threads) {
+    m_nrOfThreads = threads;
+}
+
+void PipelineScheduler::buildGraph() {
+    m_nodes.clear();
+    m_hasStreamers = false;
+    std::unordered_map<ProcessObject*, int> nodeIDs;
+    std::vector<SharedPointer<ProcessObject>> stack = m_processObjects;
+    // Depth first traversal of the input connections
+    while(!stack.empty()) {
+        auto po = stack.back();
+        stack.pop_back();
+        if(nodeIDs.count(po.get()) > 0)
+            continue;
+        nodeIDs[po.get()] = m_nodes.size();
+        Node node;
+        node.processObject = po;
+        m_nodes.push_back(node);
+        if(std::dynamic_pointer_cast<Streamer>(po))
+            m_hasStreamers = true;
+        for(auto&& input : po->mInputConnections)
+            stack.push_back(input.second->getProcessObject());
+        for(auto&& input : po->mAsynchronousInputConnections)
+            stack.push_back(input.second->getProcessObject());
+    }
+    // Add edges
+    for(int nodeID = 0; nodeID < m_nodes.size(); ++nodeID) {
+        auto po = m_nodes[nodeID].processObject;
+        for(auto connections : {&po->mInputConnections, &po->mAsynchronousInputConnections}) {
+            for(auto&& input : *connections) {
+                int parentID = nodeIDs.at(input.second->getProcessObject().get());
+                if(std::find(m_nodes[nodeID].parents.begin(), m_nodes[nodeID].parents.end(), parentID) != m_nodes[nodeID].parents.end())
+                    continue; // Connected to same parent through several ports
+                m_nodes[nodeID].parents.push_back(parentID);
+                m_nodes[parentID].children.push_back(nodeID);
+            }
+        }
+    }
+    markExternalNodes();
+    for(auto&& node : m_nodes)
+        node.isSink = !node.external && node.children.empty();
+    reportInfo() << "PipelineScheduler created graph with " << m_nodes.size() << " process objects" << reportEnd();
+}
+
+void PipelineScheduler::markExternalNodes() {
+    // Everything upstream of a process object with asynchronous inputs is executed by that process object
+    std::vector<int> stack;
+    for(auto&& node : m_nodes) {
+        if(node.processObject->hasAsynchronousInputs())
+            stack.insert(stack.end(), node.parents.begin(), node.parents.end());
+    }
+    while(!stack.empty()) {
+        Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if(node.external)
+            continue;
+        node.external = true;
+        stack.insert(stack.end(), node.parents.begin(), node.parents.end());
+    }
+    // Remove all edges to external nodes
+    auto isExternal = [this](int nodeID) { return m_nodes[nodeID].external; };
+    for(auto&& node : m_nodes) {
+        if(node.external) {
+            node.parents.clear();
+            node.children.clear();
+        } else {
+            node.parents.erase(std::remove_if(node.parents.begin(), node.parents.end(), isExternal), node.parents.end());
+            node.children.erase(std::remove_if(node.children.begin(), node.children.end(), isExternal), node.children.end());
+        }
+    }
+}
+
+void PipelineScheduler::scheduleReadyNodes() {
+    // Assumes m_mutex is locked
+    if(m_stop)
+        return;
+    for(int nodeID = 0; nodeID < m_nodes.size(); ++nodeID) {
+        Node& node = m_nodes[nodeID];
+        if(node.running || node.external)
+            continue;
+        const int token = node.lastCompletedToken + 1;
+        if(m_finalToken >= 0 && token > m_finalToken)
+            continue;
+        // All parents must have produced data for this token
+        bool ready = true;
+        for(int parentID : node.parents) {
+            if(m_nodes[parentID].lastCompletedToken < token) {
+                ready = false;
+                break;
+            }
+        }
+        if(!ready)
+            continue;
+        // All children must have consumed the data of the previous token
+        for(int childID : node.children) {
+            if(m_nodes[childID].lastCompletedToken < token - 1) {
+                ready = false;
+                break;
+            }
+        }
+        if(!ready)
+            continue;
+
+        node.running = true;
+        ++m_runningTasks;
+        m_threadPool->enqueue([this, nodeID, token]() {
+            executeNode(nodeID, token);
+        });
+    }
+}
+
+void PipelineScheduler::executeNode(int nodeID, int token) {
+    auto po = m_nodes[nodeID].processObject;
+    bool failed = false;
+    try {
+        if(po->hasAsynchronousInputs()) {
+            // Parents are not executed by the scheduler. This executes them the first time,
+            // before the connections are detached, and is equal to updateSelf afterwards.
+            po->update(m_executeTokenOffset + token);
+        } else {
+            po->updateSelf(m_executeTokenOffset + token);
+        }
+    } catch(ThreadStopped &e) {
+        failed = true;
+    } catch(...) {
+        failed = true;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_exception)
+            m_exception = std::current_exception();
+    }
+    if(failed) {
+        // Unblock any other process objects waiting for data
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        stopProcessObjects();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Node& node = m_nodes[nodeID];
+    node.running = false;
+    --m_runningTasks;
+    if(!failed) {
+        node.lastCompletedToken = token;
+        node.receivedLastFrame = !po->m_lastFrame.empty();
+        if(node.isSink && node.receivedLastFrame && m_finalToken < 0) {
+            // Finish when all sinks have received the last frame of a stream
+            bool allFinished = true;
+            for(auto&& other : m_nodes) {
+                if(other.isSink && !other.receivedLastFrame)
+                    allFinished = false;
+            }
+            if(allFinished) {
+                m_finalToken = token;
+                reportInfo() << "PipelineScheduler reached last frame at token " << token << reportEnd();
+            }
+        }
+    }
+    scheduleReadyNodes();
+    if(m_runningTasks == 0)
+        m_finishedCondition.notify_all();
+}
+
+void PipelineScheduler::run(int nrOfFrames) {
+    if(m_processObjects.empty())
+        throw Exception("No process objects given to PipelineScheduler");
+    buildGraph();
+    const uint nrOfThreads = std::max(m_nrOfThreads == 0 ? std::thread::hardware_concurrency() : m_nrOfThreads, (uint)m_nodes.size());
+    if(!m_threadPool || m_threadPool->getNumberOfThreads() != nrOfThreads)
+        m_threadPool = std::make_unique<ThreadPool>(nrOfThreads);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = false;
+        m_exception = nullptr;
+        m_runningTasks = 0;
+        if(nrOfFrames > 0) {
+            m_finalToken = nrOfFrames - 1;
+        } else {
+            // Pipeline without streamers only has to be executed once
+            m_finalToken = m_hasStreamers ? -1 : 0;
+        }
+        scheduleReadyNodes();
+        while(m_runningTasks > 0)
+            m_finishedCondition.wait(lock);
+        m_executeTokenOffset += getNumberOfProcessedFrames() + 1;
+    }
+    if(m_exception)
+        std::rethrow_exception(m_exception);
+}
+
+int PipelineScheduler::getNumberOfProcessedFrames() {
+    int processed = -1;
+    for(auto&& node : m_nodes) {
+        if(node.external)
+            continue;
+        if(processed < 0 || node.lastCompletedToken + 1 < processed)
+            processed = node.lastCompletedToken + 1;
+    }
+    return std::max(processed, 0);
+}
+
+void PipelineScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_runningTasks == 0)
+            return;
+        m_stop = true;
+    }
+    stopProcessObjects();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_runningTasks > 0)
+        m_finishedCondition.wait(lock);
+}
+
+void PipelineScheduler::stopProcessObjects() {
+    for(auto&& po : m_processObjects)
+        po->stopPipeline();
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <FAST/ProcessObject.hpp>
+#include <FAST/ThreadPool.hpp>
+
+namespace fast {
+
+/**
+ * Executes a pipeline on a thread pool instead of recursively calling update on the caller's thread.
+ *
+ * A directed acyclic graph is built from the input connections of the process objects added.
+ * Each process object is executed once per execute token (timestep), and may run
+ * as soon as all its parents have finished the same token and all its children have
+ * finished the previous token. Thus, independent branches of a pipeline run concurrently,
+ * and each stage works on a different consecutive frame at the same time.
+ * Everything upstream of a process object which pulls data from its parents asynchronously
+ * (see ProcessObject::hasAsynchronousInputs) is executed by that process object instead.
+ *
+ * Usage:
+ * @code
+ * auto scheduler = PipelineScheduler::New();
+ * scheduler->addProcessObject(exporter);
+ * scheduler->addProcessObject(segmentationNetwork);
+ * scheduler->run(); // Blocks until the last frame of the stream has been processed
+ * @endcode
+ */
+class FAST_EXPORT PipelineScheduler : public Object {
+    FAST_OBJECT(PipelineScheduler)
+    public:
+        /**
+         * Add a process object to execute. All process objects upstream of it are added as well.
+         * @param po
+         */
+        void addProcessObject(SharedPointer<ProcessObject> po);
+        /**
+         * Set number of threads in the thread pool.
+         * The number of threads used is never less than the number of process objects in the pipeline,
+         * since process objects may block while waiting for streamed data.
+         * @param threads 0 means use the number of hardware threads
+         */
+        void setNumberOfThreads(uint threads);
+        /**
+         * Execute the pipeline. Blocks until the given number of frames has been processed,
+         * the last frame of all streams has been processed, or stop is called.
+         * If the pipeline has no streamers, it is only executed once.
+         * Exceptions thrown by process objects are rethrown here.
+         *
+         * @param nrOfFrames Negative value means process until end of stream or stop.
+         */
+        void run(int nrOfFrames = -1);
+        /**
+         * Stop the pipeline. Can be called from any thread.
+         */
+        void stop();
+        /**
+         * @return number of frames (execute tokens) processed by all process objects in the last call to run
+         */
+        int getNumberOfProcessedFrames();
+        ~PipelineScheduler();
+    private:
+        PipelineScheduler();
+        struct Node {
+            SharedPointer<ProcessObject> processObject;
+            std::vector<int> parents;
+            std::vector<int> children;
+            int lastCompletedToken = -1;
+            bool running = false;
+            bool isSink = false;
+            bool receivedLastFrame = false;
+            // Executed by a child which pulls data from it asynchronously, instead of by the scheduler
+            bool external = false;
+        };
+        void buildGraph();
+        void markExternalNodes();
+        void scheduleReadyNodes();
+        void executeNode(int nodeID, int token);
+        void stopProcessObjects();
+
+        std::vector<SharedPointer<ProcessObject>> m_processObjects;
+        std::vector<Node> m_nodes;
+        std::unique_ptr<ThreadPool> m_threadPool;
+        uint m_nrOfThreads = 0;
+
+        std::mutex m_mutex;
+        std::condition_variable m_finishedCondition;
+        int m_runningTasks = 0;
+        int m_finalToken = -1;
+        bool m_hasStreamers = false;
+        bool m_stop = false;
+        std::exception_ptr m_exception;
+        // Execute tokens have to be unique across runs
+        int m_executeTokenOffset = 0;
+};
+
+}
@@ -2,8 +2,10 @@
 #include "FAST/Exception.hpp"
 #include "FAST/OpenCLProgram.hpp"
 #include "FAST/Streamers/Streamer.hpp"
+#include "FAST/ThreadPool.hpp"
 #include <unordered_set>
 #include <FAST/DataChannels/QueuedDataChannel.hpp>
+#include <FAST/DataChannels/RingBufferDataChannel.hpp>
 #include <FAST/DataChannels/NewestFrameDataChannel.hpp>
 #include <FAST/DataChannels/StaticDataChannel.hpp>
 
@@ -13,6 +15,8 @@ namespace fast {
 ProcessObject::ProcessObject() : mIsModified(false) {
     mDevices[0] = DeviceManager::getInstance()->getDefaultComputationDevice();
     mRuntimeManager = RuntimeMeasurementsManager::New();
+    m_executeRuntime = mRuntimeManager->getTiming("execute");
+    m_latencyRuntime = mRuntimeManager->getTiming("latency");
 }
 
 static bool isStreamer(ProcessObject* po) {
@@ -26,11 +30,19 @@ static bool isStreamer(ProcessObject* po) {
 
 void ProcessObject::update(int executeToken) {
     // Call update on all parents
+    for(auto parent : mInputConnections) {
+        parent.second->getProcessObject()->update(executeToken);
+    }
+
+    updateSelf(executeToken);
+}
+
+void ProcessObject::updateSelf(int executeToken) {
+    std::lock_guard<std::recursive_mutex> lock(m_updateMutex);
+    // Check if any of the parents have new data for this PO
     bool newInputData = false;
     for(auto parent : mInputConnections) {
         auto port = parent.second;
-        port->getProcessObject()->update(executeToken);
-
         if(mLastProcessed.count(parent.first) > 0) {
             //std::cout << "" << getNameOfClass() << " has last processed data.. " << std::endl;
             // Compare the last processed data with the new data for this data port
@@ -96,27 +108,47 @@ void ProcessObject::update(int executeToken) {
         return;
     // If this object is modified, or any parents has new data for this PO: Call execute
     if(mIsModified || newInputData) {
-        this->mRuntimeManager->startRegularTimer("execute");
+        m_executeStartTime = std::chrono::steady_clock::now();
         // set isModified to false before executing to avoid recursive update calls
-        if(mIsModified) {
-            reportInfo() << "EXECUTING " << getNameOfClass() << " because PO is modified." << reportEnd();
-        } else if(newInputData) {
-            reportInfo() << "EXECUTING " << getNameOfClass() << " because PO has new input data." << reportEnd();
+        // Avoid creating the class name string for every frame when info is not reported
+        if(getReporter().isEnabled(Reporter::INFO)) {
+            if(mIsModified) {
+                reportInfo() << "EXECUTING " << getNameOfClass() << " because PO is modified." << reportEnd();
+            } else if(newInputData) {
+                reportInfo() << "EXECUTING " << getNameOfClass() << " because PO has new input data." << reportEnd();
+            }
         }
         mIsModified = false;
         preExecute();
         execute();
         postExecute();
         m_lastExecuteToken = executeToken;
-        if(this->mRuntimeManager->isEnabled())
+        const bool tracing = RuntimeMeasurementsManager::isTracing();
+        if(this->mRuntimeManager->isEnabled() || tracing)
             this->waitToFinish();
-        this->mRuntimeManager->stopRegularTimer("execute");
+        auto executeEndTime = std::chrono::steady_clock::now();
+        if(this->mRuntimeManager->isEnabled())
+            m_executeRuntime->addSample(std::chrono::duration<double, std::milli>(executeEndTime - m_executeStartTime).count());
+        if(tracing)
+            addTraceEvent(executeEndTime);
     }
     // TODO need to clear m_frameData m_lastFrame
     //m_frameData.clear();
     //m_lastFrame.clear();
 }
 
+void ProcessObject::addTraceEvent(std::chrono::steady_clock::time_point executeEndTime) {
+    std::string arguments = "{\"execute_token\": " + std::to_string(m_lastExecuteToken);
+    if(m_frameData.count("trace-start") > 0) {
+        // Latency from when the frame was created by the first process object in the pipeline
+        const double latency = (RuntimeMeasurementsManager::getTraceTime(executeEndTime) - std::stoll(m_frameData["trace-start"]))*0.001;
+        m_latencyRuntime->addSample(latency);
+        arguments += ", \"frame\": " + m_frameData["trace-start"] + ", \"latency_ms\": " + std::to_string(latency);
+    }
+    arguments += "}";
+    RuntimeMeasurementsManager::addTraceEvent(getNameOfClass(), "ProcessObject", m_executeStartTime, executeEndTime, arguments);
+}
+
 DataChannel::pointer ProcessObject::getOutputPort(uint portID) {
     validateOutputPortExists(portID);
     // Create DataChannel, and it to list and return it
@@ -124,7 +156,8 @@ DataChannel::pointer ProcessObject::getOutputPort(uint portID) {
     if(isStreamer(this)) {
         auto streamingMode = Config::getStreamingMode();
         if(streamingMode == STREAMING_MODE_PROCESS_ALL_FRAMES) {
-            dataChannel = QueuedDataChannel::New();
+            // A new data channel is created for each consumer, thus it has a single producer and a single consumer
+            dataChannel = RingBufferDataChannel::New();
         } else if(streamingMode == STREAMING_MODE_NEWEST_FRAME_ONLY) {
             dataChannel = NewestFrameDataChannel::New();
         } else {
@@ -151,6 +184,9 @@ void ProcessObject::setInputConnection(uint portID, DataChannel::pointer port) {
     validateInputPortExists(portID);
     if(port->getProcessObject().get() == this)
         throw Exception("Can't set setInputConnection on self");
+    // Ring buffers only support a single consumer
+    if(auto ringBuffer = std::dynamic_pointer_cast<RingBufferDataChannel>(port))
+        ringBuffer->setConsumer(this);
     mInputConnections[portID] = port;
     mIsModified = true;
 }
@@ -167,6 +203,11 @@ void ProcessObject::addOutputData(uint portID, DataObject::pointer data) {
         data->setLastFrame(lastFrame);
     for(auto&& frameData : m_frameData)
         data->setFrameData(frameData.first, frameData.second);
+    if(RuntimeMeasurementsManager::isTracing() && !data->hasFrameData("trace-start")) {
+        // The frame was created by this process object, store the time it was created, to trace its latency.
+        // Streamers add frames from their own thread, thus use the current time instead of when execute started.
+        data->setFrameData("trace-start", std::to_string(RuntimeMeasurementsManager::getTraceTime(std::chrono::steady_clock::now())));
+    }
 
     // Add it to all output connections, if any connections exist
     if(mOutputConnections.count(portID) > 0) {
@@ -337,6 +378,34 @@ cl::Program ProcessObject::getOpenCLProgram(
     return program->build(device, buildOptions);
 }
 
+void ProcessObject::warmUp() {
+    warmUp({std::static_pointer_cast<ProcessObject>(mPtr.lock())});
+}
+
+void ProcessObject::warmUp(std::vector<ProcessObject::pointer> processObjects) {
+    ThreadPool pool;
+    std::vector<std::pair<std::string, std::future<void>>> builds;
+    for(auto&& processObject : processObjects) {
+        auto device = std::dynamic_pointer_cast<OpenCLDevice>(processObject->getMainDevice());
+        if(!device) // Process object is run on host
+            continue;
+        for(auto&& program : processObject->mOpenCLPrograms) {
+            OpenCLProgram::pointer openCLProgram = program.second;
+            builds.push_back(std::make_pair(openCLProgram->getSourceFilename(), pool.submit([openCLProgram, device]() {
+                openCLProgram->warmUp(device);
+            })));
+        }
+    }
+    for(auto&& build : builds) {
+        try {
+            build.second.get();
+        } catch(std::exception &e) {
+            // Errors will be reported again when the program is built in execute
+            Reporter::warning() << "Failed to warm up OpenCL program " << build.first << ": " << e.what() << Reporter::end();
+        }
+    }
+}
+
 ProcessObject::~ProcessObject() {
 }
 
@@ -503,7 +572,20 @@ void ProcessObject::stopPipeline() {
         input.second->stop();
         input.second->getProcessObject()->stopPipeline(); // Stop parent POs
     }
+    for(auto input : mAsynchronousInputConnections) {
+        input.second->stop();
+        input.second->getProcessObject()->stopPipeline();
+    }
+}
+
+void ProcessObject::detachInputConnections() {
+    for(auto&& input : mInputConnections)
+        mAsynchronousInputConnections[input.first] = input.second;
+    mInputConnections.clear();
+}
 
+bool ProcessObject::hasAsynchronousInputs() {
+    return !mAsynchronousInputConnections.empty();
 }
 
 bool ProcessObject::hasNewInputData(uint portID) {
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <mutex>
 #include "FAST/Object.hpp"
 #include "FAST/Data/DataObject.hpp"
 #include "RuntimeMeasurement.hpp"
@@ -76,6 +77,20 @@ class FAST_EXPORT  ProcessObject : public Object {
         template <class DataType>
         SharedPointer<DataType> updateAndGetOutputData(uint portID = 0);
 
+        /**
+         * Build the OpenCL programs of this process object for its main device, so that the first
+         * execute doesn't have to wait for kernels to compile.
+         */
+        void warmUp();
+        /**
+         * Build the OpenCL programs of all the given process objects in parallel. Each program is built
+         * with the build options it was built with before on the device, according to the kernel binary
+         * cache, or with the default build options if it has not been built before.
+         *
+         * @param processObjects
+         */
+        static void warmUp(std::vector<SharedPointer<ProcessObject>> processObjects);
+
     protected:
         ProcessObject();
         // Flag to indicate whether the object has been modified
@@ -84,6 +99,16 @@ class FAST_EXPORT  ProcessObject : public Object {
 
         // An integer id which act as a token of when this PO last executed
         int m_lastExecuteToken = -1;
+        // Serializes updateSelf, as a PO may be updated from several threads, e.g. when it is upstream of several asynchronous POs
+        std::recursive_mutex m_updateMutex;
+
+        /**
+         * Execute this PO if it is modified or its parents have new data for it,
+         * without updating the parents first. Used by update and the PipelineScheduler.
+         *
+         * @param executeToken Negative value means that the execute token is disabled.
+         */
+        void updateSelf(int executeToken);
 
         // Pure virtual method for executing the pipeline object
         virtual void execute()=0;
@@ -103,10 +128,27 @@ class FAST_EXPORT  ProcessObject : public Object {
 
         bool hasNewInputData(uint portID);
 
+        /**
+         * Move all input connections to the asynchronous input connections. Used by process objects which
+         * pull data from their parents in a separate thread, so that update doesn't execute the parents as well.
+         * The asynchronous connections are still used by stopPipeline and the PipelineScheduler.
+         */
+        void detachInputConnections();
+        /**
+         * @return true if this PO pulls data from its parents itself. The PipelineScheduler will then leave
+         * the execution of everything upstream of this PO to the PO itself.
+         */
+        virtual bool hasAsynchronousInputs();
+
         virtual void waitToFinish() {};
 
 
         RuntimeMeasurementsManager::pointer mRuntimeManager;
+        // Measurements are looked up once, to avoid looking them up by name for every execute
+        RuntimeMeasurement::pointer m_executeRuntime;
+        RuntimeMeasurement::pointer m_latencyRuntime;
+        std::chrono::steady_clock::time_point m_executeStartTime;
+        void addTraceEvent(std::chrono::steady_clock::time_point executeEndTime);
 
         void createOpenCLProgram(std::string sourceFilename, std::string name = "");
         cl::Program getOpenCLProgram(
@@ -137,6 +179,8 @@ class FAST_EXPORT  ProcessObject : public Object {
 
         // New pipeline
         std::unordered_map<uint, DataChannel::pointer> mInputConnections;
+        // Input connections which the PO pulls data from itself, see detachInputConnections
+        std::unordered_map<uint, DataChannel::pointer> mAsynchronousInputConnections;
         std::unordered_map<uint, std::vector<std::weak_ptr<DataChannel>>> mOutputConnections;
         std::unordered_map<uint, bool> mInputPorts;
         std::unordered_set<uint> mOutputPorts;
@@ -158,7 +202,7 @@ class FAST_EXPORT  ProcessObject : public Object {
         // Indicates whether this data object is the last frame in a stream, and if so, the name of the stream
         std::unordered_set<std::string> m_lastFrame;
 
-
+        friend class PipelineScheduler;
 };
 
 
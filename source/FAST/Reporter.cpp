@@ -1,41 +1,297 @@
 #include "Reporter.hpp"
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#ifndef WIN32
+#include <syslog.h>
+#endif
 
 namespace fast {
 
 // Initialize report methods for each type
-std::map<Reporter::Type, Reporter::Method> Reporter::mGlobalReporterMethods =
+std::atomic<Reporter::Method> Reporter::mGlobalReporterMethods[3] =
 #ifdef FAST_DEBUG
 {
-        {INFO, COUT},
-        {WARNING, COUT},
-        {ERROR, COUT}
+        {COUT}, // INFO
+        {COUT}, // WARNING
+        {COUT}  // ERROR
 };
 #else
 {
-        {INFO, NONE},
-        {WARNING, COUT},
-        {ERROR, COUT}
+        {NONE}, // INFO
+        {COUT}, // WARNING
+        {COUT}  // ERROR
 };
 #endif
 #ifdef WIN32
 WORD Reporter::m_defaultAttributes = 0;
 #endif
 
-Reporter::Reporter(Type type) {
-    mType = type;
-    mFirst = true;
+struct LogMessage {
+    Reporter::Type type;
+    std::chrono::system_clock::time_point time;
+    std::string text;
+};
+
+/**
+ * Bounded lock-free queue with multiple producers and a single consumer.
+ * Each slot has a sequence number which tells whether it is ready to be written or read.
+ */
+class LogQueue {
+    public:
+        explicit LogQueue(std::size_t size) : m_slots(new Slot[size]), m_mask(size - 1) {
+            for(std::size_t i = 0; i < size; ++i)
+                m_slots[i].sequence = i;
+            m_enqueuePosition = 0;
+            m_dequeuePosition = 0;
+        }
+        bool push(LogMessage&& message) {
+            std::size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+            Slot* slot;
+            while(true) {
+                slot = &m_slots[position & m_mask];
+                const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+                if(difference == 0) {
+                    if(m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                } else if(difference < 0) {
+                    return false; // Full
+                } else {
+                    position = m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            slot->message = std::move(message);
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+        bool pop(LogMessage& message) {
+            const std::size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[position & m_mask];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if(sequence != position + 1)
+                return false; // Empty
+            message = std::move(slot.message);
+            slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+            m_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+            return true;
+        }
+        bool isEmpty() const {
+            return m_dequeuePosition.load(std::memory_order_relaxed) == m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    private:
+        struct Slot {
+            std::atomic<std::size_t> sequence;
+            LogMessage message;
+        };
+        std::unique_ptr<Slot[]> m_slots;
+        const std::size_t m_mask;
+        std::atomic<std::size_t> m_enqueuePosition;
+        std::atomic<std::size_t> m_dequeuePosition;
+};
+
 #ifdef WIN32
-    if(m_defaultAttributes == 0) {
-        CONSOLE_SCREEN_BUFFER_INFO Info;
-        GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &Info);
-        m_defaultAttributes = Info.wAttributes;
+static void writeToConsole(Reporter::Type type, const std::string& text, WORD defaultAttributes) {
+    if(type == Reporter::INFO) {
+        std::cout << text << std::endl;
+    } else if(type == Reporter::WARNING) {
+        SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), (defaultAttributes & 0x00F0) | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+        std::cout << text << std::endl;
+        SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), defaultAttributes);
+    } else {
+        SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), (defaultAttributes & 0x00F0) | FOREGROUND_RED | FOREGROUND_INTENSITY);
+        std::cerr << text << std::endl;
+        SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), defaultAttributes);
+    }
+}
+#else
+static void writeToConsole(Reporter::Type type, const std::string& text) {
+    if(type == Reporter::INFO) {
+        std::cout << text << std::endl;
+    } else if(type == Reporter::WARNING) {
+        std::cout << "\033[1m" << text << "\033[0m" << std::endl;
+    } else {
+        std::cerr << "\033[31;1m" << text << "\033[0m" << std::endl;
     }
+}
 #endif
+
+// Serializes console output of the COUT method and the log writer, so that lines are not interleaved
+static std::mutex& getConsoleMutex() {
+    static std::mutex mutex;
+    return mutex;
 }
 
-Reporter::Reporter() {
-    mType = INFO;
+/**
+ * Background thread which writes messages of the LOG method to the sinks
+ */
+class LogWriter {
+    public:
+        static LogWriter& getInstance() {
+            static LogWriter writer;
+            return writer;
+        }
+        void push(LogMessage&& message) {
+            const bool isError = message.type == Reporter::ERROR;
+            if(!m_queue.push(std::move(message))) {
+                ++m_droppedMessages;
+                return;
+            }
+            // The writer polls the queue regularly, only wake it for errors
+            if(isError)
+                m_messageAvailable.notify_one();
+        }
+        void flush() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_flushRequested = true;
+            m_messageAvailable.notify_one();
+            m_flushed.wait(lock, [this]() { return !m_flushRequested; });
+        }
+        void setConsole(bool enabled) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_console = enabled;
+        }
+        void setFile(std::string filename) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_file.reset();
+            if(!filename.empty()) {
+                m_file = std::make_unique<std::ofstream>(filename, std::ios::app);
+                if(!m_file->is_open()) {
+                    m_file.reset();
+                    std::cerr << "Unable to open log file " << filename << std::endl;
+                }
+            }
+        }
+        void setSyslog(bool enabled, std::string identity) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+#ifdef WIN32
+            if(enabled)
+                std::cerr << "Logging to syslog is not supported on Windows" << std::endl;
+#else
+            if(m_syslog)
+                closelog();
+            m_syslog = enabled;
+            if(enabled) {
+                // openlog keeps the pointer, thus the string must outlive the log
+                m_syslogIdentity = identity;
+                openlog(m_syslogIdentity.c_str(), LOG_PID, LOG_USER);
+            }
+#endif
+        }
+        uint64_t getDroppedMessages() const {
+            return m_droppedMessages;
+        }
+        ~LogWriter() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_messageAvailable.notify_one();
+            m_thread.join();
+#ifndef WIN32
+            if(m_syslog)
+                closelog();
+#endif
+        }
+    private:
+        LogWriter() : m_queue(8192) {
+            m_droppedMessages = 0;
+#ifdef WIN32
+            CONSOLE_SCREEN_BUFFER_INFO info;
+            GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info);
+            m_defaultAttributes = info.wAttributes;
+#endif
+            m_thread = std::thread(&LogWriter::run, this);
+        }
+        void run() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while(true) {
+                m_messageAvailable.wait_for(lock, std::chrono::milliseconds(10));
+                writeMessages();
+                if(m_flushRequested) {
+                    m_flushRequested = false;
+                    m_flushed.notify_all();
+                }
+                if(m_stop)
+                    return;
+            }
+        }
+        void writeMessages() {
+            LogMessage message;
+            while(m_queue.pop(message))
+                write(message);
+            const uint64_t totalDropped = m_droppedMessages;
+            const uint64_t dropped = totalDropped - m_reportedDroppedMessages;
+            if(dropped > 0) {
+                message.type = Reporter::WARNING;
+                message.time = std::chrono::system_clock::now();
+                message.text = "WARNING " + std::to_string(dropped) + " log messages were dropped because the log queue was full";
+                write(message);
+                m_reportedDroppedMessages = totalDropped;
+            }
+            if(m_file)
+                m_file->flush();
+        }
+        void write(const LogMessage& message) {
+            if(m_console) {
+                std::lock_guard<std::mutex> lock(getConsoleMutex());
+#ifdef WIN32
+                writeToConsole(message.type, message.text, m_defaultAttributes);
+#else
+                writeToConsole(message.type, message.text);
+#endif
+            }
+            if(m_file) {
+                const std::time_t time = std::chrono::system_clock::to_time_t(message.time);
+                const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(message.time.time_since_epoch()).count() % 1000;
+                std::tm localTime;
+#ifdef WIN32
+                localtime_s(&localTime, &time);
+#else
+                localtime_r(&time, &localTime);
+#endif
+                *m_file << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S") << "." << std::setfill('0') << std::setw(3) << milliseconds << std::setfill(' ') << " " << message.text << "\n";
+            }
+#ifndef WIN32
+            if(m_syslog) {
+                int priority = LOG_INFO;
+                if(message.type == Reporter::WARNING) {
+                    priority = LOG_WARNING;
+                } else if(message.type == Reporter::ERROR) {
+                    priority = LOG_ERR;
+                }
+                syslog(priority, "%s", message.text.c_str());
+            }
+#endif
+        }
+
+        LogQueue m_queue;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_messageAvailable;
+        std::condition_variable m_flushed;
+        bool m_flushRequested = false;
+        bool m_stop = false;
+        std::atomic<uint64_t> m_droppedMessages;
+        uint64_t m_reportedDroppedMessages = 0;
+        bool m_console = true;
+        std::unique_ptr<std::ofstream> m_file;
+        bool m_syslog = false;
+        std::string m_syslogIdentity;
+#ifdef WIN32
+        WORD m_defaultAttributes;
+#endif
+};
+
+Reporter::Reporter(Type type) {
+    mType = type;
     mFirst = true;
+    for(int i = 0; i < 3; ++i)
+        mLocalReporterMethods[i] = -1;
 #ifdef WIN32
     if(m_defaultAttributes == 0) {
         CONSOLE_SCREEN_BUFFER_INFO Info;
@@ -45,6 +301,9 @@ Reporter::Reporter() {
 #endif
 }
 
+Reporter::Reporter() : Reporter(INFO) {
+}
+
 void Reporter::setType(Type type) {
     mType = type;
 }
@@ -61,17 +320,30 @@ Reporter Reporter::error() {
     return Reporter(ERROR);
 }
 
+std::ostringstream& Reporter::getThreadBuffer() {
+    thread_local std::ostringstream buffer;
+    return buffer;
+}
+
 void Reporter::processEnd() {
     mFirst = true;
-    if(getMethod(mType) == COUT) {
-#if WIN32
-        SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), m_defaultAttributes);
-        std::cout << std::endl;
+    const Method method = getMethod(mType);
+    if(method == NONE)
+        return;
+
+    std::ostringstream& buffer = getThreadBuffer();
+    std::string text = buffer.str();
+    buffer.str("");
+    buffer.clear();
+    if(method == COUT) {
+        std::lock_guard<std::mutex> lock(getConsoleMutex());
+#ifdef WIN32
+        writeToConsole(mType, text, m_defaultAttributes);
 #else
-        std::cout << "\033[0m" << std::endl; // Reset
+        writeToConsole(mType, text);
 #endif
-    } else if(getMethod(mType) == LOG) {
-        // Not implemented yet
+    } else if(method == LOG) {
+        LogWriter::getInstance().push({mType, std::chrono::system_clock::now(), std::move(text)});
     }
 }
 
@@ -96,14 +368,34 @@ void Reporter::setGlobalReportMethod(Type type, Method method)  {
 }
 
 Reporter::Method Reporter::getMethod(Type type) const {
-    Method reportMethod;
     // If a local report method is given for the type, use that, if not use the global
-    if(mLocalReporterMethods.count(type) > 0) {
-        reportMethod = mLocalReporterMethods.at(type);
-    } else {
-        reportMethod = mGlobalReporterMethods.at(type);
-    }
-    return reportMethod;
+    if(mLocalReporterMethods[type] >= 0)
+        return (Method)mLocalReporterMethods[type];
+    return mGlobalReporterMethods[type].load(std::memory_order_relaxed);
+}
+
+bool Reporter::isEnabled(Type type) const {
+    return getMethod(type) != NONE;
+}
+
+void Reporter::setLogToConsole(bool enabled) {
+    LogWriter::getInstance().setConsole(enabled);
+}
+
+void Reporter::setLogFile(std::string filename) {
+    LogWriter::getInstance().setFile(filename);
+}
+
+void Reporter::setLogToSyslog(bool enabled, std::string identity) {
+    LogWriter::getInstance().setSyslog(enabled, identity);
+}
+
+void Reporter::flush() {
+    LogWriter::getInstance().flush();
+}
+
+uint64_t Reporter::getNrOfDroppedMessages() {
+    return LogWriter::getInstance().getDroppedMessages();
 }
 
 template <>
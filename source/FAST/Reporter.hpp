@@ -2,7 +2,10 @@
 
 #include <map>
 #include <iostream>
+#include <sstream>
 #include <thread>
+#include <atomic>
+#include <string>
 #include "FASTExport.hpp"
 #ifdef WIN32
 #include <windows.h>
@@ -17,6 +20,14 @@ class FAST_EXPORT  ReporterEnd {
 
 };
 
+/**
+ * Reports info, warnings and errors.
+ *
+ * A message is assembled in a buffer of the calling thread, and is not formatted at all if its type is disabled.
+ * With the COUT method, complete messages are written to the console.
+ * With the LOG method, messages are put in a lock-free queue and written to the log sinks (console, file and syslog)
+ * by a background thread, so that threads which report never wait on I/O. If the queue is full, messages are dropped.
+ */
 class FAST_EXPORT  Reporter {
     public:
         static ReporterEnd end();
@@ -35,12 +46,41 @@ class FAST_EXPORT  Reporter {
         void setReportMethod(Type type, Method method);
         static void setGlobalReportMethod(Method method);
         static void setGlobalReportMethod(Type type, Method method);
+        /**
+         * Check if messages of a type are reported. Use this to avoid building expensive messages which are not reported.
+         */
+        bool isEnabled(Type type) const;
+        /**
+         * Enable or disable writing messages of the LOG method to the console. Enabled by default.
+         */
+        static void setLogToConsole(bool enabled);
+        /**
+         * Append messages of the LOG method to a file. An empty filename disables the file sink.
+         */
+        static void setLogFile(std::string filename);
+        /**
+         * Send messages of the LOG method to the system log. Not available on Windows.
+         *
+         * @param enabled
+         * @param identity Program name to use in the system log
+         */
+        static void setLogToSyslog(bool enabled, std::string identity = "FAST");
+        /**
+         * Block until all messages of the LOG method have been written to the sinks
+         */
+        static void flush();
+        /**
+         * @return nr of messages of the LOG method dropped because the queue was full
+         */
+        static uint64_t getNrOfDroppedMessages();
     private:
         Method getMethod(Type) const;
+        // Buffer of the message currently being assembled by the calling thread
+        static std::ostringstream& getThreadBuffer();
         Type mType;
-        static std::map<Type, Method> mGlobalReporterMethods;
-        // The local report methods override the global, if they are defined
-        std::map<Type, Method> mLocalReporterMethods;
+        static std::atomic<Method> mGlobalReporterMethods[3];
+        // The local report methods override the global, if they are defined (not -1)
+        signed char mLocalReporterMethods[3];
 
         // Variable to keep track of first <<
         bool mFirst;
@@ -51,37 +91,26 @@ class FAST_EXPORT  Reporter {
 
 template <class T>
 void Reporter::process(const T& content) {
-    Method reportMethod = getMethod(mType);
+    if(getMethod(mType) == NONE)
+        return;
 
+    std::ostringstream& buffer = getThreadBuffer();
     if(mFirst) {
+        // Discard any text of a message on this thread which was abandoned before processEnd
+        buffer.str("");
+        buffer.clear();
         // Write prefix first
-        if(reportMethod == COUT) {
-            if(mType == INFO) {
-                std::cout << "INFO [" << std::this_thread::get_id() << "] ";
-            } else if(mType == WARNING) {
-#ifdef WIN32
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), (m_defaultAttributes & 0x00F0) | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-#else
-                std::cout << "\033[1m";
-#endif
-                std::cout << "WARNING [" << std::this_thread::get_id() << "] ";
-            } else if(mType == ERROR) {
-#ifdef WIN32
-                SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), (m_defaultAttributes & 0x00F0) | FOREGROUND_RED | FOREGROUND_INTENSITY);
-#else
-                std::cout << "\033[31;1m";
-#endif
-                std::cerr << "ERROR [" << std::this_thread::get_id() << "] ";
-            }
+        if(mType == INFO) {
+            buffer << "INFO [" << std::this_thread::get_id() << "] ";
+        } else if(mType == WARNING) {
+            buffer << "WARNING [" << std::this_thread::get_id() << "] ";
+        } else if(mType == ERROR) {
+            buffer << "ERROR [" << std::this_thread::get_id() << "] ";
         }
         mFirst = false;
     }
 
-    if(reportMethod == COUT) {
-        std::cout << content;
-    } else if(reportMethod == LOG) {
-        // Not implemented yet
-    }
+    buffer << content;
 }
 
 template <class T>
@@ -1,43 +1,87 @@
 #include "RuntimeMeasurement.hpp"
 #include <iostream>
 #include <sstream>
+#include <limits>
+#include <algorithm>
 #define _USE_MATH_DEFINES
 #include <cmath>
 
 namespace fast {
 
-RuntimeMeasurement::RuntimeMeasurement(){
-    mSum = 0.0;
-	mSamples = 0;
-	mRunningMean = 0.0;
-    mRunningVariance = 0.0;
+RuntimeMeasurement::RuntimeMeasurement() {
+	reset();
 }
 
 RuntimeMeasurement::RuntimeMeasurement(std::string name) {
+	reset();
+	this->mName = name;
+}
+
+void RuntimeMeasurement::reset() {
 	mSum = 0.0;
+	mSumSquared = 0.0;
 	mSamples = 0;
-	mRunningMean = 0.0;
-    mRunningVariance = 0.0;
-	this->mName = name;
+	mMin = std::numeric_limits<double>::max();
+	mMax = std::numeric_limits<double>::lowest();
+	for(auto&& bin : mHistogram)
+		bin = 0;
+}
+
+static void atomicAdd(std::atomic<double>& value, double add) {
+	double current = value.load(std::memory_order_relaxed);
+	while(!value.compare_exchange_weak(current, current + add, std::memory_order_relaxed));
+}
+
+int RuntimeMeasurement::getHistogramBin(double runtime) {
+	// Bin 0 is everything below 1 microsecond, then histogramSubBins linear bins per power of two
+	const double microseconds = runtime*1000.0;
+	if(!(microseconds >= 1.0)) // Also catches NaN
+		return 0;
+	int exponent;
+	const double fraction = std::frexp(microseconds, &exponent); // microseconds = fraction*2^exponent, fraction in [0.5, 1)
+	const int subBin = (int)((fraction*2.0 - 1.0)*histogramSubBins);
+	return std::min(1 + (exponent - 1)*histogramSubBins + subBin, histogramBins - 1);
+}
+
+double RuntimeMeasurement::getHistogramBinValue(int bin) {
+	// Center of the bin in milliseconds
+	if(bin == 0)
+		return 0.0005;
+	const int exponent = (bin - 1) / histogramSubBins;
+	const int subBin = (bin - 1) % histogramSubBins;
+	return std::ldexp(1.0 + (subBin + 0.5)/histogramSubBins, exponent)*0.001;
 }
 
 void RuntimeMeasurement::addSample(double runtime) {
-	mSamples++;
-	mSum += runtime;
-    if(mSamples > 1) {
-		const double delta = runtime - mRunningMean;
-		mRunningMean += delta / mSamples;
-		const double delta2 = runtime - mRunningMean;
-		mRunningVariance += delta * delta2;
-        if(runtime < mMin)
-			mMin = runtime;
-		if(runtime > mMax)
-			mMax = runtime;
-	} else {
-		mRunningMean = runtime;
-        mMin = runtime;
-		mMax = runtime;
+	mSamples.fetch_add(1, std::memory_order_relaxed);
+	atomicAdd(mSum, runtime);
+	atomicAdd(mSumSquared, runtime*runtime);
+	double minimum = mMin.load(std::memory_order_relaxed);
+	while(runtime < minimum && !mMin.compare_exchange_weak(minimum, runtime, std::memory_order_relaxed));
+	double maximum = mMax.load(std::memory_order_relaxed);
+	while(runtime > maximum && !mMax.compare_exchange_weak(maximum, runtime, std::memory_order_relaxed));
+	mHistogram[getHistogramBin(runtime)].fetch_add(1, std::memory_order_relaxed);
+}
+
+double RuntimeMeasurement::getPercentile(double percentile) const {
+	uint64_t total = 0;
+	for(auto&& bin : mHistogram)
+		total += bin.load(std::memory_order_relaxed);
+	if(total == 0)
+		return 0.0;
+	// Rank of the sample, 1 is the smallest
+	const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(percentile/100.0*total));
+	uint64_t count = 0;
+	for(int bin = 0; bin < histogramBins; ++bin) {
+		count += mHistogram[bin].load(std::memory_order_relaxed);
+		if(count >= rank)
+			return std::min(std::max(getHistogramBinValue(bin), getMin()), getMax());
 	}
+	return getMax();
+}
+
+std::string RuntimeMeasurement::getName() const {
+	return mName;
 }
 
 std::string RuntimeMeasurement::print() const {
@@ -47,17 +91,18 @@ std::string RuntimeMeasurement::print() const {
     buffer << std::endl;
 	buffer << "Runtime of " << mName << std::endl;
 	buffer << "----------------------------------------------------" << std::endl;
-	if (mSamples == 0) {
+	if (getSamples() == 0) {
 		buffer << "None recorded." << std::endl;
-	} else if (mSamples == 1) {
-		buffer << mSum << " ms" << std::endl;
+	} else if (getSamples() == 1) {
+		buffer << getSum() << " ms" << std::endl;
 	} else {
 		buffer << "Total: " << getSum() << " ms" << std::endl;
 		buffer << "Average: " << getAverage() << " ms" << std::endl;
 		buffer << "Standard deviation: " << getStdDeviation() << " ms" << std::endl;
-		buffer << "Minimum: " << mMin << " ms" << std::endl;
-		buffer << "Maximum: " << mMax << " ms" << std::endl;
-		buffer << "Number of samples: " << mSamples << std::endl;
+		buffer << "Minimum: " << getMin() << " ms" << std::endl;
+		buffer << "Maximum: " << getMax() << " ms" << std::endl;
+		buffer << "Percentiles 50/95/99: " << getPercentile(50) << " / " << getPercentile(95) << " / " << getPercentile(99) << " ms" << std::endl;
+		buffer << "Number of samples: " << getSamples() << std::endl;
 	}
 	buffer << "----------------------------------------------------" << std::endl;
 
@@ -66,28 +111,49 @@ std::string RuntimeMeasurement::print() const {
 
 }
 
+std::string RuntimeMeasurement::toJSON() const {
+	std::stringstream buffer;
+	buffer << "{\"samples\": " << getSamples() <<
+		", \"sum\": " << getSum() <<
+		", \"average\": " << getAverage() <<
+		", \"std_deviation\": " << getStdDeviation() <<
+		", \"min\": " << getMin() <<
+		", \"max\": " << getMax() <<
+		", \"p50\": " << getPercentile(50) <<
+		", \"p95\": " << getPercentile(95) <<
+		", \"p99\": " << getPercentile(99) << "}";
+	return buffer.str();
+}
+
 double RuntimeMeasurement::getSum() const {
-	return mSum;
+	return mSum.load(std::memory_order_relaxed);
 }
 
 double RuntimeMeasurement::getAverage() const {
-	return mRunningMean;
+	const uint64_t samples = getSamples();
+	if(samples == 0)
+		return 0.0;
+	return getSum() / samples;
 }
 
 double RuntimeMeasurement::getStdDeviation() const {
-    return std::sqrt(mRunningVariance / mSamples);
+	const uint64_t samples = getSamples();
+	if(samples == 0)
+		return 0.0;
+	const double average = getAverage();
+	return std::sqrt(std::max(0.0, mSumSquared.load(std::memory_order_relaxed) / samples - average*average));
 }
 
 unsigned int RuntimeMeasurement::getSamples() const {
-	return mSamples;
+	return (unsigned int)mSamples.load(std::memory_order_relaxed);
 }
 
 double RuntimeMeasurement::getMax() const {
-	return mMax;
+	return getSamples() == 0 ? 0.0 : mMax.load(std::memory_order_relaxed);
 }
 
 double RuntimeMeasurement::getMin() const {
-	return mMin;
+	return getSamples() == 0 ? 0.0 : mMin.load(std::memory_order_relaxed);
 }
 
 } // end namespace fast
@@ -3,11 +3,17 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
 #include "FAST/Object.hpp"
 
 namespace fast {
 /**
- * A class for a runtime measurement
+ * A class for a runtime measurement.
+ *
+ * Samples can be added from several threads without locking. In addition to the
+ * sum, average, variance, minimum and maximum, a histogram with logarithmically sized bins
+ * is kept, so that percentiles can be estimated with a relative error of about 3%.
+ * Keep the pointer to the measurement to avoid looking it up by name for every sample.
  */
 class FAST_EXPORT  RuntimeMeasurement : public Object {
 public:
@@ -20,18 +26,40 @@ public:
 	double getMax() const;
 	double getMin() const;
 	double getStdDeviation() const;
+	/**
+	 * Estimate a percentile of the samples from the histogram
+	 *
+	 * @param percentile between 0 and 100
+	 * @return runtime in milliseconds
+	 */
+	double getPercentile(double percentile) const;
+	std::string getName() const;
 	std::string print() const;
+	/**
+	 * @return all statistics, including the 50, 95 and 99th percentiles, as a JSON object
+	 */
+	std::string toJSON() const;
+	/**
+	 * Remove all samples
+	 */
+	void reset();
 	virtual ~RuntimeMeasurement() {};
 
+	// Nr of histogram bins per power of two
+	static constexpr int histogramSubBins = 16;
+	// Histogram covers 1 microsecond to 2^40 microseconds
+	static constexpr int histogramBins = 1 + 40*histogramSubBins;
 private:
 	RuntimeMeasurement();
+	static int getHistogramBin(double runtime);
+	static double getHistogramBinValue(int bin);
 
-	double mSum;
-	unsigned int mSamples;
-	double mRunningVariance;
-	double mRunningMean;
-	double mMin;
-	double mMax;
+	std::atomic<double> mSum;
+	std::atomic<double> mSumSquared;
+	std::atomic<uint64_t> mSamples;
+	std::atomic<double> mMin;
+	std::atomic<double> mMax;
+	std::atomic<uint64_t> mHistogram[histogramBins];
 	std::string mName;
 };
 
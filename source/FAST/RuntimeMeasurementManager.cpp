@@ -1,5 +1,9 @@
 #include "RuntimeMeasurementManager.hpp"
 #include "Exception.hpp"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <atomic>
 
 namespace fast {
 
@@ -74,6 +78,7 @@ void RuntimeMeasurementsManager::startRegularTimer(std::string name) {
 	if (!enabled)
 		return;
 
+	std::lock_guard<std::mutex> lock(m_mutex);
 	startTimes[name] = std::chrono::system_clock::now();
 }
 
@@ -81,6 +86,7 @@ void RuntimeMeasurementsManager::stopRegularTimer(std::string name) {
 	if (!enabled)
 		return;
 
+	std::lock_guard<std::mutex> lock(m_mutex);
 	if(startTimes.count(name) == 0)
 	    return;
 
@@ -119,6 +125,7 @@ void RuntimeMeasurementsManager::stopNumberedRegularTimer(std::string name) {
 }
 
 RuntimeMeasurement::pointer RuntimeMeasurementsManager::getTiming(std::string name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
     if(timings.count(name) == 0) {
         // Create a new empty timing
 		RuntimeMeasurement::pointer runtime(new RuntimeMeasurement(name));
@@ -139,12 +146,136 @@ void RuntimeMeasurementsManager::printAll() {
 	if (!enabled)
 		return;
 
+	std::lock_guard<std::mutex> lock(m_mutex);
 	std::map<std::string, RuntimeMeasurement::pointer>::iterator it;
 	for (it = timings.begin(); it != timings.end(); it++) {
 		it->second->print();
 	}
 }
 
+std::string RuntimeMeasurementsManager::toJSON() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::stringstream buffer;
+	buffer << "{";
+	for(auto it = timings.begin(); it != timings.end(); ++it) {
+		if(it != timings.begin())
+			buffer << ", ";
+		buffer << "\"" << it->first << "\": " << it->second->toJSON();
+	}
+	buffer << "}";
+	return buffer.str();
+}
+
+void RuntimeMeasurementsManager::exportJSON(std::string filename) {
+	std::ofstream file(filename);
+	if(!file.is_open())
+		throw Exception("Unable to open file " + filename + " for writing runtime measurements");
+	file << toJSON() << "\n";
+}
+
+namespace {
+struct TraceEvent {
+	std::string name;
+	std::string category;
+	int64_t start;
+	int64_t duration;
+	std::string arguments;
+};
+
+struct TraceBuffer {
+	// Only contended when exporting or clearing
+	std::mutex mutex;
+	int threadID;
+	std::vector<TraceEvent> events;
+};
+
+std::atomic<bool> tracingEnabled(false);
+std::mutex traceBuffersMutex;
+std::vector<std::shared_ptr<TraceBuffer>> traceBuffers;
+
+std::chrono::steady_clock::time_point getTraceEpoch() {
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return epoch;
+}
+
+TraceBuffer& getTraceBuffer() {
+	thread_local std::shared_ptr<TraceBuffer> buffer;
+	if(!buffer) {
+		buffer = std::make_shared<TraceBuffer>();
+		std::lock_guard<std::mutex> lock(traceBuffersMutex);
+		buffer->threadID = traceBuffers.size();
+		traceBuffers.push_back(buffer);
+	}
+	return *buffer;
+}
+
+std::string escapeJSON(const std::string& text) {
+	std::string result;
+	for(char c : text) {
+		if(c == '"' || c == '\\')
+			result += '\\';
+		result += c;
+	}
+	return result;
+}
+}
+
+void RuntimeMeasurementsManager::setTracing(bool tracing) {
+	getTraceEpoch();
+	tracingEnabled = tracing;
+}
+
+bool RuntimeMeasurementsManager::isTracing() {
+	return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+int64_t RuntimeMeasurementsManager::getTraceTime(std::chrono::steady_clock::time_point time) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(time - getTraceEpoch()).count();
+}
+
+void RuntimeMeasurementsManager::addTraceEvent(const std::string& name, const std::string& category,
+		std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+		const std::string& arguments) {
+	if(!isTracing())
+		return;
+	const int64_t startTime = getTraceTime(start);
+	TraceBuffer& buffer = getTraceBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.events.push_back({name, category, startTime, getTraceTime(end) - startTime, arguments});
+}
+
+void RuntimeMeasurementsManager::exportTrace(std::string filename) {
+	std::ofstream file(filename);
+	if(!file.is_open())
+		throw Exception("Unable to open file " + filename + " for writing trace");
+	file << "{\"traceEvents\": [";
+	bool first = true;
+	std::lock_guard<std::mutex> lock(traceBuffersMutex);
+	for(auto&& buffer : traceBuffers) {
+		std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+		for(auto&& event : buffer->events) {
+			if(!first)
+				file << ",";
+			first = false;
+			file << "\n{\"name\": \"" << escapeJSON(event.name) << "\", \"cat\": \"" << escapeJSON(event.category) <<
+				"\", \"ph\": \"X\", \"ts\": " << event.start << ", \"dur\": " << event.duration <<
+				", \"pid\": 0, \"tid\": " << buffer->threadID;
+			if(!event.arguments.empty())
+				file << ", \"args\": " << event.arguments;
+			file << "}";
+		}
+	}
+	file << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+void RuntimeMeasurementsManager::clearTrace() {
+	std::lock_guard<std::mutex> lock(traceBuffersMutex);
+	for(auto&& buffer : traceBuffers) {
+		std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+		buffer->events.clear();
+	}
+}
+
 RuntimeMeasurementsManager::RuntimeMeasurementsManager() {
     enabled = false;
 }
@@ -7,6 +7,7 @@
 #include "RuntimeMeasurement.hpp"
 #include <chrono>
 #include <memory>
+#include <mutex>
 
 
 namespace fast {
@@ -30,10 +31,52 @@ public:
 	void startNumberedRegularTimer(std::string name);
 	void stopNumberedRegularTimer(std::string name);
 
+	/**
+	 * Get a measurement by name. It is created if it doesn't exist.
+	 * The returned measurement can be kept and samples added to it directly,
+	 * which avoids looking it up by name for every sample.
+	 */
 	RuntimeMeasurement::pointer getTiming(std::string name);
 
 	void print(std::string name);
 	void printAll();
+	/**
+	 * @return all measurements as a JSON object with the measurement names as keys
+	 */
+	std::string toJSON();
+	void exportJSON(std::string filename);
+
+	/**
+	 * Enable recording of trace events. When enabled, every execute of every process object is recorded,
+	 * together with the latency of the frame, measured from when the frame was created by the first process
+	 * object in the pipeline. Events are stored in a buffer per thread, thus recording doesn't contend for a lock.
+	 */
+	static void setTracing(bool tracing);
+	static bool isTracing();
+	/**
+	 * Add a trace event
+	 *
+	 * @param name
+	 * @param category
+	 * @param start
+	 * @param end
+	 * @param arguments JSON object with arguments of the event, or empty
+	 */
+	static void addTraceEvent(const std::string& name, const std::string& category,
+			std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+			const std::string& arguments = "");
+	/**
+	 * Get microseconds since tracing started
+	 */
+	static int64_t getTraceTime(std::chrono::steady_clock::time_point time);
+	/**
+	 * Export all trace events in the Chrome trace event format, which can be opened
+	 * in chrome://tracing or https://ui.perfetto.dev
+	 *
+	 * @param filename
+	 */
+	static void exportTrace(std::string filename);
+	static void clearTrace();
 
 private:
 	RuntimeMeasurementsManager();
@@ -42,6 +85,8 @@ private:
 	std::map<std::string, unsigned int> numberings;
 	std::map<std::string, cl::Event> startEvents;
 	std::map<std::string, std::chrono::system_clock::time_point> startTimes;
+	// Guards the maps, as regular timers may be used from several threads
+	std::mutex m_mutex;
 };
 
 } //namespace fast
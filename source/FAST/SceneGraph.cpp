@@ -3,6 +3,9 @@
 
 namespace fast {
 
+// World transform versions of all nodes are drawn from this counter, 0 is reserved for root nodes
+static std::atomic<uint64_t> worldVersionCounter(0);
+
 void SceneGraphNode::reset() {
     // Remove previous parent
     SceneGraphNode::pointer newRootNode = SceneGraphNode::New();
@@ -14,11 +17,13 @@ void SceneGraphNode::reset() {
 // Set transformation to its parent
 void SceneGraphNode::setTransformation(
         AffineTransformation::pointer transformation) {
+    std::lock_guard<std::mutex> lock(mMutex);
     mTransformation = transformation;
     mIsRootNode = false;
 }
 
 void SceneGraphNode::setParent(SceneGraphNode::pointer parent) {
+    std::lock_guard<std::mutex> lock(mMutex);
     mParent = parent;
     mIsRootNode = false;
 }
@@ -30,6 +35,7 @@ bool SceneGraphNode::isDataNode() const {
 SceneGraphNode::pointer SceneGraphNode::getParent() const {
     if(mIsRootNode)
         throw Exception("Can't getParent from a SceneGraphNode that is a root node");
+    std::lock_guard<std::mutex> lock(mMutex);
     return mParent;
 }
 
@@ -38,9 +44,48 @@ bool SceneGraphNode::isRootNode() const {
 }
 
 AffineTransformation::pointer SceneGraphNode::getTransformation() const {
+    std::lock_guard<std::mutex> lock(mMutex);
     return mTransformation;
 }
 
+Affine3f SceneGraphNode::getWorldTransform() {
+    Affine3f transform;
+    getWorldTransform(transform);
+    return transform;
+}
+
+uint64_t SceneGraphNode::getWorldTransform(Affine3f& transform) {
+    if(mIsRootNode) {
+        transform = Affine3f::Identity();
+        return 0;
+    }
+    SceneGraphNode::pointer parent;
+    std::shared_ptr<const AffineTransformation> local;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        parent = mParent;
+        local = mTransformation;
+    }
+    // The parent's world transform is copied to transform, and replaced by this node's world transform below
+    uint64_t parentVersion = 0;
+    if(parent) {
+        parentVersion = parent->getWorldTransform(transform);
+    } else {
+        transform = Affine3f::Identity();
+    }
+    const uint64_t localVersion = local->getVersion();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(mWorldVersion == 0 || parentVersion != mWorldParentVersion || localVersion != mWorldLocalVersion) {
+        mWorldTransform = transform*local->getTransform();
+        mWorldParentVersion = parentVersion;
+        mWorldLocalVersion = localVersion;
+        mWorldVersion = ++worldVersionCounter;
+    }
+    transform = mWorldTransform;
+    return mWorldVersion;
+}
+
 SceneGraphNode::SceneGraphNode() {
     mIsRootNode = true;
     mTransformation = AffineTransformation::New();
@@ -55,25 +100,20 @@ AffineTransformation::pointer SceneGraph::getAffineTransformationBetweenNodes(
 
 AffineTransformation::pointer SceneGraph::getAffineTransformationFromNode(
         SceneGraphNode::pointer node) {
-    SceneGraphNode::pointer currentNode = node;
+    // Callers may modify the returned transformation, thus a new object is always returned
     AffineTransformation::pointer transformation = AffineTransformation::New();
-    while(!currentNode->isRootNode()) {
-        transformation = currentNode->getTransformation()->multiply(transformation);
-        currentNode = currentNode->getParent();
-    }
-
+    *transformation = node->getWorldTransform();
     return transformation;
 }
 
+Eigen::Affine3f SceneGraph::getEigenAffineTransformationFromNode(
+        SceneGraphNode::pointer node) {
+    return node->getWorldTransform();
+}
+
 Eigen::Affine3f SceneGraph::getEigenAffineTransformationFromData(
         SpatialDataObject::pointer data) {
-    SceneGraphNode::pointer currentNode = data->getSceneGraphNode();
-    AffineTransformation::pointer transformation = getAffineTransformationFromNode(currentNode);
-
-    Eigen::Affine3f result;
-    result.matrix() = transformation->getTransform().matrix();
-
-    return result;
+    return data->getSceneGraphNode()->getWorldTransform();
 }
 
 AffineTransformation::pointer SceneGraph::getAffineTransformationFromData(
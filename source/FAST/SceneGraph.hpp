@@ -3,10 +3,18 @@
 
 #include "FAST/AffineTransformation.hpp"
 #include "FAST/Object.hpp"
+#include <mutex>
 
 namespace fast {
 
 
+/**
+ * A node in the scene graph, with a transformation to its parent node.
+ *
+ * Each node caches its transformation to the root, the world transform, together with the versions
+ * of its own transformation and the parent's world transform it was composed from.
+ * The cache is thus invalidated lazily when the transformation of any ancestor changes.
+ */
 class FAST_EXPORT  SceneGraphNode : public Object {
     FAST_OBJECT(SceneGraphNode)
     public:
@@ -14,15 +22,31 @@ class FAST_EXPORT  SceneGraphNode : public Object {
         void setParent(SceneGraphNode::pointer parent);
         SceneGraphNode::pointer getParent() const;
         AffineTransformation::pointer getTransformation() const;
+        /**
+         * Get the transformation from this node to the root node. Does not allocate any objects,
+         * and only composes the transformations of ancestors which have changed since the last call.
+         */
+        Affine3f getWorldTransform();
         void reset();
         bool isDataNode() const;
         bool isRootNode() const;
     private:
         SceneGraphNode();
+        /**
+         * Update the cached world transform if needed, and copy it to the given transform.
+         * @return version of the world transform, 0 is the identity of root nodes
+         */
+        uint64_t getWorldTransform(Affine3f& transform);
 
         SceneGraphNode::pointer mParent;
         bool mIsRootNode;
         AffineTransformation::pointer mTransformation;
+
+        mutable std::mutex mMutex;
+        Affine3f mWorldTransform;
+        uint64_t mWorldVersion = 0;
+        uint64_t mWorldParentVersion = 0;
+        uint64_t mWorldLocalVersion = 0;
 };
 
 class SpatialDataObject;
@@ -30,6 +54,7 @@ class SpatialDataObject;
 namespace SceneGraph {
 	FAST_EXPORT AffineTransformation::pointer getAffineTransformationBetweenNodes(SceneGraphNode::pointer nodeA, SceneGraphNode::pointer nodeB);
 	FAST_EXPORT AffineTransformation::pointer getAffineTransformationFromNode(SceneGraphNode::pointer node);
+	FAST_EXPORT Affine3f getEigenAffineTransformationFromNode(SceneGraphNode::pointer node);
 	FAST_EXPORT AffineTransformation::pointer getAffineTransformationFromData(SharedPointer<SpatialDataObject> node);
 	FAST_EXPORT Affine3f getEigenAffineTransformationFromData(SharedPointer<SpatialDataObject> node);
 	FAST_EXPORT void setParentNode(SharedPointer<SpatialDataObject> child, SharedPointer<SpatialDataObject> parent);
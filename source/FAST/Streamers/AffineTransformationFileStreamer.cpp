@@ -102,7 +102,7 @@ void AffineTransformationFileStreamer::generateStream() {
 			continue;
 
 		AffineTransformation::pointer transformation = AffineTransformation::New();
-		transformation->getTransform().matrix() = matrix;
+		transformation->setTransform(Affine3f(matrix));
 
 		// Set and use timestamp if available
 		if(mTimestampFilename != "") {
@@ -98,6 +98,79 @@ void FileStreamer::setFilenameFormats(std::vector<std::string> strs) {
     mFilenameFormats = strs;
 }
 
+void FileStreamer::setReadAhead(uint frames, uint nrOfThreads) {
+    m_readAhead = frames;
+    m_nrOfReadAheadThreads = nrOfThreads;
+}
+
+void FileStreamer::setPreload(bool preload) {
+    m_preload = preload;
+}
+
+bool FileStreamer::frameExists(uint i, int currentSequence) const {
+    const std::string filename = getFilename(i, currentSequence);
+    if(m_preload)
+        return m_preloadedFrames.count(filename) > 0;
+    return fileExists(filename);
+}
+
+void FileStreamer::preloadFrames() {
+    m_preloadedFrames.clear();
+    ThreadPool pool(m_nrOfReadAheadThreads);
+    std::vector<std::pair<std::string, std::future<DataObject::pointer>>> frames;
+    for(int sequence = 0; sequence < mFilenameFormats.size(); ++sequence) {
+        for(uint i = mStartNumber; mMaximumNrOfFrames <= 0 || i < (uint)mMaximumNrOfFrames; i += mStepSize) {
+            const std::string filename = getFilename(i, sequence);
+            if(!fileExists(filename))
+                break;
+            frames.push_back({filename, pool.submit([this, filename]() { return getDataFrame(filename); })});
+        }
+    }
+    for(auto&& frame : frames)
+        m_preloadedFrames[frame.first] = frame.second.get();
+    reportInfo() << "FileStreamer preloaded " << m_preloadedFrames.size() << " frames" << reportEnd();
+}
+
+DataObject::pointer FileStreamer::readDataFrame(uint i, int currentSequence) {
+    const std::string filename = getFilename(i, currentSequence);
+    if(m_preload) {
+        if(m_preloadedFrames.count(filename) == 0)
+            throw FileNotFoundException(filename);
+        auto frame = m_preloadedFrames[filename];
+        // Frame may have been sent before, make sure it is seen as new data
+        frame->updateModifiedTimestamp();
+        return frame;
+    }
+    if(m_readAhead == 0)
+        return getDataFrame(filename);
+
+    if(!m_readAheadPool)
+        m_readAheadPool = std::make_unique<ThreadPool>(m_nrOfReadAheadThreads > 0 ? m_nrOfReadAheadThreads : m_readAhead);
+    // Start reading this frame and the next frames, if not already started
+    for(uint j = 0; j <= m_readAhead; ++j) {
+        const uint frameNr = i + j*mStepSize;
+        if(mMaximumNrOfFrames > 0 && frameNr >= (uint)mMaximumNrOfFrames)
+            break;
+        const std::string nextFilename = getFilename(frameNr, currentSequence);
+        if(m_framesBeingRead.count(nextFilename) > 0)
+            continue;
+        if(j > 0 && !fileExists(nextFilename))
+            break;
+        m_framesBeingRead[nextFilename] = m_readAheadPool->submit([this, nextFilename]() {
+            return getDataFrame(nextFilename);
+        }).share();
+    }
+    auto frame = m_framesBeingRead[filename];
+    m_framesBeingRead.erase(filename);
+    return frame.get(); // Throws FileNotFoundException if the file doesn't exist
+}
+
+void FileStreamer::stopReadAhead() {
+    // Waits for frames being read, as they use this object
+    m_readAheadPool.reset();
+    m_framesBeingRead.clear();
+}
+
 void FileStreamer::generateStream() {
     // Read timestamp file if available
     std::ifstream timestampFile;
@@ -120,6 +193,9 @@ void FileStreamer::generateStream() {
         }
     }
 
+    if(m_preload)
+        preloadFrames();
+
     uint i = mStartNumber;
     int replays = 0;
     int currentSequence = 0;
@@ -135,7 +211,7 @@ void FileStreamer::generateStream() {
         std::string filename = getFilename(i, currentSequence);
         try {
             reportInfo() << "Filestreamer reading " << filename << reportEnd();
-            DataObject::pointer dataFrame = getDataFrame(filename);
+            DataObject::pointer dataFrame = readDataFrame(i, currentSequence);
             // Set and use timestamp if available
             if(!mTimestampFilename.empty() && mUseTimestamp) {
                 std::string line;
@@ -164,7 +240,8 @@ void FileStreamer::generateStream() {
                 previousTimestampTime = std::chrono::high_resolution_clock::now();
             }
 
-            if(!fileExists(getFilename(i+1, currentSequence)) && !mLoop)
+            const bool maximumReached = mMaximumNrOfFrames > 0 && i + mStepSize >= (uint)mMaximumNrOfFrames;
+            if((maximumReached || !frameExists(i + mStepSize, currentSequence)) && !mLoop)
                 dataFrame->setLastFrame(getNameOfClass());
 
             addOutputData(0, dataFrame);
@@ -172,7 +249,7 @@ void FileStreamer::generateStream() {
             if(mSleepTime > 0)
                 std::this_thread::sleep_for(std::chrono::milliseconds(mSleepTime));
             i += mStepSize;
-            if(i == mMaximumNrOfFrames) {
+            if(mMaximumNrOfFrames > 0 && i >= (uint)mMaximumNrOfFrames) {
                 throw FileNotFoundException();
             }
 
@@ -202,12 +279,14 @@ void FileStreamer::generateStream() {
                 // Reached end of stream
                 break;
             } else {
+                stopReadAhead();
                 throw e;
             }
         } catch(ThreadStopped &e) {
             break;
         }
     }
+    stopReadAhead();
 }
 
 std::string FileStreamer::getFilename(uint i, int currentSequence) const {
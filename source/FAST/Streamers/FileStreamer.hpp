@@ -3,7 +3,9 @@
 #include "FAST/ProcessObject.hpp"
 
 #include <FAST/Streamers/Streamer.hpp>
+#include <FAST/ThreadPool.hpp>
 #include <thread>
+#include <future>
 
 namespace fast {
 
@@ -34,6 +36,22 @@ class FAST_EXPORT FileStreamer : public Streamer {
          * @param use
          */
         void setUseTimestamp(bool use);
+        /**
+         * Read frames ahead while streaming. The next frames are read in parallel by a pool of threads,
+         * and are sent in order, with the same timing as without read-ahead.
+         * Default is 0, which means frames are read one at a time when they are needed.
+         *
+         * @param frames Nr of frames to read ahead
+         * @param nrOfThreads Nr of threads used to read frames. 0 means one thread per frame to read ahead.
+         */
+        void setReadAhead(uint frames, uint nrOfThreads = 0);
+        /**
+         * Load all frames into memory before streaming starts. This removes file reading from the streaming,
+         * which is useful for benchmarking. When replaying/looping, the same data objects are sent again.
+         *
+         * @param preload
+         */
+        void setPreload(bool preload);
 
         ~FileStreamer();
 
@@ -43,6 +61,13 @@ class FAST_EXPORT FileStreamer : public Streamer {
     protected:
         virtual DataObject::pointer getDataFrame(std::string filename) = 0;
         std::string getFilename(uint i, int currentSequence) const;
+        /**
+         * Get frame i of the given sequence from the preloaded frames, the read-ahead or by reading it
+         */
+        DataObject::pointer readDataFrame(uint i, int currentSequence);
+        bool frameExists(uint i, int currentSequence) const;
+        void preloadFrames();
+        void stopReadAhead();
         void generateStream() override;
         FileStreamer();
         void execute();
@@ -61,6 +86,13 @@ class FAST_EXPORT FileStreamer : public Streamer {
         std::vector<std::string> mFilenameFormats;
         std::string mTimestampFilename;
 
+        uint m_readAhead = 0;
+        uint m_nrOfReadAheadThreads = 0;
+        std::unique_ptr<ThreadPool> m_readAheadPool;
+        std::unordered_map<std::string, std::shared_future<DataObject::pointer>> m_framesBeingRead;
+        bool m_preload = false;
+        std::unordered_map<std::string, DataObject::pointer> m_preloadedFrames;
+
 
 };
 
@@ -9,7 +9,12 @@
 #include <igtl/igtlStatusMessage.h>
 #include <igtl/igtlStringMessage.h>
 #include <igtl/igtlClientSocket.h>
+#include <igtl/igtl_image.h>
+#include <igtl/igtl_transform.h>
+#include <igtl/igtl_util.h>
 #include <chrono>
+#include <array>
+#include <algorithm>
 
 namespace fast {
 
@@ -76,26 +81,46 @@ std::vector<std::string> OpenIGTLinkStreamer::getActiveTransformStreamNames() {
     return activeStreams;
 }
 
-static Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer message, ExecutionDevice::pointer device) {
-    Image::pointer image = Image::New();
-    int width, height, depth;
-    message->GetDimensions(width, height, depth);
-    void* data = message->GetScalarPointer();
+static bool receiveAll(igtl::ClientSocket::Pointer socket, void* data, int size) {
+    return size == 0 || socket->Receive(data, size) == size;
+}
+
+template <class T>
+static void swapByteOrder(void* data, std::size_t size) {
+    T* values = (T*)data;
+    for(std::size_t i = 0; i < size; ++i) {
+        uchar* bytes = (uchar*)&values[i];
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+}
+
+/**
+ * Receive the body of an IMAGE message. The pixels are received directly into a pixel buffer from the image
+ * buffer pool, which the image adopts, thus there is no copy or allocation per frame once the pool is warm.
+ *
+ * @return image, or nullptr if the message was skipped because it is not supported
+ */
+static Image::pointer receiveImage(igtl::ClientSocket::Pointer socket, int bodySize) {
+    igtl_image_header header;
+    if(bodySize < IGTL_IMAGE_HEADER_SIZE || !receiveAll(socket, &header, IGTL_IMAGE_HEADER_SIZE))
+        throw Exception("Failed to receive IMAGE message header");
+    igtl_image_convert_byte_order(&header);
+
     DataType type;
-    switch(message->GetScalarType()) {
-        case igtl::ImageMessage::TYPE_INT8:
+    switch(header.scalar_type) {
+        case IGTL_IMAGE_STYPE_TYPE_INT8:
             type = TYPE_INT8;
             break;
-        case igtl::ImageMessage::TYPE_UINT8:
+        case IGTL_IMAGE_STYPE_TYPE_UINT8:
             type = TYPE_UINT8;
             break;
-        case igtl::ImageMessage::TYPE_INT16:
+        case IGTL_IMAGE_STYPE_TYPE_INT16:
             type = TYPE_INT16;
             break;
-        case igtl::ImageMessage::TYPE_UINT16:
+        case IGTL_IMAGE_STYPE_TYPE_UINT16:
             type = TYPE_UINT16;
             break;
-        case igtl::ImageMessage::TYPE_FLOAT32:
+        case IGTL_IMAGE_STYPE_TYPE_FLOAT32:
             type = TYPE_FLOAT;
             break;
         default:
@@ -103,33 +128,80 @@ static Image::pointer createFASTImageFromMessage(igtl::ImageMessage::Pointer mes
             break;
     }
 
-    if(depth == 1) {
-        image->create(width, height, type, message->GetNumComponents(), device, data);
+    const std::size_t dataSize = igtl_image_get_data_size(&header);
+    const bool isSubVolume = header.subvol_size[0] != header.size[0] || header.subvol_size[1] != header.size[1] || header.subvol_size[2] != header.size[2];
+    if(isSubVolume || (std::size_t)bodySize != IGTL_IMAGE_HEADER_SIZE + dataSize) {
+        Reporter::warning() << "Skipping IMAGE message with sub-volume or unexpected body size in OpenIGTLinkStreamer" << Reporter::end();
+        socket->Skip(bodySize - IGTL_IMAGE_HEADER_SIZE);
+        return nullptr;
+    }
+
+    const std::size_t nrOfElements = (std::size_t)header.size[0]*header.size[1]*header.size[2]*header.num_components;
+    auto data = allocatePixelArray(nrOfElements, type);
+    if(!receiveAll(socket, data.get(), dataSize))
+        throw Exception("Failed to receive IMAGE message data");
+
+    const bool isBigEndianData = header.endian == IGTL_IMAGE_ENDIAN_BIG;
+    if(isBigEndianData == (bool)igtl_is_little_endian()) {
+        if(type == TYPE_INT16 || type == TYPE_UINT16) {
+            swapByteOrder<ushort>(data.get(), nrOfElements);
+        } else if(type == TYPE_FLOAT) {
+            swapByteOrder<uint>(data.get(), nrOfElements);
+        }
+    }
+
+    Image::pointer image = Image::New();
+    if(header.size[2] == 1) {
+        image->create(Vector2ui(header.size[0], header.size[1]), type, header.num_components, std::move(data));
     } else {
-        image->create(width, height, depth, type, message->GetNumComponents(), device, data);
+        image->create(Vector3ui(header.size[0], header.size[1], header.size[2]), type, header.num_components, std::move(data));
     }
 
-    auto spacing = std::make_unique<float[]>(3);
-    auto offset = std::make_unique<float[]>(3);
-    message->GetSpacing(spacing.get());
-    message->GetOrigin(offset.get());
-    igtl::Matrix4x4 matrix;
-    message->GetMatrix(matrix);
+    float spacing[3];
+    float origin[3];
+    float normI[3], normJ[3], normK[3];
+    igtl_image_get_matrix(spacing, origin, normI, normJ, normK, &header);
     image->setSpacing(Vector3f(spacing[0], spacing[1], spacing[2]));
-    AffineTransformation::pointer T = AffineTransformation::New();
-    T->getTransform().translation() = Vector3f(offset[0], offset[1], offset[2]);
+    Affine3f transform = Affine3f::Identity();
+    transform.translation() = Vector3f(origin[0], origin[1], origin[2]);
     Matrix3f fastMatrix;
     for(int i = 0; i < 3; i++) {
-    for(int j = 0; j < 3; j++) {
-        fastMatrix(i,j) = matrix[i][j];
-    }}
-    T->getTransform().linear() = fastMatrix;
+        fastMatrix(i, 0) = normI[i];
+        fastMatrix(i, 1) = normJ[i];
+        fastMatrix(i, 2) = normK[i];
+    }
+    transform.linear() = fastMatrix;
+    AffineTransformation::pointer T = AffineTransformation::New();
+    T->setTransform(transform);
     image->getSceneGraphNode()->setTransformation(T);
 
-
     return image;
 }
 
+/**
+ * Receive the body of a TRANSFORM message, without allocating a message object
+ */
+static AffineTransformation::pointer receiveTransform(igtl::ClientSocket::Pointer socket, int bodySize) {
+    if(bodySize != IGTL_TRANSFORM_SIZE) {
+        socket->Skip(bodySize);
+        return nullptr;
+    }
+    std::array<igtl_float32, 12> transform;
+    if(!receiveAll(socket, transform.data(), IGTL_TRANSFORM_SIZE))
+        throw Exception("Failed to receive TRANSFORM message");
+    igtl_transform_convert_byte_order(transform.data());
+
+    // Rotation columns are followed by the translation
+    Matrix4f fastMatrix = Matrix4f::Identity();
+    for(int j = 0; j < 4; j++) {
+    for(int i = 0; i < 3; i++) {
+        fastMatrix(i,j) = transform[j*3 + i];
+    }}
+    AffineTransformation::pointer T = AffineTransformation::New();
+    T->setTransform(Affine3f(fastMatrix));
+    return T;
+}
+
 void OpenIGTLinkStreamer::updateFirstFrameSetFlag() {
     // Check that all output ports have got their first frame
     bool allHaveGotData = true;
@@ -159,6 +231,9 @@ void OpenIGTLinkStreamer::generateStream() {
     igtl::TimeStamp::Pointer ts;
     ts = igtl::TimeStamp::New();
     uint statusMessageCounter = 0;
+    // Format of each image stream, used to detect when the stream description must be updated
+    std::unordered_map<std::string, std::array<int, 5>> imageFormats;
+    auto networkLatency = getRuntime("network-latency");
 
     auto start = std::chrono::high_resolution_clock::now();
 
@@ -211,142 +286,89 @@ void OpenIGTLinkStreamer::generateStream() {
         std::chrono::duration<double, std::milli> duration = now - start;
         uint64_t timestamp = duration.count();
         reportInfo() << "TIMESTAMP converted: " << timestamp << reportEnd();
-        if(strcmp(headerMsg->GetDeviceType(), "TRANSFORM") == 0 && !ignore) {
-            mTransformStreamNames.insert(headerMsg->GetDeviceName());
-            mStreamDescriptions[headerMsg->GetDeviceName()] = "Transform";
-            if(mInFreezeMode) {
-                //unfreezeSignal();
-                mInFreezeMode = false;
-            }
-            statusMessageCounter = 0;
-            igtl::TransformMessage::Pointer transMsg;
-            transMsg = igtl::TransformMessage::New();
-            transMsg->SetMessageHeader(headerMsg);
-            transMsg->AllocatePack();
-            // Receive transform data from the socket
-            mSocketWrapper->socket->Receive(transMsg->GetPackBodyPointer(), transMsg->GetPackBodySize());
-            // Deserialize the transform data
-            // If you want to skip CRC check, call Unpack() without argument.
-            int c = transMsg->Unpack(1);
-
-            if(c & igtl::MessageHeader::UNPACK_BODY) { // if CRC check is OK
-                // Retrive the transform data
-                igtl::Matrix4x4 matrix;
-                transMsg->GetMatrix(matrix);
-                Matrix4f fastMatrix;
-                for(int i = 0; i < 4; i++) {
-                for(int j = 0; j < 4; j++) {
-                    fastMatrix(i,j) = matrix[i][j];
-                }}
-                reportInfo() << fastMatrix << Reporter::end();
-
-                try {
-                    AffineTransformation::pointer T = AffineTransformation::New();
-                    T->getTransform().matrix() = fastMatrix;
-                    T->setCreationTimestamp(timestamp);
-                    addOutputData(mOutputPortDeviceNames[deviceName], T);
-                } catch(NoMoreFramesException &e) {
-                    throw e;
-                } catch(Exception &e) {
-                    reportInfo() << "streamer has been deleted, stop" << Reporter::end();
-                    break;
-                }
-                if(!m_firstFrameIsInserted) {
-                    updateFirstFrameSetFlag();
+        const int bodySize = headerMsg->GetBodySizeToRead();
+        DataObject::pointer frame;
+        try {
+            if(strcmp(headerMsg->GetDeviceType(), "TRANSFORM") == 0 && !ignore) {
+                mTransformStreamNames.insert(deviceName);
+                mStreamDescriptions[deviceName] = "Transform";
+                if(mInFreezeMode) {
+                    //unfreezeSignal();
+                    mInFreezeMode = false;
                 }
-                mNrOfFrames++;
-            }
-        } else if(strcmp(headerMsg->GetDeviceType(), "IMAGE") == 0 && !ignore) {
-            mImageStreamNames.insert(headerMsg->GetDeviceName());
-            if(mInFreezeMode) {
-                //unfreezeSignal();
-                mInFreezeMode = false;
-            }
-            statusMessageCounter = 0;
-            reportInfo() << "Receiving IMAGE data type from device " << headerMsg->GetDeviceName() << Reporter::end();
-
-            // Create a message buffer to receive transform data
-            igtl::ImageMessage::Pointer imgMsg;
-            imgMsg = igtl::ImageMessage::New();
-            imgMsg->SetMessageHeader(headerMsg);
-            imgMsg->AllocatePack();
-
-            // Receive transform data from the socket
-            mSocketWrapper->socket->Receive(imgMsg->GetPackBodyPointer(), imgMsg->GetPackBodySize());
-
-            // Deserialize the transform data
-            // If you want to skip CRC check, call Unpack() without argument.
-            int c = imgMsg->Unpack(1);
-            if(c & igtl::MessageHeader::UNPACK_BODY) { // if CRC check is OK
-
-                // Retrive the image data
-                int size[3]; // image dimension
-                float spacing[3]; // spacing (mm/pixel)
-                int svsize[3]; // sub-volume size
-                int svoffset[3]; // sub-volume offset
-                int scalarType; // scalar type
-                scalarType = imgMsg->GetScalarType();
-                imgMsg->GetDimensions(size);
-                imgMsg->GetSpacing(spacing);
-                imgMsg->GetSubVolume(svsize, svoffset);
-
-                std::string description = "";
-                if(size[2] == 1) {
-                    description = "2D, " + std::to_string(size[0]) + "x" + std::to_string(size[1]);
-                } else {
-                    description = "3D, " + std::to_string(size[0]) + "x" + std::to_string(size[1]) + "x" + std::to_string(size[2]);
+                statusMessageCounter = 0;
+                frame = receiveTransform(mSocketWrapper->socket, bodySize);
+            } else if(strcmp(headerMsg->GetDeviceType(), "IMAGE") == 0 && !ignore) {
+                mImageStreamNames.insert(deviceName);
+                if(mInFreezeMode) {
+                    //unfreezeSignal();
+                    mInFreezeMode = false;
                 }
-                description += ", " + std::to_string(imgMsg->GetNumComponents()) + " channels, " + std::to_string(imgMsg->GetScalarSize()*8) + "bit";
-                mStreamDescriptions[headerMsg->GetDeviceName()] = description;
-
-                try {
-                    Image::pointer image = createFASTImageFromMessage(imgMsg, getMainDevice());
-                    image->setCreationTimestamp(timestamp);
-                    addOutputData(mOutputPortDeviceNames[deviceName], image);
-                } catch(NoMoreFramesException &e) {
-                    throw e;
-                } catch(Exception &e) {
-                    reportInfo() << "streamer has been deleted, stop" << Reporter::end();
-                    break;
+                statusMessageCounter = 0;
+                reportInfo() << "Receiving IMAGE data type from device " << deviceName << Reporter::end();
+                auto image = receiveImage(mSocketWrapper->socket, bodySize);
+                if(image) {
+                    // Only recreate the description when the format of the stream changes
+                    const std::array<int, 5> format = {image->getWidth(), image->getHeight(), image->getDepth(), image->getNrOfChannels(), (int)image->getDataType()};
+                    if(imageFormats.count(deviceName) == 0 || imageFormats[deviceName] != format) {
+                        imageFormats[deviceName] = format;
+                        std::string description = "";
+                        if(image->getDimensions() == 2) {
+                            description = "2D, " + std::to_string(image->getWidth()) + "x" + std::to_string(image->getHeight());
+                        } else {
+                            description = "3D, " + std::to_string(image->getWidth()) + "x" + std::to_string(image->getHeight()) + "x" + std::to_string(image->getDepth());
+                        }
+                        description += ", " + std::to_string(image->getNrOfChannels()) + " channels, " + std::to_string(getSizeOfDataType(image->getDataType(), 1)*8) + "bit";
+                        mStreamDescriptions[deviceName] = description;
+                    }
                 }
-                if(!m_firstFrameIsInserted) {
-                    updateFirstFrameSetFlag();
+                frame = image;
+            } else if(strcmp(headerMsg->GetDeviceType(), "STATUS") == 0) {
+                ++statusMessageCounter;
+                reportInfo() << "STATUS MESSAGE recieved" << Reporter::end();
+                mSocketWrapper->socket->Skip(bodySize);
+                if(statusMessageCounter > 3 && !mInFreezeMode) {
+                    reportInfo() << "3 STATUS MESSAGE received, freeze detected" << Reporter::end();
+                    mInFreezeMode = true;
+                    //freezeSignal();
+
+                    // If no frames has been inserted, stop
+                    frameAdded();
                 }
-                mNrOfFrames++;
-            }
-        } else if(strcmp(headerMsg->GetDeviceType(), "STATUS") == 0) {
-            ++statusMessageCounter;
-            reportInfo() << "STATUS MESSAGE recieved" << Reporter::end();
-            // Receive generic message
-            igtl::MessageBase::Pointer message;
-            message = igtl::MessageBase::New();
-            message->SetMessageHeader(headerMsg);
-            message->AllocatePack();
-
-            // Receive transform data from the socket
-            mSocketWrapper->socket->Receive(message->GetPackBodyPointer(), message->GetPackBodySize());
-            if(statusMessageCounter > 3 && !mInFreezeMode) {
-                reportInfo() << "3 STATUS MESSAGE received, freeze detected" << Reporter::end();
-                mInFreezeMode = true;
-                //freezeSignal();
-
-                // If no frames has been inserted, stop
-                frameAdded();
+            } else {
+                // Skip messages which are not used
+                mSocketWrapper->socket->Skip(bodySize);
             }
-       } else {
-           // Receive generic message
-          igtl::MessageBase::Pointer message;
-          message = igtl::MessageBase::New();
-          message->SetMessageHeader(headerMsg);
-          message->AllocatePack();
-
-          // Receive transform data from the socket
-          mSocketWrapper->socket->Receive(message->GetPackBodyPointer(), message->GetPackBodySize());
-
-          // Deserialize the transform data
-          // If you want to skip CRC check, call Unpack() without argument.
-          int c = message->Unpack();
-       }
+        } catch(Exception &e) {
+            reportError() << e.what() << reportEnd();
+            mSocketWrapper->socket->CloseSocket();
+            break;
+        }
+        if(!frame)
+            continue;
+
+        frame->setCreationTimestamp(timestamp);
+        // Latency from the device time stamp to arrival, requires the clocks of the device and this computer to be synchronized
+        const double deviceTime = ts->GetTimeStamp();
+        if(deviceTime > 0) {
+            const double arrivalTime = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            const double latency = (arrivalTime - deviceTime)*1000.0;
+            frame->setFrameData("igtl-device-timestamp", std::to_string(deviceTime));
+            frame->setFrameData("igtl-network-latency", std::to_string(latency));
+            networkLatency->addSample(latency);
+        }
+        try {
+            addOutputData(mOutputPortDeviceNames[deviceName], frame);
+        } catch(NoMoreFramesException &e) {
+            throw e;
+        } catch(Exception &e) {
+            reportInfo() << "streamer has been deleted, stop" << Reporter::end();
+            break;
+        }
+        if(!m_firstFrameIsInserted) {
+            updateFirstFrameSetFlag();
+        }
+        mNrOfFrames++;
     }
     // Make sure we end the waiting thread if first frame has not been inserted
     frameAdded();
@@ -15,6 +15,13 @@ namespace fast {
 class Image;
 class IGTLSocketWrapper;
 
+/**
+ * Streams images and transforms from an OpenIGTLink server.
+ *
+ * Image pixels are received directly into pooled pixel buffers which the output images adopt.
+ * If the messages have a device time stamp, the time from it to arrival is added to each frame as the
+ * frame data "igtl-network-latency" (milliseconds), and to the runtime measurement "network-latency".
+ */
 class FAST_EXPORT OpenIGTLinkStreamer : public Streamer {
     FAST_OBJECT(OpenIGTLinkStreamer)
     public:
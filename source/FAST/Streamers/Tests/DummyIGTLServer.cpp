@@ -80,6 +80,9 @@ static igtl::ImageMessage::Pointer createIGTLImageMessage(Image::pointer image)
     imgMsg->SetScalarType(scalarType);
     imgMsg->SetDeviceName("DummyImage");
     imgMsg->SetSubVolume(size, svoffset);
+    igtl::TimeStamp::Pointer timestamp = igtl::TimeStamp::New();
+    timestamp->GetTime();
+    imgMsg->SetTimeStamp(timestamp);
     imgMsg->AllocateScalars();
 
     ImageAccess::pointer access = image->getImageAccess(ACCESS_READ);
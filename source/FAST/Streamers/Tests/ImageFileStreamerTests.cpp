@@ -17,3 +17,34 @@ TEST_CASE("No hash tag in filename format given to ImageFileStreamer", "[fast][I
     CHECK_THROWS(mhdStreamer->setFilenameFormat("asd"));
 }
 
+
+static std::vector<float> streamAverageIntensities(ImageFileStreamer::pointer streamer) {
+    streamer->setFilenameFormat(Config::getTestDataPath() + "US/JugularVein/US-2D_#.mhd");
+    streamer->setMaximumNumberOfFrames(20);
+    auto port = streamer->getOutputPort();
+    streamer->update();
+    std::vector<float> intensities;
+    Image::pointer image;
+    do {
+        image = port->getNextFrame<Image>();
+        intensities.push_back(image->calculateAverageIntensity());
+    } while(!image->isLastFrame());
+    return intensities;
+}
+
+TEST_CASE("ImageFileStreamer with read-ahead sends same frames in same order", "[fast][ImageFileStreamer]") {
+    auto expected = streamAverageIntensities(ImageFileStreamer::New());
+    CHECK(expected.size() == 20);
+
+    auto streamer = ImageFileStreamer::New();
+    streamer->setReadAhead(4, 2);
+    CHECK(streamAverageIntensities(streamer) == expected);
+}
+
+TEST_CASE("ImageFileStreamer with preloading sends same frames in same order", "[fast][ImageFileStreamer]") {
+    auto expected = streamAverageIntensities(ImageFileStreamer::New());
+
+    auto streamer = ImageFileStreamer::New();
+    streamer->setPreload(true);
+    CHECK(streamAverageIntensities(streamer) == expected);
+}
@@ -4,6 +4,9 @@
 #include "FAST/Visualization/ImageRenderer/ImageRenderer.hpp"
 #include "FAST/Visualization/SimpleWindow.hpp"
 #include "FAST/Algorithms/AddTransformation/AddTransformation.hpp"
+#include "FAST/Importers/ImageFileImporter.hpp"
+#include "FAST/Data/ImageBufferPool.hpp"
+#include <cstring>
 
 using namespace fast;
 
@@ -32,3 +35,46 @@ TEST_CASE("Stream 2D images using OpenIGTLinkStreamer", "[OpenIGTLinkStreamer][f
     window->setTimeout(5000);
     CHECK_NOTHROW(window->start());
 }
+
+TEST_CASE("Stream 3D volumes using OpenIGTLinkStreamer from loopback server", "[OpenIGTLinkStreamer][fast][IGTLink]") {
+    const auto streamingMode = Config::getStreamingMode();
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    const int frames = 10;
+
+    auto importer = ImageFileImporter::New();
+    importer->setFilename(Config::getTestDataPath() + "US/Ball/US-3Dt_0.mhd");
+    auto expected = importer->updateAndGetOutputData<Image>();
+
+    auto fileStreamer = ImageFileStreamer::New();
+    fileStreamer->setFilenameFormat(Config::getTestDataPath() + "US/Ball/US-3Dt_#.mhd");
+    DummyIGTLServer server;
+    server.setImageStreamer(fileStreamer);
+    server.setPort(18945);
+    server.setFramesPerSecond(50);
+    server.setMaximumFramesToSend(frames);
+    server.start();
+
+    auto streamer = OpenIGTLinkStreamer::New();
+    streamer->setConnectionAddress("localhost");
+    streamer->setConnectionPort(18945);
+    auto port = streamer->getOutputPort<Image>("DummyImage");
+
+    const uint64_t poolHits = ImageBufferPool::getInstance()->getNrOfHits();
+    for(int i = 0; i < frames; ++i) {
+        streamer->update();
+        auto image = port->getNextFrame<Image>();
+        CHECK(image->getSize() == expected->getSize());
+        CHECK(image->getDataType() == expected->getDataType());
+        CHECK(image->getFrameData().count("igtl-network-latency") == 1);
+        if(i == 0) {
+            auto access = image->getImageAccess(ACCESS_READ);
+            auto expectedAccess = expected->getImageAccess(ACCESS_READ);
+            CHECK(std::memcmp(access->get(), expectedAccess->get(), expected->getNrOfVoxels()*getSizeOfDataType(expected->getDataType(), expected->getNrOfChannels())) == 0);
+        }
+    }
+    // Pixel buffers of received frames are reused
+    CHECK(ImageBufferPool::getInstance()->getNrOfHits() > poolHits);
+    CHECK(streamer->getRuntime("network-latency")->getSamples() >= frames);
+    streamer->stop();
+    Config::setStreamingMode(streamingMode);
+}
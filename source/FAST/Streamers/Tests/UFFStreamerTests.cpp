@@ -0,0 +1,188 @@
+#include "FAST/Testing.hpp"
+#include "FAST/Streamers/UFFStreamer.hpp"
+#include "FAST/Streamers/UFFStreamerKernels.hpp"
+#include "FAST/Data/Image.hpp"
+#define H5_BUILT_AS_DYNAMIC_LIB
+#include <H5Cpp.h>
+#include <random>
+
+using namespace fast;
+
+static std::vector<float> createRandomData(std::size_t size, int seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+    std::vector<float> data(size);
+    for(auto&& value : data)
+        value = distribution(generator);
+    return data;
+}
+
+// Reference envelope of a column major IQ frame, stored row major
+static std::vector<float> calculateReferenceEnvelope(const std::vector<float>& real, const std::vector<float>& imaginary, int width, int height, bool logCompression) {
+    std::vector<float> result((std::size_t)width*height);
+    for(int y = 0; y < height; ++y) {
+        for(int x = 0; x < width; ++x) {
+            const std::size_t pos = (std::size_t)x*height + y;
+            float envelope = std::sqrt(real[pos]*real[pos] + imaginary[pos]*imaginary[pos]);
+            if(logCompression)
+                envelope = 20.0f*std::log10(envelope);
+            result[(std::size_t)y*width + x] = envelope;
+        }
+    }
+    return result;
+}
+
+TEST_CASE("UFF envelope matches CPU reference", "[fast][UFFStreamer]") {
+    // Sizes which are not a multiple of the vector width test the scalar remainder
+    for(int size : {1, 3, 4, 7, 8, 9, 16, 37}) {
+        auto real = createRandomData(size, 1);
+        auto imaginary = createRandomData(size, 2);
+        for(bool power : {false, true}) {
+            std::vector<float> output(size);
+            calculateEnvelope(real.data(), imaginary.data(), output.data(), size, power);
+            for(int i = 0; i < size; ++i) {
+                const float expected = real[i]*real[i] + imaginary[i]*imaginary[i];
+                CHECK(output[i] == Approx(power ? expected : std::sqrt(expected)));
+            }
+        }
+    }
+}
+
+TEST_CASE("UFF tiled envelope matches CPU reference", "[fast][UFFStreamer]") {
+    // Sizes which are not a multiple of the tile size test the border tiles
+    for(auto size : std::vector<std::pair<int, int>>{{32, 32}, {45, 70}, {1, 100}, {100, 1}}) {
+        const int width = size.first;
+        const int height = size.second;
+        auto real = createRandomData((std::size_t)width*height, 1);
+        auto imaginary = createRandomData((std::size_t)width*height, 2);
+        for(bool logCompression : {false, true}) {
+            auto expected = calculateReferenceEnvelope(real, imaginary, width, height, logCompression);
+            std::vector<float> output((std::size_t)width*height);
+            calculateEnvelopeTiled(real.data(), imaginary.data(), output.data(), width, height, logCompression);
+            for(std::size_t i = 0; i < output.size(); ++i)
+                CHECK(output[i] == Approx(expected[i]).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("UFF tiled transpose matches CPU reference", "[fast][UFFStreamer]") {
+    const int width = 45;
+    const int height = 70;
+    std::vector<uchar> input((std::size_t)width*height);
+    for(std::size_t i = 0; i < input.size(); ++i)
+        input[i] = (uchar)(i % 251);
+    std::vector<uchar> output((std::size_t)width*height);
+    transposeTiled(input.data(), output.data(), width, height, 1, 0);
+
+    auto real = createRandomData((std::size_t)width*height, 1);
+    auto imaginary = createRandomData((std::size_t)width*height, 2);
+    std::vector<float> outputIQ((std::size_t)width*height*2);
+    transposeTiled(real.data(), outputIQ.data(), width, height, 2, 0);
+    transposeTiled(imaginary.data(), outputIQ.data(), width, height, 2, 1);
+
+    for(int y = 0; y < height; ++y) {
+        for(int x = 0; x < width; ++x) {
+            const std::size_t pos = (std::size_t)x*height + y;
+            const std::size_t outputPos = (std::size_t)y*width + x;
+            CHECK(output[outputPos] == input[pos]);
+            CHECK(outputIQ[outputPos*2] == real[pos]);
+            CHECK(outputIQ[outputPos*2 + 1] == imaginary[pos]);
+        }
+    }
+}
+
+static void writeStringAttribute(H5::Group& group, std::string name, std::string value) {
+    H5::StrType type(H5::PredType::C_S1, H5T_VARIABLE);
+    auto attribute = group.createAttribute(name, type, H5::DataSpace(H5S_SCALAR));
+    attribute.write(type, value);
+}
+
+static void writeDataset(H5::Group& group, std::string name, const std::vector<float>& data, int rank, const hsize_t* dims) {
+    H5::DataSpace dataspace(rank, dims);
+    auto dataset = group.createDataSet(name, H5::PredType::NATIVE_FLOAT, dataspace);
+    dataset.write(data.data(), H5::PredType::NATIVE_FLOAT);
+}
+
+// Write a UFF file with beamformed IQ data which is not scan converted
+static void writeUFFFile(std::string filename, const std::vector<float>& real, const std::vector<float>& imaginary, int width, int height, int frames) {
+    H5::H5File file(filename, H5F_ACC_TRUNC);
+    auto group = file.createGroup("/beamformed_data");
+    writeStringAttribute(group, "class", "uff.beamformed_data");
+    auto scanGroup = file.createGroup("/beamformed_data/scan");
+    writeStringAttribute(scanGroup, "class", "uff.linear_scan");
+    std::vector<float> xAxis(width), zAxis(height);
+    for(int i = 0; i < width; ++i)
+        xAxis[i] = i*0.0003f;
+    for(int i = 0; i < height; ++i)
+        zAxis[i] = i*0.0001f;
+    const hsize_t xDims[2] = {1, (hsize_t)width};
+    const hsize_t zDims[2] = {1, (hsize_t)height};
+    writeDataset(scanGroup, "x_axis", xAxis, 2, xDims);
+    writeDataset(scanGroup, "z_axis", zAxis, 2, zDims);
+    auto dataGroup = file.createGroup("/beamformed_data/data");
+    const hsize_t dataDims[4] = {(hsize_t)frames, 1, 1, (hsize_t)width*height};
+    writeDataset(dataGroup, "real", real, 4, dataDims);
+    writeDataset(dataGroup, "imag", imaginary, 4, dataDims);
+}
+
+static std::vector<Image::pointer> streamUFFFile(std::string filename, bool outputIQ, bool logCompression) {
+    auto streamer = UFFStreamer::New();
+    streamer->setFilename(filename);
+    streamer->setOutputIQ(outputIQ);
+    streamer->setLogCompression(logCompression);
+    auto port = streamer->getOutputPort();
+    streamer->update();
+    std::vector<Image::pointer> images;
+    Image::pointer image;
+    do {
+        image = port->getNextFrame<Image>();
+        images.push_back(image);
+    } while(!image->isLastFrame());
+    return images;
+}
+
+TEST_CASE("UFFStreamer envelope, IQ and log compression output", "[fast][UFFStreamer]") {
+    const int width = 45;
+    const int height = 70;
+    const int frames = 3;
+    const std::size_t frameSize = (std::size_t)width*height;
+    auto real = createRandomData(frameSize*frames, 1);
+    auto imaginary = createRandomData(frameSize*frames, 2);
+    const std::string filename = "UFFStreamerTest.uff";
+    writeUFFFile(filename, real, imaginary, width, height, frames);
+
+    for(bool logCompression : {false, true}) {
+        auto images = streamUFFFile(filename, false, logCompression);
+        REQUIRE(images.size() == frames);
+        for(int frame = 0; frame < frames; ++frame) {
+            std::vector<float> frameReal(real.begin() + frame*frameSize, real.begin() + (frame+1)*frameSize);
+            std::vector<float> frameImaginary(imaginary.begin() + frame*frameSize, imaginary.begin() + (frame+1)*frameSize);
+            auto expected = calculateReferenceEnvelope(frameReal, frameImaginary, width, height, logCompression);
+            auto image = images[frame];
+            CHECK(image->getWidth() == width);
+            CHECK(image->getHeight() == height);
+            CHECK(image->getNrOfChannels() == 1);
+            auto access = image->getImageAccess(ACCESS_READ);
+            auto data = (float*)access->get();
+            for(std::size_t i = 0; i < frameSize; ++i)
+                CHECK(data[i] == Approx(expected[i]).margin(1e-4));
+        }
+    }
+
+    auto images = streamUFFFile(filename, true, false);
+    REQUIRE(images.size() == frames);
+    for(int frame = 0; frame < frames; ++frame) {
+        auto image = images[frame];
+        CHECK(image->getNrOfChannels() == 2);
+        auto access = image->getImageAccess(ACCESS_READ);
+        auto data = (float*)access->get();
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                const std::size_t pos = frame*frameSize + (std::size_t)x*height + y;
+                const std::size_t outputPos = (std::size_t)y*width + x;
+                CHECK(data[outputPos*2] == real[pos]);
+                CHECK(data[outputPos*2 + 1] == imaginary[pos]);
+            }
+        }
+    }
+}
@@ -1,7 +1,9 @@
 #include "UFFStreamer.hpp"
+#include "UFFStreamerKernels.hpp"
 #include <FAST/Data/Image.hpp>
 #define H5_BUILT_AS_DYNAMIC_LIB
 #include <H5Cpp.h>
+#include <future>
 
 namespace fast {
 
@@ -12,12 +14,16 @@ namespace fast {
         createStringAttribute("filename", "Filename", "File to stream UFF data from", "");
         createStringAttribute("name", "Group name", "Name of which beamformed_data group to stream from", "");
         createBooleanAttribute("loop", "Loop", "Loop recordin", false);
+        createBooleanAttribute("iq", "IQ", "Output IQ data as a two-channel image instead of the envelope", false);
+        createBooleanAttribute("log-compression", "Log compression", "Log compress the envelope to decibels", false);
     }
 
     void UFFStreamer::loadAttributes() {
         setFilename(getStringAttribute("filename"));
         setLooping(getBooleanAttribute("loop"));
         setName(getStringAttribute("name"));
+        setOutputIQ(getBooleanAttribute("iq"));
+        setLogCompression(getBooleanAttribute("log-compression"));
     }
 
     void UFFStreamer::setLooping(bool loop) {
@@ -34,6 +40,16 @@ namespace fast {
         setModified(true);
     }
 
+    void UFFStreamer::setOutputIQ(bool iq) {
+        m_outputIQ = iq;
+        setModified(true);
+    }
+
+    void UFFStreamer::setLogCompression(bool logCompression) {
+        m_logCompression = logCompression;
+        setModified(true);
+    }
+
     static std::string readStringAttribute(const H5::Attribute& att) {        
         std::string result;
         att.read(att.getDataType(), result);
@@ -148,119 +164,119 @@ namespace fast {
             group = file.openGroup(selectedGroupName);
             scanconverted = true;
         }
+        if(scanconverted && m_outputIQ)
+            reportWarning() << "UFF data is scan converted, thus IQ data can't be output" << reportEnd();
+        if(m_logCompression && (scanconverted || m_outputIQ))
+            reportWarning() << "Log compression in UFFStreamer is only applied to the envelope of IQ data, and is ignored" << reportEnd();
+
+        int frameCount;
+        // Two sets of read buffers: One frame is read while the previous one is processed
+        std::vector<float> real[2], imaginary[2];
+        std::vector<uchar> scanconvertedData[2];
+        std::function<void(int, int)> readFrame;
+        std::function<Image::pointer(int)> createImage;
+
+        hsize_t count[4] = { 1, 1, 1, 1 }; // how many blocks to extract
+        hsize_t blockSize[4] = { 1, 1, 1, (hsize_t)width * height }; // block
+        hsize_t offset[4] = { 0, 0, 0, 0 };   // hyperslab offset in the file
+        H5::DataSpace memspace(4, blockSize);
+        H5::DataSet imagDataset, realDataset, dataset;
+        H5::DataSpace imagDataspace, realDataspace, dataspace;
 
-        // TODO refactor duplication of code
         if (!scanconverted) {
-            auto dataset = group.openDataSet("imag");
-            auto dataspace = dataset.getSpace();
+            imagDataset = group.openDataSet("imag");
+            imagDataspace = imagDataset.getSpace();
+            realDataset = group.openDataSet("real");
+            realDataspace = realDataset.getSpace();
             hsize_t dims_out[4];
-            int ndims = dataspace.getSimpleExtentDims(dims_out, NULL);
+            int ndims = imagDataspace.getSimpleExtentDims(dims_out, NULL);
             if (ndims != 4)
                 throw Exception("Exepected 4 dimensions in UFF file, got " + std::to_string(ndims));
-            int frameCount = dims_out[0];
-            reportInfo() << "Nr of frames in UFF file: " << frameCount << reportEnd();
-
-            auto imagDataset = group.openDataSet("imag");
-            auto imagDataspace = imagDataset.getSpace();
-            auto realDataset = group.openDataSet("real");
-            auto realDataspace = realDataset.getSpace();
+            frameCount = dims_out[0];
 
-            hsize_t count[4] = { 1, 1, 1, 1 }; // how many blocks to extract
-            hsize_t blockSize[4] = { 1, 1, 1, width * height }; // block 
-            hsize_t offset[4] = { 0, 0, 0, 0 };   // hyperslab offset in the file     
-
-            H5::DataSpace memspace(4, blockSize);
-
-            while (true) {
-                for (int frameNr = 0; frameNr < frameCount; ++frameNr) {
-                    reportInfo() << "Extracting frame " << frameNr << " in UFF file" << reportEnd();
-                    // Extract 1 frame
-                    auto imaginary = std::make_unique<float[]>(width * height);
-                    auto real = std::make_unique<float[]>(width * height);
-                    offset[0] = frameNr;
-                    imagDataspace.selectHyperslab(H5S_SELECT_SET, count, offset, NULL, blockSize);
-                    imagDataset.read(imaginary.get(), H5::PredType::NATIVE_FLOAT, memspace, imagDataspace);
-                    realDataspace.selectHyperslab(H5S_SELECT_SET, count, offset, NULL, blockSize);
-                    realDataset.read(real.get(), H5::PredType::NATIVE_FLOAT, memspace, realDataspace);
-
-                    // TODO start env
-                    auto image_data = std::make_unique<float[]>(width * height);
-                    for (int y = 0; y < height; ++y) {
-                        for (int x = 0; x < width; ++x) {
-
-                            int pos = y + x * height;
-                            image_data[x + y * width] = std::sqrt(imaginary[pos] * imaginary[pos] + real[pos] * real[pos]);
-                        }
-                    }
-                    // TODO end env
-                    auto image = Image::New();
-                    image->create(width, height, DataType::TYPE_FLOAT, 1, std::move(image_data));
-                    //image->setSpacing(spacing);
-                    //std::cout << image->calculateMaximumIntensity() << " " << image->calculateMinimumIntensity() << std::endl;
-
-                    try {
-                        addOutputData(0, image);
-                        frameAdded();
-                    }
-                    catch (ThreadStopped & e) {
-                        break;
-                    }
-                }
-                if (!m_loop) {
-                    break;
-                }
+            for(int i = 0; i < 2; ++i) {
+                real[i].resize((std::size_t)width * height);
+                imaginary[i].resize((std::size_t)width * height);
             }
+            readFrame = [&](int frameNr, int buffer) {
+                offset[0] = frameNr;
+                imagDataspace.selectHyperslab(H5S_SELECT_SET, count, offset, NULL, blockSize);
+                imagDataset.read(imaginary[buffer].data(), H5::PredType::NATIVE_FLOAT, memspace, imagDataspace);
+                realDataspace.selectHyperslab(H5S_SELECT_SET, count, offset, NULL, blockSize);
+                realDataset.read(real[buffer].data(), H5::PredType::NATIVE_FLOAT, memspace, realDataspace);
+            };
+            createImage = [&](int buffer) {
+                auto image = Image::New();
+                if(m_outputIQ) {
+                    auto data = allocatePixelArray((std::size_t)width * height * 2, TYPE_FLOAT);
+                    transposeTiled(real[buffer].data(), (float*)data.get(), width, height, 2, 0);
+                    transposeTiled(imaginary[buffer].data(), (float*)data.get(), width, height, 2, 1);
+                    image->create(Vector2ui(width, height), TYPE_FLOAT, 2, std::move(data));
+                } else {
+                    auto data = allocatePixelArray((std::size_t)width * height, TYPE_FLOAT);
+                    calculateEnvelopeTiled(real[buffer].data(), imaginary[buffer].data(), (float*)data.get(), width, height, m_logCompression);
+                    image->create(Vector2ui(width, height), TYPE_FLOAT, 1, std::move(data));
+                }
+                //image->setSpacing(spacing);
+                return image;
+            };
         } else {
-            auto dataset = group.openDataSet("data");
-            auto dataspace = dataset.getSpace();
+            dataset = group.openDataSet("data");
+            dataspace = dataset.getSpace();
             hsize_t dims_out[4];
             int ndims = dataspace.getSimpleExtentDims(dims_out, NULL);
             if (ndims != 4)
                 throw Exception("Exepected 4 dimensions in UFF file, got " + std::to_string(ndims));
-            int frameCount = dims_out[0];
-            reportInfo() << "Nr of frames in UFF file: " << frameCount << reportEnd();
-
-            hsize_t count[4] = { 1, 1, 1, 1 }; // how many blocks to extract
-            hsize_t blockSize[4] = { 1, 1, 1, width * height }; // block 
-            hsize_t offset[4] = { 0, 0, 0, 0 };   // hyperslab offset in the file     
-
-            H5::DataSpace memspace(4, blockSize);
-
-            while (true) {
-                for (int frameNr = 0; frameNr < frameCount; ++frameNr) {
-                    reportInfo() << "Extracting frame " << frameNr << " in UFF file" << reportEnd();
-                    // Extract 1 frame
-                    auto data = std::make_unique<uchar[]>(width * height);
-                    offset[0] = frameNr;
-                    dataspace.selectHyperslab(H5S_SELECT_SET, count, offset, NULL, blockSize);
-                    dataset.read(data.get(), H5::PredType::NATIVE_UCHAR, memspace, dataspace);
-
-                    auto image_data = std::make_unique<uchar[]>(width * height);
-                    for (int y = 0; y < height; ++y) {
-                        for (int x = 0; x < width; ++x) {
-
-                            int pos = y + x * height;
-                            image_data[x + y * width] = data[pos];
-                        }
-                    }
-
-                    auto image = Image::New();
-                    image->create(width, height, DataType::TYPE_UINT8, 1, std::move(image_data));
-                    image->setSpacing(spacing);
-
-                    try {
-                        addOutputData(0, image);
-                        frameAdded();
-                    }
-                    catch (ThreadStopped & e) {
-                        break;
-                    }
-                }
-                if (!m_loop) {
-                    break;
-                }
+            frameCount = dims_out[0];
+
+            for(int i = 0; i < 2; ++i)
+                scanconvertedData[i].resize((std::size_t)width * height);
+            readFrame = [&](int frameNr, int buffer) {
+                offset[0] = frameNr;
+                dataspace.selectHyperslab(H5S_SELECT_SET, count, offset, NULL, blockSize);
+                dataset.read(scanconvertedData[buffer].data(), H5::PredType::NATIVE_UCHAR, memspace, dataspace);
+            };
+            createImage = [&](int buffer) {
+                auto data = allocatePixelArray((std::size_t)width * height, TYPE_UINT8);
+                transposeTiled(scanconvertedData[buffer].data(), (uchar*)data.get(), width, height, 1, 0);
+                auto image = Image::New();
+                image->create(Vector2ui(width, height), TYPE_UINT8, 1, std::move(data));
+                image->setSpacing(spacing);
+                return image;
+            };
+        }
+        reportInfo() << "Nr of frames in UFF file: " << frameCount << reportEnd();
+
+        int frameNr = 0;
+        int buffer = 0;
+        std::future<void> nextFrameRead = std::async(std::launch::async, readFrame, frameNr, buffer);
+        while(true) {
+            reportInfo() << "Extracting frame " << frameNr << " in UFF file" << reportEnd();
+            nextFrameRead.get();
+            // Read the next frame in the background while this frame is processed
+            int nextFrameNr = frameNr + 1;
+            if(nextFrameNr == frameCount)
+                nextFrameNr = m_loop ? 0 : -1;
+            if(nextFrameNr >= 0)
+                nextFrameRead = std::async(std::launch::async, readFrame, nextFrameNr, 1 - buffer);
+
+            auto image = createImage(buffer);
+            if(nextFrameNr < 0)
+                image->setLastFrame(getNameOfClass());
+            try {
+                addOutputData(0, image);
+                frameAdded();
+            } catch(ThreadStopped &e) {
+                break;
             }
+            if(nextFrameNr < 0)
+                break;
+            frameNr = nextFrameNr;
+            buffer = 1 - buffer;
         }
-}
+        // Finish any read in progress before the buffers and datasets are destroyed
+        if(nextFrameRead.valid())
+            nextFrameRead.wait();
+    }
 
-}
\ No newline at end of file
+}
@@ -13,11 +13,23 @@ public:
 	void setLooping(bool loop);
 	// Set name of which HDF5 group to stream
 	void setName(std::string name);
+	/**
+	 * Output the IQ data as a two-channel float image (real, imaginary) instead of the envelope.
+	 * Only used for data which is not scan converted. Default is false.
+	 */
+	void setOutputIQ(bool iq);
+	/**
+	 * Log compress the envelope to decibels: 20*log10(envelope).
+	 * Ignored, with a warning, if IQ data is output or the data is scan converted. Default is false.
+	 */
+	void setLogCompression(bool logCompression);
 	void loadAttributes() override;
 protected:
 	void generateStream() override;
 	std::string m_filename;
 	std::string m_name;
 	bool m_loop;
+	bool m_outputIQ = false;
+	bool m_logCompression = false;
 };
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Frame processing functions of UFFStreamer
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FAST_UFF_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FAST_UFF_SSE2
+#endif
+
+namespace fast {
+
+    // Frames are stored column major in UFF files. They are transposed in tiles which fit in the L1 cache,
+    // so that both reads and writes are contiguous.
+    static const int UFFTileSize = 32;
+
+    // Envelope, or squared envelope if power is true, of contiguous IQ samples
+    inline void calculateEnvelope(const float* real, const float* imaginary, float* output, int size, bool power) {
+        int i = 0;
+#if defined(FAST_UFF_AVX)
+        for(; i + 8 <= size; i += 8) {
+            const __m256 re = _mm256_loadu_ps(real + i);
+            const __m256 im = _mm256_loadu_ps(imaginary + i);
+            const __m256 result = _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+            _mm256_storeu_ps(output + i, power ? result : _mm256_sqrt_ps(result));
+        }
+#elif defined(FAST_UFF_SSE2)
+        for(; i + 4 <= size; i += 4) {
+            const __m128 re = _mm_loadu_ps(real + i);
+            const __m128 im = _mm_loadu_ps(imaginary + i);
+            const __m128 result = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+            _mm_storeu_ps(output + i, power ? result : _mm_sqrt_ps(result));
+        }
+#endif
+        for(; i < size; ++i) {
+            const float result = real[i] * real[i] + imaginary[i] * imaginary[i];
+            output[i] = power ? result : std::sqrt(result);
+        }
+    }
+
+    // Envelope of a column major IQ frame, stored row major in output
+    inline void calculateEnvelopeTiled(const float* real, const float* imaginary, float* output, int width, int height, bool logCompression) {
+        const int tilesX = (width + UFFTileSize - 1) / UFFTileSize;
+        const int tilesY = (height + UFFTileSize - 1) / UFFTileSize;
+        #pragma omp parallel for
+        for(int tile = 0; tile < tilesX * tilesY; ++tile) {
+            float buffer[UFFTileSize * UFFTileSize];
+            const int startX = (tile % tilesX) * UFFTileSize;
+            const int startY = (tile / tilesX) * UFFTileSize;
+            const int sizeX = std::min(UFFTileSize, width - startX);
+            const int sizeY = std::min(UFFTileSize, height - startY);
+            for(int x = 0; x < sizeX; ++x) {
+                const std::size_t pos = (std::size_t)(startX + x) * height + startY;
+                calculateEnvelope(real + pos, imaginary + pos, buffer + x * UFFTileSize, sizeY, logCompression);
+            }
+            if(logCompression) {
+                // 20*log10(envelope) = 10*log10(envelope^2), avoiding the square root
+                for(int x = 0; x < sizeX; ++x) {
+                    for(int y = 0; y < sizeY; ++y)
+                        buffer[y + x * UFFTileSize] = 10.0f * std::log10(std::max(buffer[y + x * UFFTileSize], std::numeric_limits<float>::min()));
+                }
+            }
+            for(int y = 0; y < sizeY; ++y) {
+                float* row = output + (std::size_t)(startY + y) * width + startX;
+                for(int x = 0; x < sizeX; ++x)
+                    row[x] = buffer[y + x * UFFTileSize];
+            }
+        }
+    }
+
+    // Transpose a column major frame into channel of a row major image with the given nr of channels
+    template <class T>
+    inline void transposeTiled(const T* input, T* output, int width, int height, int channels, int channel) {
+        const int tilesX = (width + UFFTileSize - 1) / UFFTileSize;
+        const int tilesY = (height + UFFTileSize - 1) / UFFTileSize;
+        #pragma omp parallel for
+        for(int tile = 0; tile < tilesX * tilesY; ++tile) {
+            const int startX = (tile % tilesX) * UFFTileSize;
+            const int startY = (tile / tilesX) * UFFTileSize;
+            const int endX = std::min(startX + UFFTileSize, width);
+            const int endY = std::min(startY + UFFTileSize, height);
+            for(int y = startY; y < endY; ++y) {
+                for(int x = startX; x < endX; ++x)
+                    output[((std::size_t)y * width + x) * channels + channel] = input[(std::size_t)x * height + y];
+            }
+        }
+    }
+
+}
@@ -0,0 +1,133 @@
+#include <FAST/Testing.hpp>
+#include <FAST/DataChannels/RingBufferDataChannel.hpp>
+#include <FAST/DataChannels/QueuedDataChannel.hpp>
+#include <FAST/DataChannels/NewestFrameDataChannel.hpp>
+#include "DummyObjects.hpp"
+#include <future>
+
+using namespace fast;
+
+TEST_CASE("Ring buffer data channel returns frames in order", "[fast][DataChannel]") {
+    const int frames = 1000;
+    auto channel = RingBufferDataChannel::New();
+    channel->setMaximumNumberOfFrames(8);
+
+    std::thread producer([&channel, frames]() {
+        for(int i = 0; i < frames; ++i) {
+            auto data = DummyDataObject::New();
+            data->create(i);
+            channel->addFrame(data);
+        }
+    });
+    for(int i = 0; i < frames; ++i) {
+        auto data = channel->getNextFrame<DummyDataObject>();
+        REQUIRE(data->getID() == i);
+    }
+    producer.join();
+    CHECK(channel->getSize() == 0);
+}
+
+TEST_CASE("Ring buffer data channel blocks when full", "[fast][DataChannel]") {
+    auto channel = RingBufferDataChannel::New();
+    channel->setMaximumNumberOfFrames(3);
+    channel->setSpinCount(0);
+
+    std::atomic<int> added(0);
+    std::promise<void> full;
+    auto fullFuture = full.get_future();
+    std::thread producer([&channel, &added, &full]() {
+        for(int i = 0; i < 4; ++i) {
+            if(i == 3)
+                full.set_value();
+            auto data = DummyDataObject::New();
+            data->create(i);
+            channel->addFrame(data);
+            ++added;
+        }
+    });
+    // The producer has filled the buffer, the last frame can't be added until a frame is consumed
+    fullFuture.wait();
+    CHECK(added == 3);
+    CHECK(channel->getSize() == 3);
+    CHECK(channel->getFrame() != nullptr);
+    CHECK(channel->getNextFrame<DummyDataObject>()->getID() == 0);
+    producer.join();
+    CHECK(added == 4);
+    CHECK(channel->getSize() == 3);
+}
+
+TEST_CASE("Ring buffer data channel stop unblocks consumer", "[fast][DataChannel]") {
+    auto channel = RingBufferDataChannel::New();
+    channel->setSpinCount(0);
+
+    std::promise<void> started;
+    auto startedFuture = started.get_future();
+    auto consumer = std::async(std::launch::async, [&channel, &started]() {
+        started.set_value();
+        channel->getNextFrame();
+    });
+    // Whether the consumer is parked or not when stop is called, it must throw ThreadStopped
+    startedFuture.wait();
+    channel->stop();
+    CHECK_THROWS_AS(consumer.get(), ThreadStopped);
+    CHECK_THROWS_AS(channel->addFrame(DummyDataObject::New()), ThreadStopped);
+}
+
+TEST_CASE("Ring buffer data channel with several consumers throws", "[fast][DataChannel]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    auto streamer = DummyStreamer::New();
+    auto port = streamer->getOutputPort();
+    REQUIRE(std::dynamic_pointer_cast<RingBufferDataChannel>(port));
+
+    auto po1 = DummyProcessObject::New();
+    auto po2 = DummyProcessObject::New();
+    CHECK_NOTHROW(po1->setInputConnection(port));
+    CHECK_NOTHROW(po1->setInputConnection(port));
+    CHECK_THROWS(po2->setInputConnection(port));
+    CHECK_NOTHROW(po2->setInputConnection(streamer->getOutputPort()));
+}
+
+static void benchmarkDataChannel(std::string name, DataChannel::pointer channel, int frames, std::chrono::microseconds period) {
+    typedef std::chrono::high_resolution_clock Clock;
+    std::vector<Clock::time_point> sent(frames);
+    std::thread producer([&]() {
+        auto next = Clock::now();
+        for(int i = 0; i < frames; ++i) {
+            if(period.count() > 0) {
+                next += period;
+                while(Clock::now() < next); // Busy wait, sleep is too coarse for kHz rates
+            }
+            auto data = DummyDataObject::New();
+            data->create(i);
+            sent[i] = Clock::now();
+            channel->addFrame(data);
+        }
+    });
+    auto start = Clock::now();
+    double latencySum = 0.0;
+    double latencyMax = 0.0;
+    int received = 0;
+    while(received < frames) {
+        auto data = channel->getNextFrame<DummyDataObject>();
+        std::chrono::duration<double, std::micro> latency = Clock::now() - sent[data->getID()];
+        latencySum += latency.count();
+        latencyMax = std::max(latencyMax, latency.count());
+        ++received;
+        if(data->getID() == frames - 1)
+            break; // Newest frame only channel may drop frames
+    }
+    std::chrono::duration<double> duration = Clock::now() - start;
+    producer.join();
+    Reporter::info() << name << " with producer period " << period.count() << " us: " << received / duration.count() << " frames/sec, " <<
+        "wakeup latency mean " << latencySum / received << " us, max " << latencyMax << " us" << Reporter::end();
+}
+
+TEST_CASE("Data channel throughput and wakeup latency", "[fast][DataChannel][benchmark]") {
+    const int frames = 2000;
+    for(auto period : {std::chrono::microseconds(0), std::chrono::microseconds(1000), std::chrono::microseconds(200)}) {
+        benchmarkDataChannel("RingBufferDataChannel", RingBufferDataChannel::New(), frames, period);
+        benchmarkDataChannel("QueuedDataChannel", QueuedDataChannel::New(), frames, period);
+        if(period.count() > 0) // Newest frame only would drop almost all frames with no delay
+            benchmarkDataChannel("NewestFrameDataChannel", NewestFrameDataChannel::New(), frames, period);
+    }
+}
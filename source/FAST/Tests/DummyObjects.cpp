@@ -63,6 +63,58 @@ DummyStreamer::~DummyStreamer() {
     stop();
 }
 
+DummyAsynchronousStreamer::DummyAsynchronousStreamer() {
+    createInputPort<DummyDataObject>(0);
+    createOutputPort<DummyDataObject>(0);
+}
+
+void DummyAsynchronousStreamer::execute() {
+    if(!m_streamIsStarted) {
+        mParent = mInputConnections[0];
+        detachInputConnections();
+        startStream();
+    }
+
+    waitForFirstFrame();
+}
+
+void DummyAsynchronousStreamer::generateStream() {
+    auto po = mParent->getProcessObject();
+    bool firstTime = true;
+    bool lastFrame = false;
+    while(!lastFrame) {
+        {
+            std::lock_guard<std::mutex> lock(m_stopMutex);
+            if(m_stop)
+                break;
+        }
+        if(!firstTime) // Parent was executed before this PO the first time
+            po->update();
+        firstTime = false;
+        DummyDataObject::pointer input;
+        try {
+            input = mParent->getNextFrame<DummyDataObject>();
+        } catch(ThreadStopped &e) {
+            break;
+        }
+        lastFrame = input->isLastFrame();
+        auto output = DummyDataObject::New();
+        output->create(input->getID());
+        if(lastFrame)
+            output->setLastFrame(getNameOfClass());
+        try {
+            addOutputData(0, output);
+        } catch(ThreadStopped &e) {
+            break;
+        }
+        frameAdded();
+    }
+}
+
+DummyAsynchronousStreamer::~DummyAsynchronousStreamer() {
+    stop();
+}
+
 DummyProcessObject2::DummyProcessObject2() {
     createInputPort<DummyDataObject>(0);
     createInputPort<DummyDataObject>(1);
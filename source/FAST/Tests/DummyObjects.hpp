@@ -60,6 +60,28 @@ class DummyProcessObject : public ProcessObject {
 };
 
 
+// Process object which records the IDs of the data it receives, and optionally sleeps to simulate work
+class DummyRecordingProcessObject : public ProcessObject {
+    FAST_OBJECT(DummyRecordingProcessObject)
+    public:
+        void setSleepTime(uint milliseconds) { mSleepTime = milliseconds; };
+        std::vector<uint> getReceivedIDs() { return mReceivedIDs; };
+    private:
+        DummyRecordingProcessObject() {
+            createInputPort<DummyDataObject>(0);
+            createOutputPort<DummyDataObject>(0);
+        };
+        void execute() {
+            auto input = getInputData<DummyDataObject>(0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(mSleepTime));
+            mReceivedIDs.push_back(input->getID());
+            auto output = getOutputData<DummyDataObject>(0);
+            output->create(input->getID());
+        };
+        uint mSleepTime = 0;
+        std::vector<uint> mReceivedIDs;
+};
+
 class DummyProcessObject2 : public ProcessObject {
     FAST_OBJECT(DummyProcessObject2)
     public:
@@ -93,6 +115,21 @@ class DummyStreamer : public Streamer {
 
 };
 
+// Streamer which pulls data from its parent in a separate thread, like the ImageToBatchGenerator
+class DummyAsynchronousStreamer : public Streamer {
+    FAST_OBJECT(DummyAsynchronousStreamer)
+    public:
+        ~DummyAsynchronousStreamer();
+    protected:
+        void execute() override;
+        void generateStream() override;
+        bool hasAsynchronousInputs() override { return true; };
+    private:
+        DummyAsynchronousStreamer();
+
+        DataChannel::pointer mParent;
+};
+
 class DummyImporter : public ProcessObject {
     FAST_OBJECT(DummyImporter)
     public:
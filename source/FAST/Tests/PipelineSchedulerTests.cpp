@@ -0,0 +1,121 @@
+#include <FAST/Testing.hpp>
+#include <FAST/PipelineScheduler.hpp>
+#include "DummyObjects.hpp"
+
+using namespace fast;
+
+TEST_CASE("Pipeline scheduler processes all frames of a stream in order", "[fast][PipelineScheduler]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    const int frames = 20;
+    auto streamer = DummyStreamer::New();
+    streamer->setTotalFrames(frames);
+    streamer->setSleepTime(1);
+
+    auto po1 = DummyProcessObject::New();
+    po1->setInputConnection(streamer->getOutputPort());
+
+    auto po2 = DummyRecordingProcessObject::New();
+    po2->setInputConnection(po1->getOutputPort());
+
+    auto scheduler = PipelineScheduler::New();
+    scheduler->addProcessObject(po2);
+    scheduler->run();
+
+    auto IDs = po2->getReceivedIDs();
+    REQUIRE(IDs.size() == frames);
+    for(int i = 0; i < frames; ++i)
+        CHECK(IDs[i] == i);
+}
+
+TEST_CASE("Pipeline scheduler runs independent branches concurrently", "[fast][PipelineScheduler]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    const int frames = 10;
+    const int sleepTime = 50;
+    auto streamer = DummyStreamer::New();
+    streamer->setTotalFrames(frames);
+    streamer->setSleepTime(0);
+
+    auto po1 = DummyProcessObject::New();
+    po1->setInputConnection(streamer->getOutputPort());
+
+    auto branch1 = DummyRecordingProcessObject::New();
+    branch1->setSleepTime(sleepTime);
+    branch1->setInputConnection(po1->getOutputPort());
+
+    auto branch2 = DummyRecordingProcessObject::New();
+    branch2->setSleepTime(sleepTime);
+    branch2->setInputConnection(po1->getOutputPort());
+
+    auto scheduler = PipelineScheduler::New();
+    scheduler->addProcessObject(branch1);
+    scheduler->addProcessObject(branch2);
+    auto start = std::chrono::high_resolution_clock::now();
+    scheduler->run();
+    std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+
+    CHECK(branch1->getReceivedIDs().size() == frames);
+    CHECK(branch2->getReceivedIDs().size() == frames);
+    CHECK(scheduler->getNumberOfProcessedFrames() == frames);
+    // Sequential execution would take at least 2*frames*sleepTime
+    CHECK(duration.count() < 1.5*frames*sleepTime);
+}
+
+TEST_CASE("Pipeline scheduler with fixed number of frames", "[fast][PipelineScheduler]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    auto streamer = DummyStreamer::New();
+    streamer->setTotalFrames(10);
+    streamer->setSleepTime(1);
+
+    auto po = DummyRecordingProcessObject::New();
+    po->setInputConnection(streamer->getOutputPort());
+
+    auto scheduler = PipelineScheduler::New();
+    scheduler->addProcessObject(po);
+    scheduler->run(5);
+
+    CHECK(scheduler->getNumberOfProcessedFrames() == 5);
+    auto IDs = po->getReceivedIDs();
+    REQUIRE(IDs.size() == 5);
+    CHECK(IDs[4] == 4);
+}
+
+TEST_CASE("Pipeline scheduler without streamers executes once", "[fast][PipelineScheduler]") {
+    auto importer = DummyImporter::New();
+    auto po = DummyRecordingProcessObject::New();
+    po->setInputConnection(importer->getOutputPort());
+
+    auto scheduler = PipelineScheduler::New();
+    scheduler->addProcessObject(po);
+    scheduler->run();
+
+    CHECK(po->getReceivedIDs().size() == 1);
+}
+
+TEST_CASE("Pipeline scheduler with process object pulling data asynchronously", "[fast][PipelineScheduler]") {
+    Config::setStreamingMode(STREAMING_MODE_PROCESS_ALL_FRAMES);
+    const int frames = 20;
+    auto streamer = DummyStreamer::New();
+    streamer->setTotalFrames(frames);
+    streamer->setSleepTime(1);
+
+    // Executed by the asynchronous streamer, not by the scheduler
+    auto po1 = DummyProcessObject::New();
+    po1->setInputConnection(streamer->getOutputPort());
+
+    // Severs its input connection the first time it is executed
+    auto asynchronous = DummyAsynchronousStreamer::New();
+    asynchronous->setInputConnection(po1->getOutputPort());
+
+    auto po2 = DummyRecordingProcessObject::New();
+    po2->setInputConnection(asynchronous->getOutputPort());
+
+    auto scheduler = PipelineScheduler::New();
+    scheduler->addProcessObject(po2);
+    scheduler->run();
+
+    auto IDs = po2->getReceivedIDs();
+    REQUIRE(IDs.size() == frames);
+    for(int i = 0; i < frames; ++i)
+        CHECK(IDs[i] == i);
+    CHECK(scheduler->getNumberOfProcessedFrames() == frames);
+}
@@ -1,5 +1,9 @@
 #include "catch.hpp"
 #include "DummyObjects.hpp"
+#include "Algorithms/DoubleFilter.hpp"
+#include "FAST/Data/Image.hpp"
+#include "FAST/RuntimeMeasurementManager.hpp"
+#include <set>
 
 namespace fast {
 
@@ -579,4 +583,73 @@ TEST_CASE("Trying to set input connection to self throws exception", "[ProcessOb
     CHECK_THROWS(po->setInputConnection(po->getOutputPort()));
 }
 
+TEST_CASE("Warm up builds OpenCL programs with cached build options", "[ProcessObject][OpenCL][fast]") {
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    const std::string sourceFilename = Config::getKernelSourcePath() + "Tests/Algorithms/DoubleFilter.cl";
+    auto image = Image::New();
+    image->create(16, 16, TYPE_FLOAT, 1);
+    image->fill(1);
+
+    // Build program once, which stores the build options in the kernel binary cache
+    auto filter = DoubleFilter::New();
+    filter->setInputData(image);
+    filter->update();
+    auto cachedBuildOptions = device->getCachedBuildOptions(sourceFilename);
+    CHECK(std::any_of(cachedBuildOptions.begin(), cachedBuildOptions.end(), [](const std::string& options) {
+        return options.find("-DTYPE=float") != std::string::npos;
+    }));
+
+    auto filter2 = DoubleFilter::New();
+    REQUIRE_NOTHROW(ProcessObject::warmUp({filter, filter2}));
+    for(auto&& options : cachedBuildOptions)
+        CHECK(device->hasProgram(sourceFilename + options));
+    filter2->setInputData(image);
+    auto result = filter2->updateAndGetOutputData<Image>();
+    CHECK(result->calculateMaximumIntensity() == Approx(2));
+}
+
+TEST_CASE("Frames are traced from when the streamer added them", "[ProcessObject][fast]") {
+    RuntimeMeasurementsManager::setTracing(true);
+    auto streamer = DummyStreamer::New();
+    streamer->setSleepTime(10);
+    streamer->setTotalFrames(5);
+
+    auto po = DummyProcessObject::New();
+    po->setInputConnection(streamer->getOutputPort());
+    auto port = po->getOutputPort();
+
+    int64_t previousTraceStart = -1;
+    bool lastFrame = false;
+    while(!lastFrame) {
+        po->update();
+        auto image = port->getNextFrame<DummyDataObject>();
+        lastFrame = image->isLastFrame();
+        REQUIRE(image->hasFrameData("trace-start"));
+        // Each frame is stamped when it is added, not when the streamer was first executed
+        const int64_t traceStart = std::stoll(image->getFrameData("trace-start"));
+        CHECK(traceStart > previousTraceStart);
+        CHECK(traceStart <= RuntimeMeasurementsManager::getTraceTime(std::chrono::steady_clock::now()));
+        previousTraceStart = traceStart;
+    }
+    RuntimeMeasurementsManager::setTracing(false);
+    RuntimeMeasurementsManager::clearTrace();
+}
+
+TEST_CASE("Cached build options are de-duplicated and capped", "[ProcessObject][OpenCL][fast]") {
+    auto device = std::dynamic_pointer_cast<OpenCLDevice>(DeviceManager::getInstance()->getDefaultComputationDevice());
+    const std::string sourceFilename = Config::getKernelSourcePath() + "Tests/Algorithms/DoubleFilter.cl";
+    std::string lastBuildOptions;
+    for(int i = 0; i < 20; ++i) {
+        lastBuildOptions = "-DTYPE=float -DCACHE_TEST=" + std::to_string(i);
+        device->createProgramFromSource(sourceFilename, lastBuildOptions);
+        device->createProgramFromSource(sourceFilename, lastBuildOptions);
+    }
+
+    auto cachedBuildOptions = device->getCachedBuildOptions(sourceFilename);
+    CHECK(cachedBuildOptions.size() <= 16);
+    CHECK(cachedBuildOptions.back() == lastBuildOptions);
+    std::set<std::string> uniqueBuildOptions(cachedBuildOptions.begin(), cachedBuildOptions.end());
+    CHECK(uniqueBuildOptions.size() == cachedBuildOptions.size());
+}
+
 }
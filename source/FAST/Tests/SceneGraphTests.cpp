@@ -43,4 +43,59 @@ TEST_CASE("Get linear transformation from node to its parent root", "[fast][Scen
 }
 
 
+TEST_CASE("Cached world transform is updated when an ancestor changes", "[fast][SceneGraph]") {
+    auto dummy = DummyDataObject::New();
+    auto node = dummy->getSceneGraphNode();
+    AffineTransformation::pointer T = AffineTransformation::New();
+    T->getTransform().translate(Vector3f(1, 0, 0));
+    node->setTransformation(T);
+
+    AffineTransformation::pointer parentT = AffineTransformation::New();
+    parentT->getTransform().translate(Vector3f(0, 2, 0));
+    auto parent = SceneGraph::insertParentNodeToData(dummy, parentT);
+
+    CHECK(SceneGraph::getEigenAffineTransformationFromData(dummy).translation().isApprox(Vector3f(1, 2, 0)));
+    // Cached result should be the same
+    CHECK(SceneGraph::getEigenAffineTransformationFromData(dummy).translation().isApprox(Vector3f(1, 2, 0)));
+
+    // Modify ancestor transform in place
+    parent->getTransformation()->getTransform().translate(Vector3f(0, 0, 3));
+    CHECK(SceneGraph::getEigenAffineTransformationFromData(dummy).translation().isApprox(Vector3f(1, 2, 3)));
+
+    // Replace the transformation of the node itself
+    AffineTransformation::pointer T2 = AffineTransformation::New();
+    T2->getTransform().translate(Vector3f(5, 0, 0));
+    node->setTransformation(T2);
+    CHECK(SceneGraph::getEigenAffineTransformationFromData(dummy).translation().isApprox(Vector3f(5, 2, 3)));
+
+    // Detach from the parent
+    node->reset();
+    CHECK(SceneGraph::getEigenAffineTransformationFromData(dummy).translation().isApprox(Vector3f(0, 0, 0)));
+
+    // Modifying the returned transformation should not change the cache
+    node->setTransformation(T2);
+    auto copy = SceneGraph::getAffineTransformationFromData(dummy);
+    copy->getTransform().translate(Vector3f(1, 1, 1));
+    CHECK(SceneGraph::getEigenAffineTransformationFromData(dummy).translation().isApprox(Vector3f(5, 0, 0)));
+}
+
+TEST_CASE("Transformation version is updated after the transform is written", "[fast][SceneGraph]") {
+    auto T = AffineTransformation::New();
+    const uint64_t version = T->getVersion();
+    CHECK(T->getVersion() == version);
+
+    // Version is updated after writing through the reference
+    T->getTransform().translate(Vector3f(1, 0, 0));
+    const uint64_t version2 = T->getVersion();
+    CHECK(version2 != version);
+    CHECK(T->getVersion() == version2);
+
+    // Reading through the const version does not change the version
+    std::static_pointer_cast<const AffineTransformation>(T)->getTransform();
+    CHECK(T->getVersion() == version2);
+
+    T->setTransform(Affine3f::Identity());
+    CHECK(T->getVersion() != version2);
+}
+
 } // end namespace fast
@@ -0,0 +1,53 @@
+#include <FAST/Testing.hpp>
+#include <FAST/ThreadPool.hpp>
+#include <FAST/Exception.hpp>
+
+using namespace fast;
+
+TEST_CASE("Thread pool executes all tasks", "[fast][ThreadPool]") {
+    ThreadPool pool(4);
+    CHECK(pool.getNumberOfThreads() == 4);
+    std::atomic<int> counter(0);
+    for(int i = 0; i < 1000; ++i) {
+        pool.enqueue([&counter]() {
+            counter++;
+        });
+    }
+    pool.waitToFinish();
+    CHECK(counter == 1000);
+}
+
+TEST_CASE("Thread pool submit returns result", "[fast][ThreadPool]") {
+    ThreadPool pool(2);
+    std::vector<std::future<int>> results;
+    for(int i = 0; i < 10; ++i)
+        results.push_back(pool.submit([i]() { return i*i; }));
+    for(int i = 0; i < 10; ++i)
+        CHECK(results[i].get() == i*i);
+}
+
+TEST_CASE("Thread pool tasks can submit new tasks", "[fast][ThreadPool]") {
+    ThreadPool pool(2);
+    std::atomic<int> counter(0);
+    for(int i = 0; i < 10; ++i) {
+        pool.enqueue([&pool, &counter]() {
+            for(int j = 0; j < 10; ++j)
+                pool.enqueue([&counter]() { counter++; });
+        });
+    }
+    pool.waitToFinish();
+    CHECK(counter == 100);
+}
+
+TEST_CASE("Thread pool survives tasks throwing exceptions", "[fast][ThreadPool]") {
+    ThreadPool pool(2);
+    std::atomic<int> counter(0);
+    pool.enqueue([]() { throw Exception("Task failed"); });
+    pool.enqueue([]() { throw 42; });
+    auto future = pool.submit([]() -> int { throw 42; });
+    for(int i = 0; i < 10; ++i)
+        pool.enqueue([&counter]() { counter++; });
+    pool.waitToFinish();
+    CHECK(counter == 10);
+    CHECK_THROWS_AS(future.get(), int);
+}
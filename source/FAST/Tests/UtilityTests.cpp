@@ -1,5 +1,7 @@
 #include "FAST/Testing.hpp"
 #include "FAST/Utility.hpp"
+#include "FAST/RuntimeMeasurement.hpp"
+#include <fstream>
 
 using namespace fast;
 
@@ -48,4 +50,77 @@ TEST_CASE("Replace", "[replace][utility]") {
 
     str = "Hello world!";
     CHECK(replace(str, "world", "fantasy") == "Hello fantasy!");
-}
\ No newline at end of file
+}
+TEST_CASE("Runtime measurement percentiles", "[runtime][utility]") {
+    RuntimeMeasurement runtime("test");
+    for(int i = 1; i <= 100; ++i)
+        runtime.addSample(i);
+    CHECK(runtime.getSamples() == 100);
+    CHECK(runtime.getAverage() == Approx(50.5));
+    CHECK(runtime.getMin() == Approx(1));
+    CHECK(runtime.getMax() == Approx(100));
+    CHECK(runtime.getPercentile(50) == Approx(50).epsilon(0.05));
+    CHECK(runtime.getPercentile(95) == Approx(95).epsilon(0.05));
+    CHECK(runtime.getPercentile(99) == Approx(99).epsilon(0.05));
+    CHECK(runtime.toJSON().find("\"p99\"") != std::string::npos);
+
+    runtime.reset();
+    CHECK(runtime.getSamples() == 0);
+}
+
+TEST_CASE("Reporter LOG method writes messages from several threads to log file", "[reporter][utility]") {
+    const std::string filename = "ReporterLogTest.log";
+    std::remove(filename.c_str());
+    Reporter::setLogToConsole(false);
+    Reporter::setLogFile(filename);
+
+    Reporter reporter;
+    reporter.setReportMethod(Reporter::LOG);
+    CHECK(reporter.isEnabled(Reporter::INFO));
+    std::vector<std::thread> threads;
+    for(int thread = 0; thread < 4; ++thread) {
+        threads.push_back(std::thread([thread, reporter]() {
+            for(int i = 0; i < 100; ++i)
+                reporter << "Thread " << thread << " message " << i << Reporter::end();
+        }));
+    }
+    for(auto& thread : threads)
+        thread.join();
+    Reporter::flush();
+    Reporter::setLogFile("");
+    Reporter::setLogToConsole(true);
+
+    std::ifstream file(filename);
+    std::string line;
+    int lines = 0;
+    while(std::getline(file, line)) {
+        CHECK(line.find("INFO [") != std::string::npos);
+        ++lines;
+    }
+    CHECK(lines + Reporter::getNrOfDroppedMessages() == 400);
+
+    reporter.setReportMethod(Reporter::INFO, Reporter::NONE);
+    CHECK_FALSE(reporter.isEnabled(Reporter::INFO));
+}
+
+TEST_CASE("Reporter discards the text of an abandoned message", "[reporter][utility]") {
+    const std::string filename = "ReporterAbandonedMessageTest.log";
+    std::remove(filename.c_str());
+    Reporter::setLogToConsole(false);
+    Reporter::setLogFile(filename);
+
+    Reporter reporter;
+    reporter.setReportMethod(Reporter::LOG);
+    auto failingOperand = []() -> std::string { throw Exception("Operand failed"); };
+    CHECK_THROWS(reporter << "abandoned " << failingOperand() << Reporter::end());
+    reporter << "complete" << Reporter::end();
+    Reporter::flush();
+    Reporter::setLogFile("");
+    Reporter::setLogToConsole(true);
+
+    std::ifstream file(filename);
+    std::string line;
+    REQUIRE(std::getline(file, line));
+    CHECK(line.find("complete") != std::string::npos);
+    CHECK(line.find("abandoned") == std::string::npos);
+}
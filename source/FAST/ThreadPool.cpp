@@ -0,0 +1,116 @@
+#include "ThreadPool.hpp"
+
+namespace fast {
+
+// Index of the worker the current thread belongs to, -1 if it is not a worker thread
+static thread_local int currentWorkerID = -1;
+static thread_local const ThreadPool* currentPool = nullptr;
+
+ThreadPool::ThreadPool(uint nrOfThreads) {
+    if(nrOfThreads == 0)
+        nrOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    m_nextWorker = 0;
+    for(uint i = 0; i < nrOfThreads; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for(uint i = 0; i < nrOfThreads; ++i)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskAvailable.notify_all();
+    for(auto& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    uint workerID;
+    if(currentPool == this) {
+        // Submitted from one of our own workers: keep it local, it will likely use the same data
+        workerID = currentWorkerID;
+    } else {
+        workerID = m_nextWorker++ % m_workers.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_workers[workerID]->mutex);
+        m_workers[workerID]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queuedTasks;
+        ++m_pendingTasks;
+    }
+    m_taskAvailable.notify_one();
+}
+
+bool ThreadPool::popTask(uint workerID, std::function<void()>& task) {
+    // First try own queue (LIFO)
+    {
+        std::lock_guard<std::mutex> lock(m_workers[workerID]->mutex);
+        if(!m_workers[workerID]->tasks.empty()) {
+            task = std::move(m_workers[workerID]->tasks.back());
+            m_workers[workerID]->tasks.pop_back();
+            return true;
+        }
+    }
+    // Then try to steal from the other workers (FIFO)
+    for(uint i = 1; i < m_workers.size(); ++i) {
+        auto& victim = m_workers[(workerID + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if(!victim->tasks.empty()) {
+            task = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(uint workerID) {
+    currentWorkerID = workerID;
+    currentPool = this;
+    while(true) {
+        {
+            // Reserve one of the queued tasks, or stop if there are none left
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while(m_queuedTasks == 0 && !m_stop)
+                m_taskAvailable.wait(lock);
+            if(m_queuedTasks == 0)
+                break;
+            --m_queuedTasks;
+        }
+        std::function<void()> task;
+        while(!popTask(workerID, task)) // The reserved task is in one of the queues
+            std::this_thread::yield();
+        // Exceptions of tasks added with submit are stored in their future by the packaged_task,
+        // thus only tasks added with enqueue can throw here. Never let them terminate the worker.
+        try {
+            task();
+        } catch(std::exception &e) {
+            Reporter::error() << "Uncaught exception in thread pool task: " << e.what() << Reporter::end();
+        } catch(...) {
+            Reporter::error() << "Uncaught unknown exception in thread pool task" << Reporter::end();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pendingTasks;
+            if(m_pendingTasks == 0)
+                m_allFinished.notify_all();
+        }
+    }
+}
+
+uint ThreadPool::getNumberOfThreads() const {
+    return m_threads.size();
+}
+
+void ThreadPool::waitToFinish() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_pendingTasks > 0)
+        m_allFinished.wait(lock);
+}
+
+}
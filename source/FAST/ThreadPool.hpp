@@ -0,0 +1,75 @@
+#pragma once
+
+#include "FAST/Object.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <future>
+#include <atomic>
+
+namespace fast {
+
+/**
+ * A work-stealing thread pool.
+ * Each worker has its own task queue. A worker takes tasks from the back of its own queue,
+ * and when it is empty it tries to steal from the front of the other workers' queues.
+ * Tasks submitted from a worker thread are placed in that worker's queue, other tasks
+ * are distributed round-robin.
+ */
+class FAST_EXPORT ThreadPool {
+    public:
+        /**
+         * @param nrOfThreads Number of worker threads. 0 means use std::thread::hardware_concurrency.
+         */
+        explicit ThreadPool(uint nrOfThreads = 0);
+        ~ThreadPool();
+        /**
+         * Add a task to the pool
+         * @param task
+         */
+        void enqueue(std::function<void()> task);
+        /**
+         * Add a task to the pool, and get a future for its result
+         */
+        template <class F>
+        std::future<typename std::result_of<F()>::type> submit(F function);
+        /**
+         * @return number of worker threads
+         */
+        uint getNumberOfThreads() const;
+        /**
+         * Block until all tasks submitted so far have finished
+         */
+        void waitToFinish();
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+        bool popTask(uint workerID, std::function<void()>& task);
+        void workerLoop(uint workerID);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_taskAvailable;
+        std::condition_variable m_allFinished;
+        uint m_queuedTasks = 0;
+        uint m_pendingTasks = 0;
+        std::atomic<uint> m_nextWorker;
+        bool m_stop = false;
+};
+
+template <class F>
+std::future<typename std::result_of<F()>::type> ThreadPool::submit(F function) {
+    typedef typename std::result_of<F()>::type ReturnType;
+    auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::move(function));
+    auto future = task->get_future();
+    enqueue([task]() { (*task)(); });
+    return future;
+}
+
+}
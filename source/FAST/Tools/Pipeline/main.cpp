@@ -1,16 +1,98 @@
 #include <FAST/Tools/CommandLineParser.hpp>
 #include <FAST/Pipeline.hpp>
+#include <FAST/PipelineScheduler.hpp>
 #include <FAST/Visualization/MultiViewWindow.hpp>
+#include <chrono>
+#include <iomanip>
+#include <fstream>
 
 using namespace fast;
 
+/**
+ * Run the pipeline without any windows, until the end of the stream, and report throughput and runtimes.
+ */
+static int runHeadless(Pipeline& pipeline, int maxFrames, std::string metricsFilename, std::string traceFilename) {
+    pipeline.parsePipelineFile({}, false);
+    auto sinks = pipeline.getSinks();
+    if(sinks.empty())
+        throw Exception("Pipeline has no process objects to execute");
+
+    auto processObjects = pipeline.getProcessObjects();
+    for(auto&& processObject : processObjects)
+        processObject.second->enableRuntimeMeasurements();
+
+    // Compile OpenCL kernels before starting, to not include it in the measurements
+    pipeline.warmUp();
+
+    if(!traceFilename.empty())
+        RuntimeMeasurementsManager::setTracing(true);
+
+    auto scheduler = PipelineScheduler::New();
+    for(auto&& sink : sinks) {
+        Reporter::info() << "Executing pipeline sink " << sink.first << Reporter::end();
+        scheduler->addProcessObject(sink.second);
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    scheduler->run(maxFrames);
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+    const int frames = scheduler->getNumberOfProcessedFrames();
+
+    std::cout << "Processed " << frames << " frames in " << duration.count() << " seconds (" <<
+        (duration.count() > 0 ? frames / duration.count() : 0.0) << " frames per second)" << std::endl;
+    std::cout << std::left << std::setw(24) << "Process object" << std::setw(32) << "Class" <<
+        std::right << std::setw(10) << "Frames" << std::setw(14) << "Average ms" << std::setw(14) << "Std.dev. ms" <<
+        std::setw(14) << "Max ms" << std::endl;
+    for(auto&& processObject : processObjects) {
+        auto runtime = processObject.second->getRuntime();
+        std::cout << std::left << std::setw(24) << processObject.first << std::setw(32) << processObject.second->getNameOfClass() <<
+            std::right << std::setw(10) << runtime->getSamples() << std::fixed << std::setprecision(3) <<
+            std::setw(14) << runtime->getAverage() << std::setw(14) << runtime->getStdDeviation() <<
+            std::setw(14) << runtime->getMax() << std::defaultfloat << std::endl;
+    }
+
+    if(!metricsFilename.empty()) {
+        std::ofstream file(metricsFilename);
+        if(!file.is_open())
+            throw Exception("Unable to open file " + metricsFilename);
+        file << "{\"frames\": " << frames << ", \"seconds\": " << duration.count() << ", \"process_objects\": {";
+        bool first = true;
+        for(auto&& processObject : processObjects) {
+            if(!first)
+                file << ",";
+            first = false;
+            file << "\n\"" << processObject.first << "\": {\"class\": \"" << processObject.second->getNameOfClass() <<
+                "\", \"runtimes\": " << processObject.second->getAllRuntimes()->toJSON() << "}";
+        }
+        file << "\n}}\n";
+    }
+    if(!traceFilename.empty())
+        RuntimeMeasurementsManager::exportTrace(traceFilename);
+    return 0;
+}
+
 int main(int argc, char** argv) {
-    
+
     CommandLineParser parser("FAST Pipeline Executor", "Use this tool to execute pipelines described in text files", true);
     parser.addPositionVariable(1, "pipeline-filename", true, "Pipeline filename");
+    parser.addOption("headless", "Run pipeline without display until the end of the stream. Renderers and views are ignored, and the process objects which have no outputs connected are executed. Throughput and runtime of each process object is reported at exit.");
+    parser.addVariable("max-frames", "-1", "Maximum nr of frames to process in headless mode. -1 means process until end of stream.");
+    parser.addVariable("metrics", "", "Write runtime statistics, including percentiles, of all process objects to this JSON file in headless mode.");
+    parser.addVariable("trace", "", "Write a trace of all executions, with frame latencies, in the Chrome trace event format to this file in headless mode.");
 
     parser.parse(argc, argv);
 
+    if(parser.getOption("headless")) {
+        // Must be disabled before any devices are created
+        Config::setVisualization(false);
+        auto pipeline = Pipeline(parser.get("pipeline-filename"), parser.getVariables());
+        try {
+            return runHeadless(pipeline, parser.get<int>("max-frames"), parser.get("metrics"), parser.get("trace"));
+        } catch(std::exception &e) {
+            std::cerr << "Error running pipeline: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     auto pipeline = Pipeline(parser.get("pipeline-filename"), parser.getVariables());
     pipeline.parsePipelineFile();
 
@@ -19,4 +101,4 @@ int main(int argc, char** argv) {
         window->addView(view);
     }
     window->start();
-}
\ No newline at end of file
+}
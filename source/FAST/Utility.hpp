@@ -60,12 +60,12 @@ T sign(T value) {
 }
 
 FAST_EXPORT unsigned int getPowerOfTwoSize(unsigned int size);
-FAST_EXPORT void* allocateDataArray(unsigned int voxels, DataType type, unsigned int nrOfComponents);
+FAST_EXPORT void* allocateDataArray(std::size_t voxels, DataType type, unsigned int nrOfComponents);
 template <class T>
-float getSumFromOpenCLImageResult(void* voidData, unsigned int size, unsigned int nrOfComponents) {
+float getSumFromOpenCLImageResult(void* voidData, std::size_t size, unsigned int nrOfComponents) {
     T* data = (T*)voidData;
     float sum = 0.0f;
-    for(unsigned int i = 0; i < size*nrOfComponents; i += nrOfComponents) {
+    for(std::size_t i = 0; i < size*nrOfComponents; i += nrOfComponents) {
         sum += data[i];
     }
     return sum;
@@ -73,16 +73,16 @@ float getSumFromOpenCLImageResult(void* voidData, unsigned int size, unsigned in
 
 FAST_EXPORT void getMaxAndMinFromOpenCLImage(OpenCLDevice::pointer device, cl::Image2D image, DataType type, float* min, float* max);
 FAST_EXPORT void getMaxAndMinFromOpenCLImage(OpenCLDevice::pointer device, cl::Image3D image, DataType type, float* min, float* max);
-FAST_EXPORT void getMaxAndMinFromOpenCLBuffer(OpenCLDevice::pointer device, cl::Buffer buffer, unsigned int size, DataType type, float* min, float* max);
+FAST_EXPORT void getMaxAndMinFromOpenCLBuffer(OpenCLDevice::pointer device, cl::Buffer buffer, std::size_t size, DataType type, float* min, float* max);
 FAST_EXPORT void getIntensitySumFromOpenCLImage(OpenCLDevice::pointer device, cl::Image2D image, DataType type, float* sum);
 
 template <class T>
-void getMaxAndMinFromData(void* voidData, unsigned int nrOfElements, float* min, float* max) {
+void getMaxAndMinFromData(void* voidData, std::size_t nrOfElements, float* min, float* max) {
     T* data = (T*)voidData;
 
     *min = std::numeric_limits<float>::max();
     *max = std::numeric_limits<float>::min();
-    for(unsigned int i = 0; i < nrOfElements; i++) {
+    for(std::size_t i = 0; i < nrOfElements; i++) {
         if((float)data[i] < *min) {
             *min = (float)data[i];
         }
@@ -93,11 +93,11 @@ void getMaxAndMinFromData(void* voidData, unsigned int nrOfElements, float* min,
 }
 
 template <class T>
-float getSumFromData(void* voidData, unsigned int nrOfElements) {
+float getSumFromData(void* voidData, std::size_t nrOfElements) {
     T* data = (T*)voidData;
 
     float sum = 0.0f;
-    for(unsigned int i = 0; i < nrOfElements; i++) {
+    for(std::size_t i = 0; i < nrOfElements; i++) {
         sum += (float)data[i];
     }
     return sum;
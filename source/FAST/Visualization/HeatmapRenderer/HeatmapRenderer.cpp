@@ -266,19 +266,16 @@ void HeatmapRenderer::drawTextures(Matrix4f &perspectiveMatrix, Matrix4f &viewin
 
     // This is the actual rendering
     for(auto& it : mTensorUsed) {
-        AffineTransformation::pointer transform;
-        if(mode2D) {
-            // If rendering is in 2D mode we skip any transformations
-            transform = AffineTransformation::New();
-        } else {
-            transform = SceneGraph::getAffineTransformationFromData(it.second);
-        }
+        Affine3f transform = Affine3f::Identity();
+        // If rendering is in 2D mode we skip any transformations
+        if(!mode2D)
+            transform = SceneGraph::getEigenAffineTransformationFromData(it.second);
 
         Vector3f spacing = it.second->getSpacing();
-        transform->getTransform().scale(spacing);
+        transform.scale(spacing);
 
         uint transformLoc = glGetUniformLocation(getShaderProgram(), "transform");
-        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, transform->getTransform().data());
+        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, transform.data());
         transformLoc = glGetUniformLocation(getShaderProgram(), "perspectiveTransform");
         glUniformMatrix4fv(transformLoc, 1, GL_FALSE, perspectiveMatrix.data());
         transformLoc = glGetUniformLocation(getShaderProgram(), "viewTransform");
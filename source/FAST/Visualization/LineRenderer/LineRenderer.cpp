@@ -30,14 +30,11 @@ void LineRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, floa
         mVAO[it.first] = VAO_ID;
         glBindVertexArray(VAO_ID);
 
-        AffineTransformation::pointer transform;
-        if(mode2D) {
-            // If rendering is in 2D mode we skip any transformations
-            transform = AffineTransformation::New();
-        } else {
-            transform = SceneGraph::getAffineTransformationFromData(it.second);
-        }
-        setShaderUniform("transform", transform->getTransform());
+        Affine3f transform = Affine3f::Identity();
+        // If rendering is in 2D mode we skip any transformations
+        if(!mode2D)
+            transform = SceneGraph::getEigenAffineTransformationFromData(it.second);
+        setShaderUniform("transform", transform);
 
         // TODO glLineWidth does not work with GL 3.3 CORE. Have to implemented in shader instead
         if(mInputWidths.count(it.first) > 0) {
@@ -207,20 +207,17 @@ void SegmentationLabelRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewin
     for(auto it : mImageUsed) {
         const uint inputNr = it.first;
 
-        AffineTransformation::pointer transform;
-        if(mode2D) {
-            // If rendering is in 2D mode we skip any transformations
-            transform = AffineTransformation::New();
-        } else {
-            transform = SceneGraph::getAffineTransformationFromData(it.second);
-        }
+        Affine3f transform = Affine3f::Identity();
+        // If rendering is in 2D mode we skip any transformations
+        if(!mode2D)
+            transform = SceneGraph::getEigenAffineTransformationFromData(it.second);
 
-        transform->getTransform().scale(it.second->getSpacing()/mScales[inputNr]);
+        transform.scale(it.second->getSpacing()/mScales[inputNr]);
 
         // Get width and height of texture
         glBindTexture(GL_TEXTURE_2D, mTexturesToRender[inputNr]);
         uint transformLoc = glGetUniformLocation(getShaderProgram(), "transform");
-        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, transform->getTransform().data());
+        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, transform.data());
         transformLoc = glGetUniformLocation(getShaderProgram(), "perspectiveTransform");
         glUniformMatrix4fv(transformLoc, 1, GL_FALSE, perspectiveMatrix.data());
         transformLoc = glGetUniformLocation(getShaderProgram(), "viewTransform");
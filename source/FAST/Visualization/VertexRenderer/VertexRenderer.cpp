@@ -46,8 +46,7 @@ void VertexRenderer::draw(Matrix4f perspectiveMatrix, Matrix4f viewingMatrix, fl
         if(drawOnTop)
             glDisable(GL_DEPTH_TEST);
 
-        auto transform = SceneGraph::getAffineTransformationFromData(points);
-        setShaderUniform("transform", transform->getTransform());
+        setShaderUniform("transform", SceneGraph::getEigenAffineTransformationFromData(points));
         setShaderUniform("pointSize", pointSize);
 
         auto access = points->getVertexBufferObjectAccess(ACCESS_READ);